@@ -0,0 +1,32 @@
+#include "HI_AliasCache.h"
+
+using namespace llvm;
+
+bool HI_AliasCache::lookup(const Instruction *I0, const Instruction *I1, Optional<int64_t> &result)
+{
+    auto it = Results.find(std::make_pair(I0, I1));
+    if (it == Results.end())
+    {
+        missNum++;
+        return false;
+    }
+    hitNum++;
+    result = it->second;
+    return true;
+}
+
+void HI_AliasCache::insert(const Instruction *I0, const Instruction *I1, Optional<int64_t> result)
+{
+    Results[std::make_pair(I0, I1)] = result;
+}
+
+void HI_AliasCache::clear()
+{
+    Results.clear();
+    hitNum = missNum = 0;
+}
+
+void HI_AliasCache::printStatistics(raw_ostream &O) const
+{
+    O << "address difference cache: hit=" << hitNum << " miss=" << missNum << "\n";
+}
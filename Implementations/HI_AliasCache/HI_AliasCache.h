@@ -0,0 +1,55 @@
+#ifndef _HI_ALIASCACHE
+#define _HI_ALIASCACHE
+
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/Optional.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/Support/raw_ostream.h"
+#include <cstdint>
+#include <utility>
+
+// The memoized constant differences between the addresses of pairs of accesses. A difference is
+// computed by SCEV analyses (computeConstantDifference, splitBinaryAdd...), and the same pairs are
+// queried many times by the block scheduling, the II checks and the dependence checks, e.g. the
+// pairs of accesses in a loop are checked again for its outer loops. Cheaper queries, like the
+// intersection of the targets of two accesses, are recomputed since a lookup costs as much.
+//
+// A difference is valid as long as the IR is unchanged. The evaluator does not change the IR, so
+// the cache is only cleared when the evaluation of a module begins. The number of the hits and
+// misses is counted to show the savings.
+class HI_AliasCache
+{
+  public:
+    // get the difference between the addresses of the two instructions, false is returned if it
+    // is not computed yet. The difference is None if it is not a constant.
+    bool lookup(const llvm::Instruction *I0, const llvm::Instruction *I1,
+                llvm::Optional<int64_t> &result);
+
+    void insert(const llvm::Instruction *I0, const llvm::Instruction *I1,
+                llvm::Optional<int64_t> result);
+
+    // drop all the results and the statistics
+    void clear();
+
+    uint64_t getHitNum() const
+    {
+        return hitNum;
+    }
+
+    uint64_t getMissNum() const
+    {
+        return missNum;
+    }
+
+    void printStatistics(llvm::raw_ostream &O) const;
+
+  private:
+    llvm::DenseMap<std::pair<const llvm::Instruction *, const llvm::Instruction *>,
+                   llvm::Optional<int64_t>>
+        Results;
+
+    uint64_t hitNum = 0;
+    uint64_t missNum = 0;
+};
+
+#endif
@@ -17,6 +17,7 @@
 #define Strict_CertaintyRatio (7.0 / 8.0)
 
 #include "ClockInfo.h"
+#include "HI_HLSLibrary.h"
 #include "HI_StringProcess.h"
 #include "HI_print.h"
 #include "llvm/ADT/SmallVector.h"
@@ -120,10 +121,6 @@ class inst_timing_resource_info
     }
 };
 
-// For each type of instruction, there will be a list to store a series of information corresponding
-// to different parameters
-typedef std::map<int, std::map<int, std::map<std::string, inst_timing_resource_info>>>
-    Info_type_list;
 #endif
 
 // we want that when an loop is unrolled, the sensitive array should be partitioned accordingly.
@@ -140,11 +137,11 @@ class HI_ArraySensitiveToLoopLevel : public ModulePass
         std::map<std::string, std::vector<int>> &IRFunc2BeginLine,
         std::map<std::string, std::set<std::pair<std::string, std::pair<std::string, int>>>>
             &LoopLabel2DrivenArrayDimensions,
-        std::map<std::string, Info_type_list> &BiOp_Info_name2list_map, bool DEBUG = 0)
+        const HI_HLSLibTable &HLSLibTable, bool DEBUG = 0)
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel),
           IRLoop2OriginTripCount(IRLoop2OriginTripCount),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
-          IRFunc2BeginLine(IRFunc2BeginLine), BiOp_Info_name2list_map(BiOp_Info_name2list_map),
+          IRFunc2BeginLine(IRFunc2BeginLine), HLSLibTable(HLSLibTable),
           LoopLabel2DrivenArrayDimensions(LoopLabel2DrivenArrayDimensions), DEBUG(DEBUG)
     {
         BlockEvaluated.clear();
@@ -833,10 +830,14 @@ class HI_ArraySensitiveToLoopLevel : public ModulePass
         return stream;
     }
 
-    // A map from opcode to the information list of timing and resource
-    std::map<std::string, Info_type_list> &BiOp_Info_name2list_map;
+    // The table of timing and resource information indexed by opcode, bitwidths and clock period
+    // (read-only, since it could be shared by several evaluators)
+    const HI_HLSLibTable &HLSLibTable;
 
-    std::map<std::string, Info_type_list> BiOp_Info_name2list_map_contain;
+    // get the record of a specific instruction, based on its opcode, operand_bitwidth,
+    // result_bitwidth and clock period
+    const HI_HLSLibRecord &getInstRecord(llvm::StringRef opcode, int operand_bitwid,
+                                         int res_bitwidth, llvm::StringRef period);
 
     // get the information of a specific instruction, based on its opcode, operand_bitwidth,
     // result_bitwidth and clock period
@@ -875,19 +876,10 @@ class HI_ArraySensitiveToLoopLevel : public ModulePass
     resourceBase IndexVar_LUT(std::map<Instruction *, timingBase> &cur_InstructionCriticalPath,
                               Instruction *I);
 
-    // check whether a specific information is in the database
+    // check whether a specific information is characterized in the database
     bool checkInfoAvailability(std::string opcode, int operand_bitwid, int res_bitwidth,
                                std::string period);
 
-    // check whether we can infer the information by increasing the clock frequency
-    bool checkFreqProblem(std::string opcode, int operand_bitwid, int res_bitwidth,
-                          std::string period);
-
-    // if the information is not found in database, we may infer the information by increasing the
-    // clock frequency
-    inst_timing_resource_info checkInfo_HigherFreq(std::string opcode, int operand_bitwid,
-                                                   int res_bitwidth, std::string period);
-
     // Trace back to get the bitwidth of an operand, bypassing truct/zext/sext
     int getOriginalBitwidth(Value *Val);
 
@@ -57,8 +57,8 @@ HI_ArraySensitiveToLoopLevel::get_inst_TimingInfo_result(std::string opcode, int
                                                          int res_bitwidth, std::string period)
 {
     timingBase result(0, 0, 1, clock_period);
-    inst_timing_resource_info info =
-        get_inst_info(opcode, operand_bitwid, res_bitwidth, clock_period_str);
+    const HI_HLSLibRecord &info =
+        getInstRecord(opcode, operand_bitwid, res_bitwidth, clock_period_str);
     result.latency = info.Lat;
     result.timing = info.delay;
     result.II = info.II;
@@ -73,8 +73,8 @@ HI_ArraySensitiveToLoopLevel::get_inst_ResourceInfo_result(std::string opcode, i
                                                            int res_bitwidth, std::string period)
 {
     resourceBase result(0, 0, 0, clock_period);
-    inst_timing_resource_info info =
-        get_inst_info(opcode, operand_bitwid, res_bitwidth, clock_period_str);
+    const HI_HLSLibRecord &info =
+        getInstRecord(opcode, operand_bitwid, res_bitwidth, clock_period_str);
     result.DSP = info.DSP;
     result.FF = info.FF;
     result.LUT = info.LUT;
@@ -88,147 +88,44 @@ inst_timing_resource_info HI_ArraySensitiveToLoopLevel::get_inst_info(std::strin
                                                                       int res_bitwidth,
                                                                       std::string period)
 {
-    if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, period))
-        return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period];
-    if (!checkFreqProblem(opcode, operand_bitwid, res_bitwidth, period) && (operand_bitwid % 2))
-    {
-        inst_timing_resource_info info_A =
-            get_inst_info(opcode, operand_bitwid + 1, res_bitwidth + 1, period);
-        inst_timing_resource_info info_B =
-            get_inst_info(opcode, operand_bitwid - 1, res_bitwidth - 1, period);
-        inst_timing_resource_info tmp_info;
-
-        tmp_info.DSP = (info_A.DSP + info_B.DSP + 1) / 2;
-        tmp_info.FF = (info_A.FF + info_B.FF + 1) / 2;
-        tmp_info.LUT = (info_A.LUT + info_B.LUT) / 2;
-        tmp_info.Lat = (info_A.Lat + info_B.Lat) / 2;
-        tmp_info.delay = (info_A.delay + info_B.delay) / 2;
-        tmp_info.II = (info_A.II + info_B.II + 1) / 2;
-        tmp_info.core_name = info_A.core_name;
-        BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] = tmp_info;
-    }
-    else
-    {
-        BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] =
-            checkInfo_HigherFreq(opcode, operand_bitwid, res_bitwidth, period);
-    }
-
-    return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period];
-
-    llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- " << res_bitwidth
-                 << " -- " << period << " \n";
-    assert(false && "no such information in the database\n");
+    const HI_HLSLibRecord &record = getInstRecord(opcode, operand_bitwid, res_bitwidth, period);
+    inst_timing_resource_info tmp_info;
+    tmp_info.DSP = record.DSP;
+    tmp_info.FF = record.FF;
+    tmp_info.LUT = record.LUT;
+    tmp_info.Lat = record.Lat;
+    tmp_info.delay = record.delay;
+    tmp_info.II = record.II;
+    tmp_info.core_name = record.core_name;
+    return tmp_info;
 }
 
-// check whether a specific information is in the database
-bool HI_ArraySensitiveToLoopLevel::checkInfoAvailability(std::string opcode, int operand_bitwid,
-                                                         int res_bitwidth, std::string period)
+// get the record of a specific instruction, based on its opcode, operand_bitwidth,
+// result_bitwidth and clock period. The missing bitwidths/clock periods are inferred when the
+// table is built, so the lookup never modifies anything. An entry missing from the library is
+// reported and evaluated as an empty record (no latency and no resource).
+const HI_HLSLibRecord &
+HI_ArraySensitiveToLoopLevel::getInstRecord(llvm::StringRef opcode, int operand_bitwid,
+                                            int res_bitwidth, llvm::StringRef period)
 {
-    if (BiOp_Info_name2list_map.find(opcode) != BiOp_Info_name2list_map.end())
+    const HI_HLSLibRecord *info = HLSLibTable.lookup(opcode, operand_bitwid, res_bitwidth, period);
+    if (!info)
     {
-        if (BiOp_Info_name2list_map[opcode].find(operand_bitwid) !=
-            BiOp_Info_name2list_map[opcode].end())
-        {
-            if (BiOp_Info_name2list_map[opcode][operand_bitwid].find(res_bitwidth) !=
-                BiOp_Info_name2list_map[opcode][operand_bitwid].end())
-            {
-                if (BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth].find(period) !=
-                    BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth].end())
-                {
-                    return true;
-                }
-                else
-                {
-                    // llvm::errs() << "not in
-                    // BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth]\n";
-                }
-            }
-            else
-            {
-                // llvm::errs() << "not in BiOp_Info_name2list_map[opcode][operand_bitwid]\n";
-            }
-        }
-        else
-        {
-            // llvm::errs() << "not in BiOp_Info_name2list_map[opcode]\n";
-        }
-    }
-    else
-    {
-        // llvm::errs() << "not in BiOp_Info_name2list_map\n";
-    }
-
-    return false;
-}
-
-// check whether we can infer the information by increasing the clock frequency
-bool HI_ArraySensitiveToLoopLevel::checkFreqProblem(std::string opcode, int operand_bitwid,
-                                                    int res_bitwidth, std::string period)
-{
-    if (BiOp_Info_name2list_map.find(opcode) != BiOp_Info_name2list_map.end())
-    {
-        if (BiOp_Info_name2list_map[opcode].find(operand_bitwid) !=
-            BiOp_Info_name2list_map[opcode].end())
-        {
-            if (BiOp_Info_name2list_map[opcode][operand_bitwid].find(res_bitwidth) !=
-                BiOp_Info_name2list_map[opcode][operand_bitwid].end())
-            {
-                return true;
-            }
-            else
-            {
-                // llvm::errs() << "not in BiOp_Info_name2list_map[opcode][operand_bitwid]\n";
-            }
-        }
-        else
-        {
-            // llvm::errs() << "not in BiOp_Info_name2list_map[opcode]\n";
-        }
-    }
-    else
-    {
-        // llvm::errs() << "not in BiOp_Info_name2list_map\n";
+        static const HI_HLSLibRecord emptyRecord = {};
+        llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- "
+                     << res_bitwidth << " -- " << period << " \n";
+        print_error("No such information in the HLS information library, it is evaluated as "
+                    "an empty record.");
+        return emptyRecord;
     }
-
-    return false;
+    return *info;
 }
 
-// if the information is not found in database, we may infer the information by increasing the clock
-// frequency
-inst_timing_resource_info HI_ArraySensitiveToLoopLevel::checkInfo_HigherFreq(std::string opcode,
-                                                                             int operand_bitwid,
-                                                                             int res_bitwidth,
-                                                                             std::string period)
+// check whether a specific information is characterized in the database
+bool HI_ArraySensitiveToLoopLevel::checkInfoAvailability(std::string opcode, int operand_bitwid,
+                                                         int res_bitwidth, std::string period)
 {
-    int i;
-
-    // locate the target clock in clock sequence
-    for (i = clockNum - 1; i >= 0; i--)
-        if (std::stof(clockStrs[i]) == std::stof(period))
-        {
-            if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, clockStrs[i]))
-            {
-                BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] =
-                    BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-                return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-            }
-            break;
-        }
-    i--;
-    if (i < 0)
-        llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- "
-                     << res_bitwidth << " -- " << period << " \n";
-    assert(i >= 0 && "The clock should be found.\n");
-
-    // iterate to find available information in database
-    for (; i >= 0; i--)
-    {
-        if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, clockStrs[i]))
-            return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-    }
-    llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- " << res_bitwidth
-                 << " -- " << period << " \n";
-    assert(false && "no such information in the database\n");
+    return HLSLibTable.isCharacterized(opcode, operand_bitwid, res_bitwidth, period);
 }
 
 // parse the argument for array partitioning
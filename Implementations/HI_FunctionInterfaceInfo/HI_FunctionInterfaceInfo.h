@@ -73,6 +73,23 @@ class HI_FunctionInterfaceInfo_Visitor
         delete parseLog;
     }
 
+    // Visit the declaration of Variables and log their types, no text is inserted here since the
+    // line numbers of the rewritten code should be the same as the ones of the source code
+    virtual bool VisitVarDecl(VarDecl *VD)
+    {
+        *parseLog << "find VarDecl: VarName: [" << VD->getNameAsString() << "] DeclKind:["
+                  << VD->getDeclKindName() << "] Type: [" << VD->getType().getAsString()
+                  << "] at Loc: [" << VD->getBeginLoc().printToString(CI.getSourceManager())
+                  << "]\n";
+        *parseLog << "    ---  detailed information of the type\n";
+        printTypeInfo(VD->getType().getTypePtr());
+        if (isAPInt(VD))
+            *parseLog << "    ---  " << VD->getNameAsString() << " is ap int type ("
+                      << getAPIntName(VD) << ").\n";
+        parseLog->flush();
+        return true;
+    }
+
     // Toy: access functions in AST
     bool VisitFunctionDecl(FunctionDecl *f)
     {
@@ -245,12 +262,33 @@ class HI_FunctionInterfaceInfo_FrontendAction : public ASTFrontendAction
           functionAllInline(functionAllInline)
     {
     }
+
+    // the rewritten code is kept in the given buffer instead of being written into a file, so
+    // the compilation can take it directly
+    HI_FunctionInterfaceInfo_FrontendAction(const char *_parselog_name, Rewriter &R,
+                                            std::string &_outputCode_buffer,
+                                            std::map<std::string, int> &FuncParamLine2OutermostSize,
+                                            std::string topFunctioName, bool functionAllInline)
+        : parselog_name(_parselog_name), TheRewriter(R), outputCode_buffer(&_outputCode_buffer),
+          FuncParamLine2OutermostSize(FuncParamLine2OutermostSize), topFunctioName(topFunctioName),
+          functionAllInline(functionAllInline)
+    {
+    }
+
     void EndSourceFileAction() override
     {
         SourceManager &SM = TheRewriter.getSourceMgr();
         llvm::errs() << "** EndSourceFileAction for: "
                      << SM.getFileEntryForID(SM.getMainFileID())->getName()
                      << "\n"; // Now emit the rewritten buffer.
+        if (outputCode_buffer)
+        {
+            outputCode_buffer->clear();
+            llvm::raw_string_ostream outputCode_stream(*outputCode_buffer);
+            TheRewriter.getEditBuffer(SM.getMainFileID()).write(outputCode_stream);
+            outputCode_stream.flush();
+            return;
+        }
         outputCode =
             new llvm::raw_fd_ostream(outputCode_name.c_str(), ErrInfo, llvm::sys::fs::F_None);
         TheRewriter.getEditBuffer(SM.getMainFileID()).write(*outputCode);
@@ -272,6 +310,7 @@ class HI_FunctionInterfaceInfo_FrontendAction : public ASTFrontendAction
     std::string topFunctioName;
     std::string parselog_name;
     std::string outputCode_name;
+    std::string *outputCode_buffer = nullptr;
     raw_ostream *outputCode;
     std::error_code ErrInfo;
     bool functionAllInline = 0;
@@ -315,4 +354,42 @@ HI_FunctionInterfaceInfo_rewrite_newFrontendActionFactory(
         functionAllInline));
 }
 
+// We need a factory to produce such a frontend action, which keeps the rewritten code in memory
+template <typename T>
+std::unique_ptr<tooling::FrontendActionFactory>
+HI_FunctionInterfaceInfo_rewrite_newFrontendActionFactory(
+    const char *_parseLog_name, Rewriter &R, std::string &_outputCode_buffer,
+    std::map<std::string, int> &FuncParamLine2OutermostSize, std::string topFunctioName,
+    bool functionAllInline = 0)
+{
+    class SimpleFrontendActionFactory : public tooling::FrontendActionFactory
+    {
+      public:
+        SimpleFrontendActionFactory(const char *_parseLog_name, Rewriter &R,
+                                    std::string &_outputCode_buffer,
+                                    std::map<std::string, int> &FuncParamLine2OutermostSize,
+                                    std::string topFunctioName, bool functionAllInline = 0)
+            : parseLog_name(_parseLog_name), TheRewriter(R), outputCode_buffer(_outputCode_buffer),
+              FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
+              topFunctioName(topFunctioName), functionAllInline(functionAllInline)
+        {
+        }
+        FrontendAction *create() override
+        {
+            return new T(parseLog_name.c_str(), TheRewriter, outputCode_buffer,
+                         FuncParamLine2OutermostSize, topFunctioName, functionAllInline);
+        }
+        std::string parseLog_name;
+        std::string &outputCode_buffer;
+        Rewriter &TheRewriter;
+        std::map<std::string, int> &FuncParamLine2OutermostSize;
+        std::string topFunctioName;
+        bool functionAllInline = 0;
+    };
+
+    return std::unique_ptr<tooling::FrontendActionFactory>(new SimpleFrontendActionFactory(
+        _parseLog_name, R, _outputCode_buffer, FuncParamLine2OutermostSize, topFunctioName,
+        functionAllInline));
+}
+
 #endif
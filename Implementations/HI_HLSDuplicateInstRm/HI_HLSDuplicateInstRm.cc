@@ -29,57 +29,18 @@ bool HI_HLSDuplicateInstRm::runOnFunction(
     }
     bool removed = 0;
 
-    Block2Inst2DupInst.clear();
-
-    std::vector<Instruction *> PHINodeList;
     for (BasicBlock &B : F)
     {
-        for (Instruction &I : B)
-        {
-            if (I.getOpcode() == Instruction::PHI)
-            {
-                PHINodeList.push_back(&I);
-            }
-            if (I.getOpcode() == Instruction::Load || I.getOpcode() == Instruction::Store ||
-                I.getOpcode() == Instruction::Call || I.getOpcode() == Instruction::Alloca ||
-                I.getOpcode() == Instruction::Br)
-                continue;
-            checkDuplicationInBlock(&B, &I);
-        }
+        removed |= removeDuplicationInBlock(&B);
     }
 
-    std::set<Instruction *> removedI;
-    removedI.clear();
-
+    // collect the PHI nodes after the duplication removal, which might erase some of them
+    std::vector<Instruction *> PHINodeList;
     for (BasicBlock &B : F)
     {
-        for (auto dupIMap : Block2Inst2DupInst[&B])
+        for (PHINode &PHI_I : B.phis())
         {
-            if (removedI.find(dupIMap.first) == removedI.end())
-            {
-                Instruction *I = dupIMap.first;
-                for (auto dupI : dupIMap.second)
-                {
-                    if (removedI.find(dupI) != removedI.end())
-                        continue;
-                    if (dupI->getType() != I->getType())
-                        continue;
-                    if (DEBUG)
-                        *RemoveLog << "duplicated: " << *I << " -------  " << *dupI << "\n";
-                    if (DEBUG)
-                        *RemoveLog << "Remove: " << *dupI << "\n";
-                    if (DEBUG)
-                        *RemoveLog << "Block: \n" << B << "\n";
-                    if (DEBUG)
-                        RemoveLog->flush();
-                    dupI->replaceAllUsesWith(I);
-                    removedI.insert(dupI);
-                    // RecursivelyDeleteTriviallyDeadInstructions(dupI);
-
-                    dupI->eraseFromParent();
-                    removed = 1;
-                }
-            }
+            PHINodeList.push_back(&PHI_I);
         }
     }
 
@@ -90,7 +51,6 @@ bool HI_HLSDuplicateInstRm::runOnFunction(
         if (PHI_I->getNumIncomingValues() == 1)
         {
             PHI_I->replaceAllUsesWith(PHI_I->getOperand(0));
-            removedI.insert(PHI_I);
             PHI_I->eraseFromParent();
             removed = 1;
         }
@@ -109,14 +69,22 @@ void HI_HLSDuplicateInstRm::getAnalysisUsage(AnalysisUsage &AU) const
     AU.setPreservesCFG();
 }
 
-Instruction *HI_HLSDuplicateInstRm::checkDuplicationInBlock(BasicBlock *B, Instruction *I)
+bool HI_HLSDuplicateInstRm::isCandidateForNumbering(Instruction *I)
 {
-    if (BranchInst *tmpI = dyn_cast<BranchInst>(I))
-        return nullptr;
+    if (I->getOpcode() == Instruction::Load || I->getOpcode() == Instruction::Store ||
+        I->getOpcode() == Instruction::Call || I->getOpcode() == Instruction::Alloca ||
+        I->getOpcode() == Instruction::Br)
+        return false;
 
-    if (AllocaInst *tmpI = dyn_cast<AllocaInst>(I))
-        return nullptr;
+    // the instructions with side effects or without results do not compute values
+    if (I->isTerminator() || I->mayHaveSideEffects() || I->getType()->isVoidTy())
+        return false;
+
+    return true;
+}
 
+bool HI_HLSDuplicateInstRm::isExcludedLeader(Instruction *I)
+{
     // the Mul and Add might end up with MAC, don't rm them
     if (MulOperator *tmpI = dyn_cast<MulOperator>(I))
     {
@@ -124,51 +92,83 @@ Instruction *HI_HLSDuplicateInstRm::checkDuplicationInBlock(BasicBlock *B, Instr
         {
             if (AddOperator *Add_I = dyn_cast<AddOperator>(it->getUser()))
             {
-                return nullptr;
+                return true;
             }
         }
     }
+    return false;
+}
+
+bool HI_HLSDuplicateInstRm::removeDuplicationInBlock(BasicBlock *B)
+{
+    bool removed = 0;
+    ValueNumber2Leader.clear();
 
-    bool enableCheck = false;
-    for (Instruction &tmpII : *B)
+    for (auto I_it = B->begin(), I_ie = B->end(); I_it != I_ie;)
     {
-        Instruction *tmpI = &tmpII;
-        if (enableCheck)
+        Instruction *I = &*I_it;
+        ++I_it; // the instruction might be erased
+
+        if (!isCandidateForNumbering(I))
+            continue;
+
+        auto leader_it = ValueNumber2Leader.find(I);
+        if (leader_it == ValueNumber2Leader.end())
         {
-            // check if they are the same
-
-            bool sameOpcode = tmpI->getOpcode() == I->getOpcode();
-            bool sameOperands = 1;
-            bool PHI_SameIncome = 1;
-            if (tmpI->getNumOperands() != I->getNumOperands() || !sameOpcode)
-                sameOperands = 0;
-            else
-            {
-                if (PHINode *tmpI0 = dyn_cast<PHINode>(tmpI))
-                {
-                    // if it is a PHI Node, check the field too.
-                    PHINode *tmpI1 = dyn_cast<PHINode>(I);
-                    for (int i = 0; i < tmpI->getNumOperands(); ++i)
-                    {
-                        sameOperands &= (tmpI->getOperand(i) == I->getOperand(i));
-                        sameOperands &= tmpI0->getIncomingBlock(i) == tmpI1->getIncomingBlock(i);
-                    }
-                }
-                else
-                {
-                    for (int i = 0; i < tmpI->getNumOperands(); ++i)
-                    {
-                        sameOperands &= (tmpI->getOperand(i) == I->getOperand(i));
-                    }
-                }
-            }
-            if (sameOpcode && sameOperands)
-            {
-                Block2Inst2DupInst[B][I].push_back(tmpI);
-                // return tmpI;
-            }
+            // an excluded instruction can still be replaced by an earlier leader, as the users
+            // will be taken by the leader
+            if (!isExcludedLeader(I))
+                ValueNumber2Leader.insert(I);
+            continue;
+        }
+
+        Instruction *leaderI = *leader_it;
+        if (DEBUG)
+            *RemoveLog << "duplicated: " << *leaderI << " -------  " << *I << "\n";
+        if (DEBUG)
+            *RemoveLog << "Remove: " << *I << "\n";
+        if (DEBUG)
+            *RemoveLog << "Block: \n" << *B << "\n";
+        if (DEBUG)
+            RemoveLog->flush();
+
+        // the PHI nodes of the block might use the instruction via the back edge and they might
+        // be in the table already. Their hash values will change, so take them out before.
+        for (User *U : I->users())
+        {
+            PHINode *PHI_U = dyn_cast<PHINode>(U);
+            if (!PHI_U || PHI_U->getParent() != B)
+                continue;
+            auto PHI_it = ValueNumber2Leader.find(PHI_U);
+            if (PHI_it != ValueNumber2Leader.end() && *PHI_it == PHI_U)
+                ValueNumber2Leader.erase(PHI_it);
         }
-        enableCheck |= tmpI == I;
+
+        // the flags like nsw should hold for both of them
+        leaderI->andIRFlags(I);
+        I->replaceAllUsesWith(leaderI);
+        I->eraseFromParent();
+        removedInstNum++;
+        removed = 1;
     }
-    return nullptr;
-}
\ No newline at end of file
+    return removed;
+}
+
+unsigned HI_DupInstInfo::getHashValue(const Instruction *I)
+{
+    hash_code hash = hash_combine(I->getOpcode(), I->getType(),
+                                  hash_combine_range(I->value_op_begin(), I->value_op_end()));
+    if (const CmpInst *Cmp_I = dyn_cast<CmpInst>(I))
+        hash = hash_combine(hash, Cmp_I->getPredicate());
+    if (const PHINode *PHI_I = dyn_cast<PHINode>(I))
+        hash = hash_combine(hash, hash_combine_range(PHI_I->block_begin(), PHI_I->block_end()));
+    return hash;
+}
+
+bool HI_DupInstInfo::isEqual(const Instruction *LHS, const Instruction *RHS)
+{
+    if (LHS == getEmptyKey() || LHS == getTombstoneKey() || RHS == getEmptyKey() ||
+        RHS == getTombstoneKey())
+        return LHS == RHS;
+    return LHS->isIdenticalToWhenDefined(RHS);
+}
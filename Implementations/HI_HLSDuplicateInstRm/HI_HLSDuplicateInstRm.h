@@ -4,7 +4,9 @@
 #include "HI_print.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/LoopInfo.h"
 #include "llvm/Analysis/MemoryBuiltins.h"
@@ -51,12 +53,33 @@
 
 using namespace llvm;
 
+// The hashing of the instructions for the local value numbering, where two instructions are
+// equal if they compute the same value, i.e. the same opcode, type, operands and special state
+// (e.g. the predicate of a comparison and the incoming blocks of a PHI)
+struct HI_DupInstInfo
+{
+    static inline Instruction *getEmptyKey()
+    {
+        return DenseMapInfo<Instruction *>::getEmptyKey();
+    }
+
+    static inline Instruction *getTombstoneKey()
+    {
+        return DenseMapInfo<Instruction *>::getTombstoneKey();
+    }
+
+    static unsigned getHashValue(const Instruction *I);
+
+    static bool isEqual(const Instruction *LHS, const Instruction *RHS);
+};
+
 class HI_HLSDuplicateInstRm : public FunctionPass
 {
   public:
     HI_HLSDuplicateInstRm(const char *RemoveLog_Name, bool DEBUG = 0)
         : FunctionPass(ID), DEBUG(DEBUG)
     {
+        removedInstNum = 0;
         Instruction_Counter = 0;
         Function_Counter = 0;
         BasicBlock_Counter = 0;
@@ -93,6 +116,7 @@ class HI_HLSDuplicateInstRm : public FunctionPass
     virtual bool doInitialization(Module &M)
     {
         print_status("Initilizing HI_HLSDuplicateInstRm pass.");
+        removedInstNum = 0;
         for (auto it : Instruction2Pre_id)
         {
             delete it.second;
@@ -129,10 +153,12 @@ class HI_HLSDuplicateInstRm : public FunctionPass
         return false;
     }
 
-    // virtual bool doFinalization(Module &M)
-    // {
-    //     return false;
-    // }
+    virtual bool doFinalization(Module &M)
+    {
+        print_status("done HI_HLSDuplicateInstRm: removed " + std::to_string(removedInstNum) +
+                     " duplicated instructions");
+        return false;
+    }
 
     void getAnalysisUsage(AnalysisUsage &AU) const;
     virtual bool runOnFunction(Function &M);
@@ -140,8 +166,16 @@ class HI_HLSDuplicateInstRm : public FunctionPass
 
     bool DEBUG;
 
-    // find whether there is duplication in the block for the instruction
-    Instruction *checkDuplicationInBlock(BasicBlock *B, Instruction *I);
+    // remove the instructions in the block which compute the same values as the earlier ones, with
+    // one walk of the block and a hash table of the value numbers
+    bool removeDuplicationInBlock(BasicBlock *B);
+
+    // whether the instruction can take part in the value numbering
+    bool isCandidateForNumbering(Instruction *I);
+
+    // whether the instruction cannot be the leader of its value number, e.g. the Mul which might
+    // end up with MAC with its Add user
+    bool isExcludedLeader(Instruction *I);
 
     int callCounter;
     int Instruction_Counter;
@@ -151,7 +185,12 @@ class HI_HLSDuplicateInstRm : public FunctionPass
 
     Function *TargeFunction;
 
-    std::map<BasicBlock *, std::map<Instruction *, std::vector<Instruction *>>> Block2Inst2DupInst;
+    // the leaders of the value numbers in the block under processing, the buckets are reused
+    // across the blocks
+    DenseSet<Instruction *, HI_DupInstInfo> ValueNumber2Leader;
+
+    // the number of the duplicated instructions removed in the module
+    int removedInstNum;
 
     std::map<Function *, int> Function_id;
     std::map<Instruction *, int> Instruction_id;
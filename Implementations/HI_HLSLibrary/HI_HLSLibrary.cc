@@ -0,0 +1,496 @@
+#include "HI_HLSLibrary.h"
+#include "HI_print.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+
+static const char HI_HLSLibBinaryMagic[8] = {'H', 'I', 'H', 'L', 'S', 'L', 'I', 'B'};
+
+std::string HI_HLSLibBinaryName(std::string HLS_lib_path)
+{
+    return HLS_lib_path + "HLS_Data_Lib.bin";
+}
+
+static std::string getTextFileName(std::string HLS_lib_path, std::string opcode)
+{
+    return HLS_lib_path + opcode + "/" + opcode;
+}
+
+// hash of the names, sizes and modification times of the text files, which is used to detect
+// whether the binary library is stale. 0 is returned if any text file is missing.
+static uint64_t getSourceStamp(std::string HLS_lib_path, const std::vector<std::string> &opcodes)
+{
+    std::string stamp_str;
+    for (auto &opcode : opcodes)
+    {
+        llvm::sys::fs::file_status status;
+        if (llvm::sys::fs::status(getTextFileName(HLS_lib_path, opcode), status))
+            return 0;
+        stamp_str += opcode + ":" + std::to_string(status.getSize()) + ":" +
+                     std::to_string(status.getLastModificationTime().time_since_epoch().count()) +
+                     ";";
+    }
+    return llvm::xxHash64(stamp_str);
+}
+
+static bool copyField(char *field, int field_size, const std::string &str)
+{
+    if (str.size() >= field_size)
+        return false;
+    strncpy(field, str.c_str(), field_size - 1);
+    return true;
+}
+
+bool HI_parseHLSLibTextFile(std::string opcode, std::string info_file_name,
+                            std::vector<HI_HLSLibRecord> &records)
+{
+    std::ifstream info_file(info_file_name.c_str());
+    if (!info_file.is_open())
+        return false;
+
+    std::string tmp_s;
+    while (getline(info_file, tmp_s))
+    {
+        // str(oprandA)+" "+str(oprandB)+" "+str(oprandC)+" "+str(period)+" "
+        // +str(DSP48E_N)+" "+str(FF_N)+" "+str(LUT_N)+" "+str(lat_tmp)+" "
+        // +str(delay_tmp)+" "+str(II_tmp)+" "+str(Core_tmp)
+        std::stringstream iss(tmp_s);
+        std::string data_ele[11];
+        for (int j = 0; j < 11; j++)
+            iss >> data_ele[j];
+        if (data_ele[10] == "")
+            continue; // ignore incomplete lines
+
+        if (opcode != "mac")
+        {
+            if (data_ele[0] != data_ele[1] || data_ele[1] != data_ele[2])
+                continue; // ignore those unused information
+        }
+        else
+        {
+            if (data_ele[0] != data_ele[1])
+                continue; // ignore those unused information
+        }
+
+        HI_HLSLibRecord record;
+        memset(&record, 0, sizeof(record)); // keep the padding bytes deterministic for checksum
+        if (!copyField(record.opcode, sizeof(record.opcode), opcode) ||
+            !copyField(record.clock_period, sizeof(record.clock_period), data_ele[3]) ||
+            !copyField(record.core_name, sizeof(record.core_name), data_ele[10]))
+        {
+            print_error("Unexpected long field in [" + info_file_name + "]: " + tmp_s);
+            return false;
+        }
+        record.oprand_bitwidth = std::stoi(data_ele[0]);
+        record.res_bitwidth = std::stoi(data_ele[2]);
+        record.DSP = std::stoi(data_ele[4]);
+        record.FF = std::stoi(data_ele[5]);
+        record.LUT = std::stoi(data_ele[6]);
+        record.Lat = std::stoi(data_ele[7]);
+        record.delay = std::stod(data_ele[8]);
+        record.II = std::stoi(data_ele[9]);
+        records.push_back(record);
+    }
+    return true;
+}
+
+bool HI_compileHLSLibrary(std::string HLS_lib_path, const std::vector<std::string> &opcodes)
+{
+    // get the stamp before parsing, so a text file modified during the compilation will make
+    // the binary library stale
+    uint64_t sourceStamp = getSourceStamp(HLS_lib_path, opcodes);
+
+    std::vector<HI_HLSLibRecord> records;
+    for (auto &opcode : opcodes)
+    {
+        std::string info_file_name = getTextFileName(HLS_lib_path, opcode);
+        if (!sourceStamp || !HI_parseHLSLibTextFile(opcode, info_file_name, records))
+        {
+            print_error("The HLS info file [" + info_file_name + "] cannot be parsed.");
+            return false;
+        }
+    }
+
+    HI_HLSLibBinaryHeader header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, HI_HLSLibBinaryMagic, sizeof(header.magic));
+    header.version = HI_HLSLibBinaryVersion;
+    header.recordSize = sizeof(HI_HLSLibRecord);
+    header.recordNum = records.size();
+    header.sourceStamp = sourceStamp;
+    header.checksum = llvm::xxHash64(llvm::StringRef((const char *)records.data(),
+                                                     records.size() * sizeof(HI_HLSLibRecord)));
+
+    // write to a unique file and rename it, so the evaluators will not map a partial file
+    std::string binary_file_name = HI_HLSLibBinaryName(HLS_lib_path);
+    int binary_fd;
+    llvm::SmallString<128> tmpBinaryPath;
+    if (llvm::sys::fs::createUniqueFile(binary_file_name + "-%%%%%%", binary_fd, tmpBinaryPath))
+    {
+        print_error("Cannot create the binary HLS library [" + binary_file_name + "].");
+        return false;
+    }
+    {
+        llvm::raw_fd_ostream binary_out(binary_fd, /*shouldClose=*/true);
+        binary_out.write((const char *)&header, sizeof(header));
+        binary_out.write((const char *)records.data(), records.size() * sizeof(HI_HLSLibRecord));
+    }
+    if (llvm::sys::fs::rename(tmpBinaryPath, binary_file_name))
+    {
+        llvm::sys::fs::remove(tmpBinaryPath);
+        print_error("Cannot create the binary HLS library [" + binary_file_name + "].");
+        return false;
+    }
+    print_info("The binary HLS library [" + binary_file_name + "] is generated with " +
+               std::to_string(records.size()) + " records.");
+    return true;
+}
+
+std::unique_ptr<HI_HLSLibTable> HI_loadHLSLibTable(std::string HLS_lib_path,
+                                                   const std::vector<std::string> &opcodes,
+                                                   const std::vector<std::string> &clocks)
+{
+    if (auto binaryLib = HI_HLSLibBinary::open(HLS_lib_path, opcodes))
+        return std::unique_ptr<HI_HLSLibTable>(
+            new HI_HLSLibTable(opcodes, clocks, std::move(binaryLib)));
+
+    print_warning("The binary HLS library [" + HI_HLSLibBinaryName(HLS_lib_path) +
+                  "] is missing or stale, the text files are loaded instead. It can be "
+                  "generated by HLS_Lib_Compiler.");
+    std::vector<HI_HLSLibRecord> records;
+    for (auto &opcode : opcodes)
+    {
+        std::string info_file_name = getTextFileName(HLS_lib_path, opcode);
+        if (!HI_parseHLSLibTextFile(opcode, info_file_name, records))
+        {
+            print_error("The HLS info file [" + info_file_name + "] does not exist.");
+            return nullptr;
+        }
+    }
+    return std::unique_ptr<HI_HLSLibTable>(new HI_HLSLibTable(opcodes, clocks, std::move(records)));
+}
+
+HI_HLSLibBinary::HI_HLSLibBinary(std::unique_ptr<llvm::sys::fs::mapped_file_region> region)
+    : region(std::move(region))
+{
+    auto header = (const HI_HLSLibBinaryHeader *)this->region->const_data();
+    records = (const HI_HLSLibRecord *)(this->region->const_data() + sizeof(HI_HLSLibBinaryHeader));
+    recordNum = header->recordNum;
+}
+
+std::unique_ptr<HI_HLSLibBinary> HI_HLSLibBinary::open(std::string HLS_lib_path,
+                                                       const std::vector<std::string> &opcodes)
+{
+    std::string binary_file_name = HI_HLSLibBinaryName(HLS_lib_path);
+    uint64_t file_size;
+    if (llvm::sys::fs::file_size(binary_file_name, file_size) ||
+        file_size < sizeof(HI_HLSLibBinaryHeader))
+        return nullptr;
+
+    int binary_fd;
+    if (llvm::sys::fs::openFileForRead(binary_file_name, binary_fd))
+        return nullptr;
+    std::error_code EC;
+    std::unique_ptr<llvm::sys::fs::mapped_file_region> region(
+        new llvm::sys::fs::mapped_file_region(
+            binary_fd, llvm::sys::fs::mapped_file_region::readonly, file_size, 0, EC));
+    close(binary_fd);
+    if (EC)
+        return nullptr;
+
+    // check the format, the size, the stamp of the text files and the checksum of the records
+    auto header = (const HI_HLSLibBinaryHeader *)region->const_data();
+    if (memcmp(header->magic, HI_HLSLibBinaryMagic, sizeof(header->magic)) ||
+        header->version != HI_HLSLibBinaryVersion ||
+        header->recordSize != sizeof(HI_HLSLibRecord) ||
+        file_size != sizeof(HI_HLSLibBinaryHeader) + header->recordNum * sizeof(HI_HLSLibRecord))
+        return nullptr;
+    uint64_t sourceStamp = getSourceStamp(HLS_lib_path, opcodes);
+    if (!sourceStamp || header->sourceStamp != sourceStamp)
+        return nullptr;
+    if (header->checksum !=
+        llvm::xxHash64(llvm::StringRef(region->const_data() + sizeof(HI_HLSLibBinaryHeader),
+                                       header->recordNum * sizeof(HI_HLSLibRecord))))
+        return nullptr;
+
+    return std::unique_ptr<HI_HLSLibBinary>(new HI_HLSLibBinary(std::move(region)));
+}
+
+// the string in a fixed-size field of a record, which might not be terminated
+static llvm::StringRef getField(const char *field, size_t field_size)
+{
+    return llvm::StringRef(field, strnlen(field, field_size));
+}
+
+HI_HLSLibTable::HI_HLSLibTable(const std::vector<std::string> &opcodes,
+                               const std::vector<std::string> &clocks)
+    : opcodeNum(opcodes.size()), opcodes(opcodes), clocks(clocks),
+      bitwidthBlocks(opcodes.size() * bitwidthSlotNum * bitwidthSlotNum, -1)
+{
+    for (int i = 0; i < opcodes.size(); i++)
+        opcode2ID[opcodes[i]] = i;
+
+    // intern the clock periods, so they are never parsed again by the lookups
+    for (int i = 0; i < clocks.size(); i++)
+    {
+        clock2ID.insert(std::make_pair(clocks[i], i));
+        double value;
+        if (llvm::StringRef(clocks[i]).getAsDouble(value))
+        {
+            print_warning("The clock period [" + clocks[i] + "] is not a number and ignored.");
+            clockValues.push_back(std::numeric_limits<float>::quiet_NaN());
+        }
+        else
+            clockValues.push_back(value);
+    }
+}
+
+HI_HLSLibTable::HI_HLSLibTable(const std::vector<std::string> &opcodes,
+                               const std::vector<std::string> &clocks,
+                               std::vector<HI_HLSLibRecord> records)
+    : HI_HLSLibTable(opcodes, clocks)
+{
+    parsedRecords = std::move(records);
+    build(parsedRecords.data(), parsedRecords.data() + parsedRecords.size());
+}
+
+HI_HLSLibTable::HI_HLSLibTable(const std::vector<std::string> &opcodes,
+                               const std::vector<std::string> &clocks,
+                               std::unique_ptr<HI_HLSLibBinary> binaryLib)
+    : HI_HLSLibTable(opcodes, clocks)
+{
+    this->binaryLib = std::move(binaryLib);
+    build(this->binaryLib->begin(), this->binaryLib->end());
+}
+
+void HI_HLSLibTable::build(const HI_HLSLibRecord *begin, const HI_HLSLibRecord *end)
+{
+    sourceRecords = begin;
+    sourceNum = end - begin;
+    sourceClockIDs.resize(sourceNum, -1);
+
+    int skippedNum = 0;
+    for (int32_t recordIndex = 0; recordIndex < sourceNum; recordIndex++)
+    {
+        const HI_HLSLibRecord &record = sourceRecords[recordIndex];
+        int opcodeID = getOpcodeID(getField(record.opcode, sizeof(record.opcode)));
+        int clockID = getClockID(getField(record.clock_period, sizeof(record.clock_period)));
+        int oprandSlot = getBitwidthSlot(record.oprand_bitwidth);
+        int resSlot = getBitwidthSlot(record.res_bitwidth);
+        sourceClockIDs[recordIndex] = clockID;
+        if (opcodeID < 0 || clockID < 0 || oprandSlot < 0 || resSlot < 0)
+        {
+            skippedNum++;
+            continue;
+        }
+
+        // the later record overwrites the earlier one, like the order of the text files
+        int block = getOrCreateBlock(opcodeID, oprandSlot, resSlot);
+        clockEntries[block * clocks.size() + clockID] = recordIndex;
+    }
+    if (skippedNum)
+        print_warning(std::to_string(skippedNum) +
+                      " records of the HLS library are out of the table (unknown opcode/clock or "
+                      "unsupported bitwidth) and ignored.");
+
+    fillMissingClocks();
+    interpolateBitwidths();
+}
+
+int HI_HLSLibTable::getOrCreateBlock(int opcodeID, int oprandSlot, int resSlot)
+{
+    int32_t &block = bitwidthBlocks[getBlockPos(opcodeID, oprandSlot, resSlot)];
+    if (block < 0)
+    {
+        block = clockEntries.size() / clocks.size();
+        clockEntries.resize(clockEntries.size() + clocks.size(), -1);
+    }
+    return block;
+}
+
+void HI_HLSLibTable::fillMissingClocks()
+{
+    // visit the clocks from the shortest period to the longest one, the malformed ones have no
+    // records
+    std::vector<int> clockOrder;
+    for (int i = 0; i < clocks.size(); i++)
+        if (!std::isnan(clockValues[i]))
+            clockOrder.push_back(i);
+    std::stable_sort(clockOrder.begin(), clockOrder.end(),
+                     [this](int a, int b) { return clockValues[a] < clockValues[b]; });
+
+    int blockNum = clockEntries.size() / clocks.size();
+    for (int block = 0; block < blockNum; block++)
+    {
+        int32_t fasterEntry = -1;
+        for (int clockID : clockOrder)
+        {
+            int32_t &entry = clockEntries[block * clocks.size() + clockID];
+            if (entry >= 0)
+                fasterEntry = entry;
+            else if (fasterEntry >= 0)
+            {
+                // the record keeps the clock period it is characterized at
+                entry = fasterEntry;
+            }
+        }
+    }
+}
+
+// interpolate between a and b at k/n, rounded up or down
+static int32_t interpolateInt(int32_t a, int32_t b, int k, int n, bool roundUp)
+{
+    int64_t sum = (int64_t)a * (n - k) + (int64_t)b * k;
+    if (roundUp)
+        return (sum + n - 1) / n;
+    return sum / n;
+}
+
+void HI_HLSLibTable::interpolateBitwidths()
+{
+    for (int opcodeID = 0; opcodeID < opcodeNum; opcodeID++)
+    {
+        // the characterized bitwidths are visited along each line of (w, w + d), where the slot
+        // of bitwidth w > 0 is w itself
+        for (int d = 1 - HI_HLSLibMaxBitwidth; d < HI_HLSLibMaxBitwidth; d++)
+        {
+            int minWidth = std::max(1, 1 - d);
+            int maxWidth = std::min(HI_HLSLibMaxBitwidth, HI_HLSLibMaxBitwidth - d);
+            int lowerWidth = -1;
+            for (int width = minWidth; width <= maxWidth; width++)
+            {
+                int upperBlock = bitwidthBlocks[getBlockPos(opcodeID, width, width + d)];
+                if (upperBlock < 0)
+                    continue;
+                if (lowerWidth > 0 && width - lowerWidth > 1)
+                {
+                    int lowerBlock =
+                        bitwidthBlocks[getBlockPos(opcodeID, lowerWidth, lowerWidth + d)];
+                    int n = width - lowerWidth;
+                    for (int k = 1; k < n; k++)
+                    {
+                        int block = -1;
+                        for (int clockID = 0; clockID < clocks.size(); clockID++)
+                        {
+                            int32_t lowerEntry = getEntry(lowerBlock, clockID);
+                            int32_t upperEntry = getEntry(upperBlock, clockID);
+                            if (lowerEntry < 0 || upperEntry < 0)
+                                continue;
+                            const HI_HLSLibRecord &A = getRecord(lowerEntry);
+                            const HI_HLSLibRecord &B = getRecord(upperEntry);
+                            HI_HLSLibRecord record = B;
+                            record.oprand_bitwidth = lowerWidth + k;
+                            record.res_bitwidth = lowerWidth + k + d;
+                            record.DSP = interpolateInt(A.DSP, B.DSP, k, n, true);
+                            record.FF = interpolateInt(A.FF, B.FF, k, n, true);
+                            record.LUT = interpolateInt(A.LUT, B.LUT, k, n, false);
+                            record.Lat = interpolateInt(A.Lat, B.Lat, k, n, false);
+                            record.delay = (A.delay * (n - k) + B.delay * k) / n;
+                            record.II = interpolateInt(A.II, B.II, k, n, true);
+
+                            if (block < 0)
+                                block = getOrCreateBlock(opcodeID, lowerWidth + k,
+                                                         lowerWidth + k + d);
+                            clockEntries[block * clocks.size() + clockID] =
+                                addInferredRecord(record);
+                        }
+                    }
+                }
+                lowerWidth = width;
+            }
+        }
+    }
+}
+
+int HI_HLSLibTable::getOpcodeID(llvm::StringRef opcode) const
+{
+    auto it = opcode2ID.find(opcode);
+    if (it == opcode2ID.end())
+        return -1;
+    return it->second;
+}
+
+int HI_HLSLibTable::getClockID(llvm::StringRef period) const
+{
+    auto it = clock2ID.find(period);
+    if (it != clock2ID.end())
+        return it->second;
+    // e.g. "10.0" is the same clock period as "10"
+    double value;
+    if (period.getAsDouble(value))
+        return -1;
+    for (int i = 0; i < clocks.size(); i++)
+        if ((float)value == clockValues[i])
+            return i;
+    return -1;
+}
+
+int HI_HLSLibTable::getBlockIndex(int opcodeID, int oprand_bitwidth, int res_bitwidth) const
+{
+    int oprandSlot = getBitwidthSlot(oprand_bitwidth);
+    int resSlot = getBitwidthSlot(res_bitwidth);
+    if (opcodeID < 0 || opcodeID >= opcodeNum || oprandSlot < 0 || resSlot < 0)
+        return -1;
+    return bitwidthBlocks[(opcodeID * bitwidthSlotNum + oprandSlot) * bitwidthSlotNum + resSlot];
+}
+
+int64_t HI_HLSLibTable::getEntryIndex(int opcodeID, int oprand_bitwidth, int res_bitwidth,
+                                      int clockID) const
+{
+    int oprandSlot = getBitwidthSlot(oprand_bitwidth);
+    int resSlot = getBitwidthSlot(res_bitwidth);
+    if (opcodeID < 0 || opcodeID >= opcodeNum || oprandSlot < 0 || resSlot < 0 || clockID < 0 ||
+        clockID >= clocks.size())
+        return -1;
+    return (((int64_t)opcodeID * bitwidthSlotNum + oprandSlot) * bitwidthSlotNum + resSlot) *
+               clocks.size() +
+           clockID;
+}
+
+const HI_HLSLibRecord *HI_HLSLibTable::lookup(int opcodeID, int oprand_bitwidth, int res_bitwidth,
+                                              int clockID) const
+{
+    int block = getBlockIndex(opcodeID, oprand_bitwidth, res_bitwidth);
+    if (block < 0 || clockID < 0 || clockID >= clocks.size())
+        return nullptr;
+    int32_t recordIndex = clockEntries[block * clocks.size() + clockID];
+    if (recordIndex < 0)
+        return nullptr;
+    return &getRecord(recordIndex);
+}
+
+const HI_HLSLibRecord *HI_HLSLibTable::lookup(llvm::StringRef opcode, int oprand_bitwidth,
+                                              int res_bitwidth, llvm::StringRef period) const
+{
+    return lookup(getOpcodeID(opcode), oprand_bitwidth, res_bitwidth, getClockID(period));
+}
+
+bool HI_HLSLibTable::hasBitwidths(int opcodeID, int oprand_bitwidth, int res_bitwidth) const
+{
+    return getBlockIndex(opcodeID, oprand_bitwidth, res_bitwidth) >= 0;
+}
+
+bool HI_HLSLibTable::isCharacterized(int opcodeID, int oprand_bitwidth, int res_bitwidth,
+                                     int clockID) const
+{
+    int block = getBlockIndex(opcodeID, oprand_bitwidth, res_bitwidth);
+    if (block < 0 || clockID < 0 || clockID >= clocks.size())
+        return false;
+    // the inferred records and the records of other clocks are not characterized
+    int32_t recordIndex = getEntry(block, clockID);
+    return recordIndex >= 0 && recordIndex < sourceNum && sourceClockIDs[recordIndex] == clockID;
+}
+
+bool HI_HLSLibTable::isCharacterized(llvm::StringRef opcode, int oprand_bitwidth,
+                                     int res_bitwidth, llvm::StringRef period) const
+{
+    return isCharacterized(getOpcodeID(opcode), oprand_bitwidth, res_bitwidth,
+                           getClockID(period));
+}
@@ -0,0 +1,271 @@
+#ifndef _HI_HLSLIBRARY
+#define _HI_HLSLIBRARY
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// The HLS library (HLS_Data_Lib/<opcode>/<opcode>) is a set of text files, which are parsed
+// whenever an evaluator is initialized. The library can be compiled into one binary file
+// (HLS_Data_Lib.bin under the library path), which is a header followed by an array of the
+// records used by the evaluators. The binary file is mapped into memory without any parsing.
+// If it is missing, broken or older than the text files, the evaluators load the text files.
+
+// the version of the binary format, increase it whenever HI_HLSLibRecord is changed
+const uint32_t HI_HLSLibBinaryVersion = 1;
+
+// the information of an instruction at a specific bitwidth and clock period.
+// It is a POD with fixed-size fields so it can be stored/mapped as it is.
+struct HI_HLSLibRecord
+{
+    char opcode[16];
+    int32_t oprand_bitwidth;
+    int32_t res_bitwidth;
+    char clock_period[8];
+
+    // resource
+    int32_t DSP;
+    int32_t FF;
+    int32_t LUT;
+
+    // timing
+    int32_t Lat;
+    float delay;
+    int32_t II;
+
+    // core
+    char core_name[32];
+};
+
+struct HI_HLSLibBinaryHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t recordSize;
+    uint64_t recordNum;
+    // hash of the names, sizes and modification times of the text files
+    uint64_t sourceStamp;
+    // hash of the records following the header
+    uint64_t checksum;
+};
+
+// the file name of the binary library under the library path
+std::string HI_HLSLibBinaryName(std::string HLS_lib_path);
+
+// parse the text file of an opcode and append the records which are used by the evaluators
+bool HI_parseHLSLibTextFile(std::string opcode, std::string info_file_name,
+                            std::vector<HI_HLSLibRecord> &records);
+
+// parse the text files of the opcodes and write them into the binary library
+bool HI_compileHLSLibrary(std::string HLS_lib_path, const std::vector<std::string> &opcodes);
+
+// The binary library mapped into memory
+class HI_HLSLibBinary
+{
+  public:
+    // map the binary library of the opcodes, nullptr is returned if the binary file is missing,
+    // broken or stale
+    static std::unique_ptr<HI_HLSLibBinary> open(std::string HLS_lib_path,
+                                                 const std::vector<std::string> &opcodes);
+
+    const HI_HLSLibRecord *begin() const
+    {
+        return records;
+    }
+
+    const HI_HLSLibRecord *end() const
+    {
+        return records + recordNum;
+    }
+
+    uint64_t size() const
+    {
+        return recordNum;
+    }
+
+  private:
+    HI_HLSLibBinary(std::unique_ptr<llvm::sys::fs::mapped_file_region> region);
+
+    std::unique_ptr<llvm::sys::fs::mapped_file_region> region;
+    const HI_HLSLibRecord *records;
+    uint64_t recordNum;
+};
+
+class HI_HLSLibTable;
+
+// load the records of the opcodes into a table, from the binary library if it is valid (the
+// records are read from the mapped file without copying), otherwise from the text files.
+// nullptr is returned if the library cannot be loaded.
+std::unique_ptr<HI_HLSLibTable> HI_loadHLSLibTable(std::string HLS_lib_path,
+                                                   const std::vector<std::string> &opcodes,
+                                                   const std::vector<std::string> &clocks);
+
+// the maximum bitwidth indexed by HI_HLSLibTable, -1 (unrelated to bitwidth) is also indexed
+const int HI_HLSLibMaxBitwidth = 128;
+
+// The dense table of the HLS library, indexed by (opcode ID, operand bitwidth, result bitwidth,
+// clock ID). The opcode/clock IDs are the positions in the lists given to the constructor, so the
+// lookup is O(1) and no string comparison is needed once the IDs are known. The clock periods are
+// interned when the table is built: the period of each record is mapped to its clock ID once, and
+// the periods are parsed into values once, so the evaluators resolve the IDs of their opcodes and
+// clock once and then look up (opcode ID, bitwidths, clock ID) only. The table is read-only after
+// construction, so it can be shared by evaluators (e.g. in different threads).
+//
+// The records of the library are not copied into the table: they are read from the mapped binary
+// library (which is kept mapped by the table) or from the parsed text files owned by the table.
+// Only the inferred records are stored separately.
+//
+// The library does not characterize every bitwidth at every clock period, so the missing entries
+// are inferred once by the constructor:
+// (1) clock: a missing clock period takes the record of the nearest shorter period characterized
+//     for the same bitwidths, i.e. an implementation meeting a faster clock is used for a slower
+//     one, so the inferred information is monotone in the clock period.
+// (2) bitwidth: a missing (operand, result) bitwidth pair between two known pairs with the same
+//     difference, i.e. (w0, w0 + d) and (w1, w1 + d), is interpolated linearly at each clock where
+//     both are available. DSP/FF/II are rounded up and LUT/Lat are rounded down, and the core name
+//     is taken from the wider one. For an odd width between two even widths this is the average
+//     used by the evaluators before.
+// The bitwidths out of the characterized range are not extrapolated and stay unavailable.
+class HI_HLSLibTable
+{
+  public:
+    // the records are parsed from the text files
+    HI_HLSLibTable(const std::vector<std::string> &opcodes, const std::vector<std::string> &clocks,
+                   std::vector<HI_HLSLibRecord> records);
+
+    // the records are read from the mapped binary library
+    HI_HLSLibTable(const std::vector<std::string> &opcodes, const std::vector<std::string> &clocks,
+                   std::unique_ptr<HI_HLSLibBinary> binaryLib);
+
+    // -1 is returned if the opcode/clock is not in the table. The clock periods are compared by
+    // their values if the string is not found, and a malformed period is not in the table.
+    int getOpcodeID(llvm::StringRef opcode) const;
+    int getClockID(llvm::StringRef period) const;
+
+    int getOpcodeNum() const
+    {
+        return opcodeNum;
+    }
+
+    int getClockNum() const
+    {
+        return clocks.size();
+    }
+
+    const std::string &getOpcodeStr(int opcodeID) const
+    {
+        return opcodes[opcodeID];
+    }
+
+    const std::string &getClockStr(int clockID) const
+    {
+        return clocks[clockID];
+    }
+
+    // the unique index of an entry in the table, -1 is returned if the parameters are out of range
+    int64_t getEntryIndex(int opcodeID, int oprand_bitwidth, int res_bitwidth, int clockID) const;
+
+    // nullptr is returned if the information is not in the library
+    const HI_HLSLibRecord *lookup(int opcodeID, int oprand_bitwidth, int res_bitwidth,
+                                  int clockID) const;
+
+    const HI_HLSLibRecord *lookup(llvm::StringRef opcode, int oprand_bitwidth, int res_bitwidth,
+                                  llvm::StringRef period) const;
+
+    // check whether the information of the bitwidths is available at any clock period
+    bool hasBitwidths(int opcodeID, int oprand_bitwidth, int res_bitwidth) const;
+
+    // check whether the information is characterized in the library rather than inferred
+    bool isCharacterized(int opcodeID, int oprand_bitwidth, int res_bitwidth, int clockID) const;
+
+    bool isCharacterized(llvm::StringRef opcode, int oprand_bitwidth, int res_bitwidth,
+                         llvm::StringRef period) const;
+
+  private:
+    HI_HLSLibTable(const std::vector<std::string> &opcodes, const std::vector<std::string> &clocks);
+
+    // index the records of the library, which are kept by the table
+    void build(const HI_HLSLibRecord *begin, const HI_HLSLibRecord *end);
+
+    // the record of an entry, the records of the library go before the inferred ones
+    const HI_HLSLibRecord &getRecord(int32_t recordIndex) const
+    {
+        if (recordIndex < sourceNum)
+            return sourceRecords[recordIndex];
+        return inferredRecords[recordIndex - sourceNum];
+    }
+
+    // add an inferred record and get its index
+    int32_t addInferredRecord(const HI_HLSLibRecord &record)
+    {
+        inferredRecords.push_back(record);
+        return sourceNum + inferredRecords.size() - 1;
+    }
+
+    // -1 is mapped to 0 and other bitwidths are mapped to themselves
+    int getBitwidthSlot(int bitwidth) const
+    {
+        if (bitwidth == -1)
+            return 0;
+        if (bitwidth <= 0 || bitwidth > HI_HLSLibMaxBitwidth)
+            return -1;
+        return bitwidth;
+    }
+
+    int getBlockIndex(int opcodeID, int oprand_bitwidth, int res_bitwidth) const;
+
+    // the position in bitwidthBlocks of the bitwidth slots
+    int getBlockPos(int opcodeID, int oprandSlot, int resSlot) const
+    {
+        return (opcodeID * bitwidthSlotNum + oprandSlot) * bitwidthSlotNum + resSlot;
+    }
+
+    // get the block of the bitwidth slots, a block of unavailable entries is created if necessary
+    int getOrCreateBlock(int opcodeID, int oprandSlot, int resSlot);
+
+    // the record index of the entry, -1 if unavailable
+    int32_t getEntry(int block, int clockID) const
+    {
+        return clockEntries[block * clocks.size() + clockID];
+    }
+
+    // infer the missing clock periods of the characterized bitwidths
+    void fillMissingClocks();
+
+    // infer the missing bitwidths between the characterized ones
+    void interpolateBitwidths();
+
+    const int bitwidthSlotNum = HI_HLSLibMaxBitwidth + 1;
+    int opcodeNum;
+    std::vector<std::string> opcodes;
+    std::vector<std::string> clocks;
+    llvm::StringMap<int> opcode2ID;
+
+    // the interned clock periods: string -> clock ID and clock ID -> value (NaN if malformed)
+    llvm::StringMap<int> clock2ID;
+    std::vector<float> clockValues;
+
+    // the owner of the records of the library, either the parsed text files or the mapping
+    std::vector<HI_HLSLibRecord> parsedRecords;
+    std::unique_ptr<HI_HLSLibBinary> binaryLib;
+
+    // the records of the library (indices [0, sourceNum)) and the clock ID of each of them
+    const HI_HLSLibRecord *sourceRecords = nullptr;
+    int32_t sourceNum = 0;
+    std::vector<int> sourceClockIDs;
+
+    // the inferred records (indices from sourceNum)
+    std::vector<HI_HLSLibRecord> inferredRecords;
+
+    // (opcode, operand bitwidth, result bitwidth) -> block of clock entries, -1 if unavailable
+    std::vector<int32_t> bitwidthBlocks;
+
+    // (block, clock) -> index in records, -1 if unavailable
+    std::vector<int32_t> clockEntries;
+};
+
+#endif
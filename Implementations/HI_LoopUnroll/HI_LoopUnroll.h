@@ -116,6 +116,20 @@ class HI_LoopUnroll : public LoopPass
                   Optional<unsigned> Count = None, Optional<bool> AllowPartial = None,
                   Optional<bool> Runtime = None, Optional<bool> UpperBound = None,
                   Optional<bool> AllowPeeling = None)
+        : HI_LoopUnroll("LoopUnrollLog", _IRLoop2LoopLabel, _LoopLabel2UnrollFactor, OptLevel,
+                        OnlyWhenForced, Threshold, Count, AllowPartial, Runtime, UpperBound,
+                        AllowPeeling)
+    {
+    }
+
+    // the log is written to the file LoopUnrollLog_Name, e.g. one log for each design point
+    HI_LoopUnroll(const char *LoopUnrollLog_Name,
+                  std::map<std::string, std::string> &_IRLoop2LoopLabel,
+                  std::map<std::string, int> &_LoopLabel2UnrollFactor, int OptLevel = 2,
+                  bool OnlyWhenForced = false, Optional<unsigned> Threshold = None,
+                  Optional<unsigned> Count = None, Optional<bool> AllowPartial = None,
+                  Optional<bool> Runtime = None, Optional<bool> UpperBound = None,
+                  Optional<bool> AllowPeeling = None)
         : LoopPass(ID), OptLevel(OptLevel), OnlyWhenForced(OnlyWhenForced),
           ProvidedCount(std::move(Count)), ProvidedThreshold(Threshold),
           ProvidedAllowPartial(AllowPartial), ProvidedRuntime(Runtime),
@@ -123,7 +137,7 @@ class HI_LoopUnroll : public LoopPass
           IRLoop2LoopLabel(_IRLoop2LoopLabel), LoopLabel2UnrollFactor(_LoopLabel2UnrollFactor)
     {
 
-        LoopUnrollLog = new raw_fd_ostream("LoopUnrollLog", ErrInfo, sys::fs::F_None);
+        LoopUnrollLog = new raw_fd_ostream(LoopUnrollLog_Name, ErrInfo, sys::fs::F_None);
     }
 
     ~HI_LoopUnroll()
@@ -324,6 +324,21 @@ class HI_DesignConfigInfo
             functionName, std::pair<std::string, bool>(arrayName, enable)));
     }
 
+    // the function is evaluated at the clock period of its clock domain instead of the design
+    // clock, e.g. clock_domain function=f period=5
+    void insertClockDomain(std::string functionName, std::string period_str)
+    {
+        for (auto &domain_pair : clockDomainConfigs)
+        {
+            if (domain_pair.first == functionName)
+            {
+                domain_pair.second = period_str;
+                return;
+            }
+        }
+        clockDomainConfigs.push_back(std::pair<std::string, std::string>(functionName, period_str));
+    }
+
     HI_DesignConfigInfo(const HI_DesignConfigInfo &input)
     {
         clock_period = input.clock_period;
@@ -337,7 +352,10 @@ class HI_DesignConfigInfo
         arrayPortConfigs = input.arrayPortConfigs;
         funcDataflowConfigs = input.funcDataflowConfigs;
         localArrayConfigs = input.localArrayConfigs;
+        clockDomainConfigs = input.clockDomainConfigs;
         HLS_lib_path = input.HLS_lib_path;
+        moduloScheduling = input.moduloScheduling;
+        DSPLimit = input.DSPLimit;
     }
 
     HI_DesignConfigInfo &operator=(const HI_DesignConfigInfo &input)
@@ -353,7 +371,10 @@ class HI_DesignConfigInfo
         arrayPortConfigs = input.arrayPortConfigs;
         funcDataflowConfigs = input.funcDataflowConfigs;
         localArrayConfigs = input.localArrayConfigs;
+        clockDomainConfigs = input.clockDomainConfigs;
         HLS_lib_path = input.HLS_lib_path;
+        moduloScheduling = input.moduloScheduling;
+        DSPLimit = input.DSPLimit;
     }
 
     double clock_period;
@@ -369,7 +390,15 @@ class HI_DesignConfigInfo
     std::vector<std::pair<std::string, std::pair<std::string, bool>>> localArrayConfigs;
     std::vector<std::pair<std::string, std::pair<std::string, int>>> arrayPortConfigs;
     std::vector<std::pair<std::string, bool>> funcDataflowConfigs;
+    std::vector<std::pair<std::string, std::string>> clockDomainConfigs;
     std::map<std::string, int> LoopLabel2UnrollFactor;
+
+    // evaluate the pipelined loops with the iterative modulo scheduler
+    // (loop_pipeline_scheduler = modulo), otherwise the II is estimated by the heuristic checks
+    bool moduloScheduling = false;
+
+    // the DSPs available to the modulo scheduler (resource_limit DSP=N), -1 if unlimited
+    int DSPLimit = -1;
 };
 
 #endif
@@ -383,16 +412,18 @@ class HI_MuxInsertionArrayPartition : public ModulePass
     HI_MuxInsertionArrayPartition(const char *config_file_name, const char *top_function,
                                   std::map<std::string, int> &FuncParamLine2OutermostSize,
                                   std::map<std::string, std::vector<int>> &IRFunc2BeginLine,
-                                  bool DEBUG = 0)
+                                  bool DEBUG = 0,
+                                  const char *BRAM_log_name =
+                                      "HI_MuxInsertionArrayPartition_BRAM_log",
+                                  const char *ArrayLog_name =
+                                      "HI_MuxInsertionArrayPartition_Array_Log")
         : ModulePass(ID), FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
           IRFunc2BeginLine(IRFunc2BeginLine), DEBUG(DEBUG)
     {
         config_file = new std::ifstream(config_file_name);
-        BRAM_log =
-            new raw_fd_ostream("HI_MuxInsertionArrayPartition_BRAM_log", ErrInfo, sys::fs::F_None);
+        BRAM_log = new raw_fd_ostream(BRAM_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        ArrayLog =
-            new raw_fd_ostream("HI_MuxInsertionArrayPartition_Array_Log", ErrInfo, sys::fs::F_None);
+        ArrayLog = new raw_fd_ostream(ArrayLog_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         Parse_Config();
     }
@@ -400,16 +431,18 @@ class HI_MuxInsertionArrayPartition : public ModulePass
     HI_MuxInsertionArrayPartition(const HI_DesignConfigInfo &configInfo, const char *top_function,
                                   std::map<std::string, int> &FuncParamLine2OutermostSize,
                                   std::map<std::string, std::vector<int>> &IRFunc2BeginLine,
-                                  bool DEBUG = 0)
+                                  bool DEBUG = 0,
+                                  const char *BRAM_log_name =
+                                      "HI_MuxInsertionArrayPartition_BRAM_log",
+                                  const char *ArrayLog_name =
+                                      "HI_MuxInsertionArrayPartition_Array_Log")
         : ModulePass(ID), FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
           IRFunc2BeginLine(IRFunc2BeginLine), DEBUG(DEBUG)
     {
         //  config_file = new std::ifstream(config_file_name);
-        BRAM_log =
-            new raw_fd_ostream("HI_MuxInsertionArrayPartition_BRAM_log", ErrInfo, sys::fs::F_None);
+        BRAM_log = new raw_fd_ostream(BRAM_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        ArrayLog =
-            new raw_fd_ostream("HI_MuxInsertionArrayPartition_Array_Log", ErrInfo, sys::fs::F_None);
+        ArrayLog = new raw_fd_ostream(ArrayLog_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         Parse_Config(configInfo);
     }
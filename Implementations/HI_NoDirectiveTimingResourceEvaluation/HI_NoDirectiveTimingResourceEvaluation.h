@@ -15,6 +15,7 @@
 #define Strict_CertaintyRatio (7.0 / 8.0)
 
 #include "ClockInfo.h"
+#include "HI_HLSLibrary.h"
 #include "HI_InstructionFiles.h"
 #include "HI_StringProcess.h"
 #include "HI_print.h"
@@ -652,13 +653,13 @@ class HI_NoDirectiveTimingResourceEvaluation : public ModulePass
         return stream;
     }
 
-    // For each type of instruction, there will be a list to store a series of information
-    // corresponding to different parameters
-    typedef std::map<int, std::map<int, std::map<std::string, inst_timing_resource_info>>>
-        Info_type_list;
+    // The table of timing and resource information indexed by opcode, bitwidths and clock period
+    std::unique_ptr<HI_HLSLibTable> HLSLibTable;
 
-    // A map from opcode to the information list of timing and resource
-    std::map<std::string, Info_type_list> BiOp_Info_name2list_map;
+    // get the record of a specific instruction, based on its opcode, operand_bitwidth,
+    // result_bitwidth and clock period
+    const HI_HLSLibRecord &getInstRecord(llvm::StringRef opcode, int operand_bitwid,
+                                         int res_bitwidth, llvm::StringRef period);
 
     // get the information of a specific instruction, based on its opcode, operand_bitwidth,
     // result_bitwidth and clock period
@@ -697,19 +698,10 @@ class HI_NoDirectiveTimingResourceEvaluation : public ModulePass
     resourceBase IndexVar_LUT(std::map<Instruction *, timingBase> &cur_InstructionCriticalPath,
                               Instruction *I);
 
-    // check whether a specific information is in the database
+    // check whether a specific information is characterized in the database
     bool checkInfoAvailability(std::string opcode, int operand_bitwid, int res_bitwidth,
                                std::string period);
 
-    // check whether we can infer the information by increasing the clock frequency
-    bool checkFreqProblem(std::string opcode, int operand_bitwid, int res_bitwidth,
-                          std::string period);
-
-    // if the information is not found in database, we may infer the information by increasing the
-    // clock frequency
-    inst_timing_resource_info checkInfo_HigherFreq(std::string opcode, int operand_bitwid,
-                                                   int res_bitwidth, std::string period);
-
     // Trace back to get the bitwidth of an operand, bypassing truct/zext/sext
     int getOriginalBitwidth(Value *Val);
 
@@ -133,7 +133,9 @@ class HI_PragmaTargetExtraction : public ModulePass
         const char *top_function, std::map<std::string, std::string> &IRLoop2LoopLabel,
         // std::map<std::string, int> &LoopLabel2II,
         std::map<std::string, int> &FuncParamLine2OutermostSize,
-        std::map<std::string, std::vector<int>> &IRFunc2BeginLine, bool DEBUG = 0)
+        std::map<std::string, std::vector<int>> &IRFunc2BeginLine, bool DEBUG = 0,
+        const char *loopTarget_log_name = "HI_PragmaTargetExtraction_loopTarget_log",
+        const char *arrayTarget_Log_name = "HI_PragmaTargetExtraction_arrayTarget_Log")
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
           IRFunc2BeginLine(IRFunc2BeginLine), DEBUG(DEBUG),
@@ -143,11 +145,9 @@ class HI_PragmaTargetExtraction : public ModulePass
 
     {
         // config_file = new std::ifstream(config_file_name);
-        loopTarget_log = new raw_fd_ostream("HI_PragmaTargetExtraction_loopTarget_log", ErrInfo,
-                                            sys::fs::F_None);
+        loopTarget_log = new raw_fd_ostream(loopTarget_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        arrayTarget_Log = new raw_fd_ostream("HI_PragmaTargetExtraction_arrayTarget_Log", ErrInfo,
-                                             sys::fs::F_None);
+        arrayTarget_Log = new raw_fd_ostream(arrayTarget_Log_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         // Generate_Config();
     }
@@ -163,7 +163,9 @@ class HI_PragmaTargetExtraction : public ModulePass
         std::map<std::string, int> &LoopIRName2Depth,
         std::map<std::string, std::vector<std::pair<std::string, std::string>>> &LoopIRName2Array,
         std::map<std::pair<std::string, std::string>, HI_PragmaArrayInfo> &TargetExtName2ArrayInfo,
-        bool DEBUG = 0)
+        bool DEBUG = 0,
+        const char *loopTarget_log_name = "HI_PragmaTargetExtraction_loopTarget_log",
+        const char *arrayTarget_Log_name = "HI_PragmaTargetExtraction_arrayTarget_Log")
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
           IRFunc2BeginLine(IRFunc2BeginLine), DEBUG(DEBUG),
@@ -173,11 +175,9 @@ class HI_PragmaTargetExtraction : public ModulePass
 
     {
         // config_file = new std::ifstream(config_file_name);
-        loopTarget_log = new raw_fd_ostream("HI_PragmaTargetExtraction_loopTarget_log", ErrInfo,
-                                            sys::fs::F_None);
+        loopTarget_log = new raw_fd_ostream(loopTarget_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        arrayTarget_Log = new raw_fd_ostream("HI_PragmaTargetExtraction_arrayTarget_Log", ErrInfo,
-                                             sys::fs::F_None);
+        arrayTarget_Log = new raw_fd_ostream(arrayTarget_Log_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         // Generate_Config();
     }
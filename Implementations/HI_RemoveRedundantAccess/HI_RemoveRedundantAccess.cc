@@ -21,8 +21,8 @@ bool HI_RemoveRedundantAccess::runOnModule(
                // be executed for each Module.
 {
     print_status("Running HI_RemoveRedundantAccess pass.");
-    noAliasHazard_cache.clear();
-    checkMustAlias_cache.clear();
+    gettimeofday(&tv_begin, NULL);
+    removedLoadNum = removedStoreNum = 0;
     bool changed = false;
     ValueVisited.clear();
     Alias2Target.clear();
@@ -75,14 +75,29 @@ bool HI_RemoveRedundantAccess::runOnModule(
                 *RemoveRedundantAccess_Log
                     << "\n\n\n================================\nbefore FUNCTION:\n " << F << "\n";
 
-            ActionTaken = checkAndRemoveRedundantLoadin(F);
+            if (singleSweep)
+                ActionTaken = sweepAndRemoveRedundantLoadin(F);
+            else
+                ActionTaken = checkAndRemoveRedundantLoadin(F);
             changed |= ActionTaken;
 
-            ActionTaken |= checkAndRemoveRedundantStorein(F);
+            if (singleSweep)
+                ActionTaken |= sweepAndRemoveRedundantStorein(F);
+            else
+                ActionTaken |= checkAndRemoveRedundantStorein(F);
             changed |= ActionTaken;
         }
     }
 
+    gettimeofday(&tv_end, NULL);
+    print_status("done HI_RemoveRedundantAccess (" +
+                 std::string(singleSweep ? "single-sweep" : "restart") + "): removed " +
+                 std::to_string(removedLoadNum) + " loads and " + std::to_string(removedStoreNum) +
+                 " stores in " +
+                 std::to_string((double)(tv_end.tv_sec - tv_begin.tv_sec) +
+                                (double)(tv_end.tv_usec - tv_begin.tv_usec) / 1000000.0) +
+                 " s");
+
     // return false;
     return changed;
 }
@@ -104,10 +119,6 @@ void HI_RemoveRedundantAccess::getAnalysisUsage(AnalysisUsage &AU) const
 // check whether the two instructions are MUST-alias instructions
 bool HI_RemoveRedundantAccess::checkMustAlias(Instruction *I0, Instruction *I1)
 {
-    std::pair<Instruction *, Instruction *> I_pair(I0, I1);
-    if (checkMustAlias_cache.find(I_pair) != checkMustAlias_cache.end())
-        return checkMustAlias_cache[I_pair];
-
     Instruction *pointer_I0 = nullptr, *pointer_I1 = nullptr;
     if (I0->getOpcode() == Instruction::Load)
     {
@@ -148,7 +159,6 @@ bool HI_RemoveRedundantAccess::checkMustAlias(Instruction *I0, Instruction *I1)
 
     if (!tmp_S0 || !tmp_S1)
     {
-        checkMustAlias_cache[I_pair] = false;
         return false;
     }
 
@@ -158,13 +168,10 @@ bool HI_RemoveRedundantAccess::checkMustAlias(Instruction *I0, Instruction *I1)
     {
         if (res.getValue().getSExtValue() == 0)
         {
-            checkMustAlias_cache[I_pair] = true;
             return true;
         }
-        checkMustAlias_cache[I_pair] = false;
         return false;
     }
-    checkMustAlias_cache[I_pair] = false;
     return false;
 }
 
@@ -172,10 +179,6 @@ bool HI_RemoveRedundantAccess::checkMustAlias(Instruction *I0, Instruction *I1)
 // true if it is not possible, false if it is possible
 bool HI_RemoveRedundantAccess::noAliasHazard(Instruction *I0, Instruction *I1)
 {
-    std::pair<Instruction *, Instruction *> I_pair(I0, I1);
-    if (noAliasHazard_cache.find(I_pair) != noAliasHazard_cache.end())
-        return noAliasHazard_cache[I_pair];
-
     Instruction *pointer_I0 = nullptr, *pointer_I1 = nullptr;
     if (I0->getOpcode() == Instruction::Load)
     {
@@ -224,14 +227,11 @@ bool HI_RemoveRedundantAccess::noAliasHazard(Instruction *I0, Instruction *I1)
         if (res.getValue().getSExtValue() == 0)
         {
             // if (DEBUG) *RemoveRedundantAccess_Log << "    which means must alias\n";
-            noAliasHazard_cache[I_pair] = false;
             return false;
         }
         // if (DEBUG) *RemoveRedundantAccess_Log << "    which means must no-alias\n";
-        noAliasHazard_cache[I_pair] = true;
         return true;
     }
-    noAliasHazard_cache[I_pair] = false;
     return false;
 }
 
@@ -387,6 +387,7 @@ bool HI_RemoveRedundantAccess::checkAndRemoveRedundantLoadin(Function &F)
                                                     << "\n";
                                             nextI->replaceAllUsesWith(I);
                                             nextI->eraseFromParent();
+                                            removedLoadNum++;
                                             lastI = I;
                                             ActionTaken = true;
                                             changed = true;
@@ -430,6 +431,7 @@ bool HI_RemoveRedundantAccess::checkAndRemoveRedundantLoadin(Function &F)
                                                     << "\n";
                                             lastI = I;
                                             forwardAndRemove(I->getOperand(0), nextI);
+                                            removedLoadNum++;
                                             ActionTaken = true;
                                             changed = true;
                                             break;
@@ -549,6 +551,7 @@ bool HI_RemoveRedundantAccess::checkAndRemoveRedundantStorein(Function &F)
                                             *RemoveRedundantAccess_Log
                                                 << "----- remove redundant store" << *I << "\n";
                                         I->eraseFromParent();
+                                        removedStoreNum++;
                                         ActionTaken = true;
                                         changed = true;
 
@@ -593,6 +596,152 @@ bool HI_RemoveRedundantAccess::checkAndRemoveRedundantStorein(Function &F)
     return changed;
 }
 
+/*
+    forward the stored/loaded data to the redundant loads in the function with one walk of each
+    block, which removes the same loads as checkAndRemoveRedundantLoadin without restarting the
+    search after each removal. For each target, the walk records the value available at each
+    address (IntToPtr):
+    (1) a load reading an address with an available value is replaced by the value (RAR/RAW),
+        otherwise the loaded data becomes available at the address;
+    (2) a store makes its data available at its address. It hides the data of all the earlier
+        stores to the target, and the loaded data at the addresses it might alias.
+*/
+bool HI_RemoveRedundantAccess::sweepAndRemoveRedundantLoadin(Function &F)
+{
+    if (DEBUG)
+        *RemoveRedundantAccess_Log << "\n\nsweepAndRemoveRedundantLoadin:\n";
+    bool changed = false;
+    for (auto &B : F)
+    {
+        std::vector<Instruction *> accesses;
+        for (auto &I : B)
+            if (I.getOpcode() == Instruction::Load || I.getOpcode() == Instruction::Store)
+                accesses.push_back(&I);
+
+        // target -> (address -> the available data)
+        DenseMap<Value *, DenseMap<Instruction *, Value *>> target2LoadedData;
+        DenseMap<Value *, DenseMap<Instruction *, Value *>> target2StoredData;
+
+        for (auto I : accesses)
+        {
+            Value *target = getTargetFromInst(I);
+            Instruction *address = getAccessAddress(I);
+            auto &loadedData = target2LoadedData[target];
+            auto &storedData = target2StoredData[target];
+
+            if (I->getOpcode() == Instruction::Load)
+            {
+                Value *availableData = nullptr;
+                auto stored_it = storedData.find(address);
+                auto loaded_it = loadedData.find(address);
+                if (stored_it != storedData.end())
+                    availableData = stored_it->second;
+                else if (loaded_it != loadedData.end())
+                    availableData = loaded_it->second;
+
+                if (!availableData)
+                {
+                    loadedData[address] = I;
+                    continue;
+                }
+                if (DEBUG)
+                    *RemoveRedundantAccess_Log
+                        << "----- remove " << (stored_it != storedData.end() ? "RAW" : "RAR")
+                        << " redundant load" << *I << "--with--" << *availableData << "\n";
+                // the dead address calculation is removed after the walk, so the recorded
+                // data are not erased during the walk
+                I->replaceAllUsesWith(availableData);
+                I->eraseFromParent();
+                removedLoadNum++;
+                changed = true;
+            }
+            else
+            {
+                // an access without IntToPtr might alias any address of the target
+                if (!address)
+                    loadedData.clear();
+                else
+                {
+                    loadedData.erase(address);
+                    loadedData.erase(nullptr);
+                }
+                storedData.clear();
+                storedData[address] = I->getOperand(0);
+            }
+        }
+    }
+    if (changed)
+        removeDeadInstructionsin(F);
+    return changed;
+}
+
+/*
+    remove the stores overwritten before being loaded in the function with one backward walk of
+    each block, which removes the same stores as checkAndRemoveRedundantStorein. For each target,
+    the walk records the addresses written since the latest load of the target, and a store to a
+    recorded address is redundant.
+*/
+bool HI_RemoveRedundantAccess::sweepAndRemoveRedundantStorein(Function &F)
+{
+    if (DEBUG)
+        *RemoveRedundantAccess_Log << "\n\nsweepAndRemoveRedundantStorein:\n";
+    bool changed = false;
+    for (auto &B : F)
+    {
+        std::vector<Instruction *> accesses;
+        for (auto &I : B)
+            if (I.getOpcode() == Instruction::Load || I.getOpcode() == Instruction::Store)
+                accesses.push_back(&I);
+
+        // target -> the addresses written later without load in between
+        DenseMap<Value *, SmallPtrSet<Instruction *, 8>> target2OverwrittenAddresses;
+
+        for (auto it = accesses.rbegin(), ie = accesses.rend(); it != ie; ++it)
+        {
+            Instruction *I = *it;
+            auto &overwrittenAddresses = target2OverwrittenAddresses[getTargetFromInst(I)];
+            if (I->getOpcode() == Instruction::Load)
+            {
+                overwrittenAddresses.clear();
+                continue;
+            }
+            if (overwrittenAddresses.insert(getAccessAddress(I)).second)
+                continue;
+            if (DEBUG)
+                *RemoveRedundantAccess_Log << "----- remove redundant store" << *I << "\n";
+            I->eraseFromParent();
+            removedStoreNum++;
+            changed = true;
+        }
+    }
+    if (changed)
+        removeDeadInstructionsin(F);
+    return changed;
+}
+
+// get the address of the access, i.e. its IntToPtr instruction, which is the same for the
+// MUST-alias accesses (nullptr if the pointer is not generated by IntToPtr)
+Instruction *HI_RemoveRedundantAccess::getAccessAddress(Instruction *accessI)
+{
+    if (accessI->getOpcode() == Instruction::Load)
+        return dyn_cast<IntToPtrInst>(accessI->getOperand(0));
+    return dyn_cast<IntToPtrInst>(accessI->getOperand(1));
+}
+
+// remove the trivially dead instructions in the function, e.g. the address calculation of the
+// removed accesses
+void HI_RemoveRedundantAccess::removeDeadInstructionsin(Function &F)
+{
+    SmallVector<WeakTrackingVH, 16> deadInsts;
+    for (auto &I : instructions(F))
+        if (isInstructionTriviallyDead(&I))
+            deadInsts.push_back(&I);
+    // an instruction might be removed with the users of its result, so it is tracked by handle
+    for (auto &deadI : deadInsts)
+        if (auto I = dyn_cast_or_null<Instruction>(deadI))
+            RecursivelyDeleteTriviallyDeadInstructions(I);
+}
+
 // find the declaration in the function
 // and trace the access to it
 void HI_RemoveRedundantAccess::findMemoryDeclarationin(Function *F, bool isTopFunction)
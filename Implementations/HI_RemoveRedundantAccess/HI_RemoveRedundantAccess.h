@@ -210,8 +210,8 @@ class HI_RemoveRedundantAccess : public ModulePass
 {
   public:
     HI_RemoveRedundantAccess(const char *RemoveRedundantLoad_Log_Name, std::string tp_name,
-                             bool DEBUG = false)
-        : ModulePass(ID), DEBUG(DEBUG)
+                             bool DEBUG = false, bool singleSweep = true)
+        : ModulePass(ID), DEBUG(DEBUG), singleSweep(singleSweep)
     {
         Instruction_Counter = 0;
         Function_Counter = 0;
@@ -246,6 +246,12 @@ class HI_RemoveRedundantAccess : public ModulePass
 
     bool DEBUG = false;
 
+    // remove the redundant accesses with one walk of each block (sweepAndRemoveRedundantLoadin/
+    // sweepAndRemoveRedundantStorein), otherwise the search restarts from the beginning of the
+    // function after each removal (checkAndRemoveRedundantLoadin/checkAndRemoveRedundantStorein).
+    // Both remove the same accesses and the latter is kept as the reference.
+    bool singleSweep = true;
+
     void getAnalysisUsage(AnalysisUsage &AU) const;
     bool runOnModule(llvm::Module &M);
     static char ID;
@@ -275,6 +281,23 @@ class HI_RemoveRedundantAccess : public ModulePass
     // be redundant.)
     bool checkAndRemoveRedundantStorein(Function &F);
 
+    // forward the stored/loaded data to the redundant loads in the function with one walk of
+    // each block, where the latest value available at each address of each target is recorded
+    bool sweepAndRemoveRedundantLoadin(Function &F);
+
+    // remove the stores overwritten before being loaded in the function with one backward walk
+    // of each block, where the addresses written since the latest load of each target are
+    // recorded
+    bool sweepAndRemoveRedundantStorein(Function &F);
+
+    // get the address of the access, i.e. its IntToPtr instruction, which is the same for the
+    // MUST-alias accesses (nullptr if the pointer is not generated by IntToPtr)
+    Instruction *getAccessAddress(Instruction *accessI);
+
+    // remove the trivially dead instructions in the function, e.g. the address calculation of
+    // the removed accesses
+    void removeDeadInstructionsin(Function &F);
+
     // find the declaration in the function
     // and trace the access to it
     void findMemoryDeclarationin(Function *F, bool isTopFunction);
@@ -299,6 +322,8 @@ class HI_RemoveRedundantAccess : public ModulePass
     std::map<std::pair<const SCEV *, const SCEV *>, Optional<APInt>> differentCache;
 
     int callCounter;
+    int removedLoadNum = 0;
+    int removedStoreNum = 0;
     int Instruction_Counter;
     int Function_Counter;
     int BasicBlock_Counter;
@@ -322,8 +347,6 @@ class HI_RemoveRedundantAccess : public ModulePass
     std::set<std::pair<Instruction *, Instruction *>> accessAliasSet;
     std::set<Instruction *> AliasedAccess;
     std::vector<Instruction *> accessInsts;
-    std::map<std::pair<Instruction *, Instruction *>, bool> noAliasHazard_cache;
-    std::map<std::pair<Instruction *, Instruction *>, bool> checkMustAlias_cache;
     std::map<Instruction *, Value *> getTargetFromInst_cache;
 
     std::map<std::pair<Instruction *, Instruction *>, bool> SameTargetPair;
@@ -24,9 +24,30 @@ using namespace llvm;
    itself is actually updated with the same bitwidth with the truncation. 4.Validation Check: Check
    whether there is any binary operation with operands in different types.
 */
-bool HI_VarWidthReduce::runOnFunction(
-    Function &F) // The runOnModule declaration will overide the virtual one in ModulePass, which
-                 // will be executed for each Module.
+bool HI_VarWidthReduce::runOnModule(
+    Module &M) // The runOnModule declaration will overide the virtual one in ModulePass, which
+               // will be executed for each Module.
+{
+    // The ranges flow across the functions, so they are analyzed for the whole module before any
+    // function is changed. This has to be done here rather than in doInitialization, since all
+    // the doInitialization are called before any pass runs, and the passes before this one (e.g.
+    // LoopSimplify and IndVarSimplify) would change the module after the analysis. As a
+    // ModulePass, this pass runs after the previous passes have processed all the functions.
+    Range_Analysis(M);
+
+    bool changed = 0;
+    for (Function &F : M)
+    {
+        if (F.isDeclaration())
+            continue;
+        changed |= runOnFunction(F);
+    }
+    Value2FixpointRange.clear();
+    Function2ReturnRange.clear();
+    return changed;
+}
+
+bool HI_VarWidthReduce::runOnFunction(Function &F)
 {
     print_status("Running HI_VarWidthReduce pass.");
     SignedRanges.clear();
@@ -44,7 +65,7 @@ bool HI_VarWidthReduce::runOnFunction(
     }
 
     const DataLayout &DL = F.getParent()->getDataLayout();
-    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>(F).getSE();
 
     if (Function_id.find(&F) == Function_id.end()) // traverse functions and assign function ID
     {
@@ -53,9 +74,15 @@ bool HI_VarWidthReduce::runOnFunction(
     bool changed = 0;
 
     // 1.Analysis: check the value range of the instructions in the source code and determine the
-    // bitwidth
+    // bitwidth, where the SCEV ranges are narrowed with the ranges from the fixpoint analysis
+    // (Range_Analysis) done for the whole module before any function is changed
     Bitwidth_Analysis(&F);
 
+    // the instructions might be erased below
+    for (BasicBlock &B : F)
+        for (Instruction &I : B)
+            Value2FixpointRange.erase(&I);
+
     // 2.Forward Process: check the bitwidth of operands and output of an instruction, trunc/ext the
     // operands, update the bitwidth of the instruction
     changed |= InsturctionUpdate_WidthCast(&F);
@@ -95,7 +122,7 @@ void HI_VarWidthReduce::getAnalysisUsage(AnalysisUsage &AU) const
 void HI_VarWidthReduce::Bitwidth_Analysis(Function *F)
 {
     const DataLayout &DL = F->getParent()->getDataLayout();
-    SE = &getAnalysis<ScalarEvolutionWrapperPass>().getSE();
+    SE = &getAnalysis<ScalarEvolutionWrapperPass>(*F).getSE();
     for (BasicBlock &B : *F)
     {
         for (Instruction &I : B)
@@ -133,6 +160,7 @@ void HI_VarWidthReduce::Bitwidth_Analysis(Function *F)
                             ? ConstantRange(APInt(HI_getUnsignedRangeRef(tmp_S).getBitWidth(), 0),
                                             HI_getUnsignedRangeRef(tmp_S).getUpper())
                             : HI_getSignedRangeRef(tmp_S);
+                    tmp_CR2 = refineRange(&I, tmp_CR2, isUnsignedInst);
 
                     I2NeedSign[&I] = !isUnsignedInst && tmp_CR2.getLower().isNegative();
 
@@ -180,6 +208,298 @@ void HI_VarWidthReduce::Bitwidth_Analysis(Function *F)
     }
 }
 
+// Range Analysis: propagate the value ranges of the integer values in the module with a worklist
+// until a fixpoint is reached (like IPSCCP). Each value starts with an empty range and its range
+// only grows. The ranges of the PHI nodes, the arguments and the returned values are widened to
+// power-of-two bounds, so each value is updated at most a few times per bit and the analysis is
+// linear in the size of the module.
+void HI_VarWidthReduce::Range_Analysis(Module &M)
+{
+    Value2FixpointRange.clear();
+    Function2ReturnRange.clear();
+    std::vector<Instruction *> Worklist;
+    DenseSet<Instruction *> InWorklist;
+
+    // the calls and the returns carry the ranges across the functions
+    auto pushUsers = [&](Value *V) {
+        for (User *U : V->users())
+        {
+            Instruction *User_I = dyn_cast<Instruction>(U);
+            if (!User_I || !(Value2FixpointRange.count(User_I) || isa<CallInst>(User_I) ||
+                             isa<ReturnInst>(User_I)))
+                continue;
+            if (InWorklist.insert(User_I).second)
+                Worklist.push_back(User_I);
+        }
+    };
+
+    for (Function &F : M)
+    {
+        if (F.isDeclaration())
+            continue;
+        if (F.getReturnType()->isIntegerTy())
+            Function2ReturnRange.try_emplace(
+                &F, ConstantRange(F.getReturnType()->getIntegerBitWidth(), /*isFullSet=*/false));
+        if (hasKnownCallers(&F))
+        {
+            for (Argument &Arg : F.args())
+                if (Arg.getType()->isIntegerTy())
+                    Value2FixpointRange.insert(std::make_pair(
+                        &Arg,
+                        ConstantRange(Arg.getType()->getIntegerBitWidth(), /*isFullSet=*/false)));
+        }
+        for (BasicBlock &B : F)
+        {
+            for (Instruction &I : B)
+            {
+                if (I.getType()->isIntegerTy())
+                    Value2FixpointRange.insert(std::make_pair(
+                        &I, ConstantRange(I.getType()->getIntegerBitWidth(), /*isFullSet=*/false)));
+                else if (!isa<CallInst>(I) && !isa<ReturnInst>(I))
+                    continue;
+                Worklist.push_back(&I);
+                InWorklist.insert(&I);
+            }
+        }
+    }
+    // process the instructions in program order first
+    std::reverse(Worklist.begin(), Worklist.end());
+
+    int updateNum = 0;
+    while (!Worklist.empty())
+    {
+        Instruction *I = Worklist.back();
+        Worklist.pop_back();
+        InWorklist.erase(I);
+
+        if (ReturnInst *Ret_I = dyn_cast<ReturnInst>(I))
+        {
+            // the range of the return value of the function covers all the returned values
+            Function *F = Ret_I->getFunction();
+            auto F_it = Function2ReturnRange.find(F);
+            if (F_it == Function2ReturnRange.end() || !Ret_I->getReturnValue())
+                continue;
+            if (!mergeRange(F_it->second, getLatticeRange(Ret_I->getReturnValue()), true))
+                continue;
+            updateNum++;
+            pushUsers(F);
+            continue;
+        }
+
+        if (CallInst *Call_I = dyn_cast<CallInst>(I))
+        {
+            // the range of an argument covers the actual arguments at all the call sites
+            Function *calledF = Call_I->getCalledFunction();
+            if (calledF && !calledF->isDeclaration())
+            {
+                for (Argument &Arg : calledF->args())
+                {
+                    auto Arg_it = Value2FixpointRange.find(&Arg);
+                    if (Arg_it == Value2FixpointRange.end())
+                        continue;
+                    if (!mergeRange(Arg_it->second,
+                                    getLatticeRange(Call_I->getArgOperand(Arg.getArgNo())), true))
+                        continue;
+                    updateNum++;
+                    pushUsers(&Arg);
+                }
+            }
+            if (!Call_I->getType()->isIntegerTy())
+                continue;
+        }
+
+        if (!mergeRange(Value2FixpointRange.find(I)->second, evaluateRange(I), isa<PHINode>(I)))
+            continue;
+        updateNum++;
+        pushUsers(I);
+    }
+
+    if (DEBUG)
+    {
+        *VarWidthChangeLog << "fixpoint range analysis: " << Value2FixpointRange.size()
+                           << " values, " << updateNum << " updates\n";
+        for (Function &F : M)
+        {
+            if (F.isDeclaration())
+                continue;
+            *VarWidthChangeLog << "  function: [" << F.getName() << "]";
+            if (Function2ReturnRange.count(&F))
+                *VarWidthChangeLog << " return FP-CR: " << Function2ReturnRange.find(&F)->second;
+            *VarWidthChangeLog << "\n";
+            for (Argument &Arg : F.args())
+                if (Value2FixpointRange.count(&Arg))
+                    *VarWidthChangeLog << "    " << Arg << " ---- FP-CR: " << getFixpointRange(&Arg)
+                                       << "\n";
+            for (BasicBlock &B : F)
+                for (Instruction &I : B)
+                    if (Value2FixpointRange.count(&I))
+                        *VarWidthChangeLog << "    " << I << " ---- FP-CR: " << getFixpointRange(&I)
+                                           << "\n";
+        }
+        VarWidthChangeLog->flush();
+    }
+}
+
+bool HI_VarWidthReduce::hasKnownCallers(Function *F)
+{
+    // the definition might be replaced at link time otherwise
+    if (F->use_empty() || !F->hasExactDefinition())
+        return false;
+    for (Use &U : F->uses())
+    {
+        CallInst *Call_I = dyn_cast<CallInst>(U.getUser());
+        if (!Call_I || !Call_I->isCallee(&U))
+            return false;
+    }
+    return true;
+}
+
+// the range of the instruction computed from the current ranges of its operands. The operands
+// which are not evaluated yet (empty ranges) contribute nothing, like the optimistic assumption
+// in SCCP.
+ConstantRange HI_VarWidthReduce::evaluateRange(Instruction *I)
+{
+    unsigned BitWidth = I->getType()->getIntegerBitWidth();
+    ConstantRange emptyCR(BitWidth, /*isFullSet=*/false);
+    ConstantRange fullCR(BitWidth, /*isFullSet=*/true);
+
+    // the result of a call is the value returned by the sub-function
+    if (CallInst *Call_I = dyn_cast<CallInst>(I))
+    {
+        Function *calledF = Call_I->getCalledFunction();
+        if (calledF && Function2ReturnRange.count(calledF))
+            return Function2ReturnRange.find(calledF)->second;
+        return fullCR;
+    }
+
+    // the bitwidth of a load should be the bitwidth of memory
+    if (I->mayReadFromMemory())
+        return fullCR;
+
+    if (PHINode *PHI_I = dyn_cast<PHINode>(I))
+    {
+        ConstantRange resCR = emptyCR;
+        for (Value *V : PHI_I->incoming_values())
+            resCR = resCR.unionWith(getLatticeRange(V), ConstantRange::Signed);
+        return resCR;
+    }
+
+    if (SelectInst *Select_I = dyn_cast<SelectInst>(I))
+    {
+        return getLatticeRange(Select_I->getTrueValue())
+            .unionWith(getLatticeRange(Select_I->getFalseValue()), ConstantRange::Signed);
+    }
+
+    if (BinaryOperator *BOI = dyn_cast<BinaryOperator>(I))
+    {
+        ConstantRange LHS = getLatticeRange(BOI->getOperand(0));
+        ConstantRange RHS = getLatticeRange(BOI->getOperand(1));
+        if (LHS.isEmptySet() || RHS.isEmptySet())
+            return emptyCR;
+        return LHS.binaryOp(BOI->getOpcode(), RHS);
+    }
+
+    if (CastInst *CastI = dyn_cast<CastInst>(I))
+    {
+        // the PtrToInt Instruction is the address of an array, which is bypassed as in the SCEV
+        // ranges
+        if (!CastI->getSrcTy()->isIntegerTy())
+            return fullCR;
+        ConstantRange srcCR = getLatticeRange(CastI->getOperand(0));
+        if (srcCR.isEmptySet())
+            return emptyCR;
+        return srcCR.castOp(CastI->getOpcode(), BitWidth);
+    }
+
+    // e.g. comparisons
+    return fullCR;
+}
+
+ConstantRange HI_VarWidthReduce::getLatticeRange(Value *V)
+{
+    if (ConstantInt *C_I = dyn_cast<ConstantInt>(V))
+        return ConstantRange(C_I->getValue());
+    auto it = Value2FixpointRange.find(V);
+    if (it != Value2FixpointRange.end())
+        return it->second;
+    // e.g. the arguments of the top function
+    return ConstantRange(V->getType()->getIntegerBitWidth(), /*isFullSet=*/true);
+}
+
+ConstantRange HI_VarWidthReduce::getFixpointRange(Value *V)
+{
+    ConstantRange CR = getLatticeRange(V);
+    // the values never evaluated (e.g. unreachable ones) are taken as full sets
+    if (CR.isEmptySet())
+        return ConstantRange(CR.getBitWidth(), /*isFullSet=*/true);
+    return CR;
+}
+
+bool HI_VarWidthReduce::mergeRange(ConstantRange &curCR, ConstantRange CR, bool widen)
+{
+    ConstantRange newCR = curCR.unionWith(CR, ConstantRange::Signed);
+    if (widen)
+        newCR = widenRange(newCR);
+    if (newCR == curCR)
+        return false;
+    curCR = newCR;
+    return true;
+}
+
+// widen the range to [0, 2^k) if it is non-negative or to [-2^(k-1), 2^(k-1)) otherwise, where k is
+// the minimum bitwidth to hold the range
+ConstantRange HI_VarWidthReduce::widenRange(ConstantRange CR)
+{
+    if (CR.isEmptySet() || CR.isFullSet())
+        return CR;
+    unsigned BitWidth = CR.getBitWidth();
+    APInt lower = CR.getSignedMin();
+    APInt upper = CR.getSignedMax();
+    if (lower.isNonNegative())
+    {
+        unsigned k = upper.getActiveBits();
+        return ConstantRange(APInt(BitWidth, 0), APInt::getOneBitSet(BitWidth, k));
+    }
+    unsigned k = std::max(lower.getMinSignedBits(), upper.getMinSignedBits());
+    if (k >= BitWidth)
+        return ConstantRange(BitWidth, /*isFullSet=*/true);
+    return ConstantRange(APInt::getSignedMinValue(k).sext(BitWidth),
+                         APInt::getSignedMaxValue(k).sext(BitWidth) + 1);
+}
+
+// narrow the HI range of the value with its range from the fixpoint analysis. Both of them hold the
+// value, so does their intersection.
+ConstantRange HI_VarWidthReduce::refineRange(Value *V, ConstantRange CR, bool isUnsigned)
+{
+    if (!V->getType()->isIntegerTy())
+        return CR;
+    ConstantRange fixpointCR = getFixpointRange(V);
+    if (fixpointCR.isFullSet() || fixpointCR.getBitWidth() != CR.getBitWidth())
+        return CR;
+    ConstantRange resCR =
+        CR.intersectWith(fixpointCR, isUnsigned ? ConstantRange::Unsigned : ConstantRange::Signed);
+    if (resCR.isEmptySet())
+        return CR;
+    return resCR;
+}
+
+// whether the value might be negative, so it should be sign-extended when it is widened. The
+// values are narrowed to their active bits if they are non-negative, e.g. the ones derived from the
+// arguments narrowed by the ranges from the call sites, and sign-extending them would take their
+// top bits as the sign bits.
+bool HI_VarWidthReduce::mightBeNegative(Value *V)
+{
+    if (Argument *Arg = dyn_cast<Argument>(V))
+        return getFixpointRange(Arg).getSignedMin().isNegative();
+    if (Instruction *I = dyn_cast<Instruction>(V))
+    {
+        auto it = I2NeedSign.find(I);
+        if (it != I2NeedSign.end())
+            return it->second;
+    }
+    return true;
+}
+
 unsigned int HI_VarWidthReduce::HI_getBidwith(Value *I)
 {
     if (I->getType()->isIntOrPtrTy() || I->getType()->isIntegerTy() ||
@@ -198,6 +518,7 @@ unsigned int HI_VarWidthReduce::HI_getBidwith(Value *I)
             isUnsignedInst ? ConstantRange(APInt(HI_getUnsignedRangeRef(tmp_S).getBitWidth(), 0),
                                            HI_getUnsignedRangeRef(tmp_S).getUpper())
                            : HI_getSignedRangeRef(tmp_S);
+        tmp_CR2 = refineRange(I, tmp_CR2, isUnsignedInst);
         return bitNeededFor(tmp_CR2);
     }
     else
@@ -367,6 +688,16 @@ bool HI_VarWidthReduce::InsturctionUpdate_WidthCast(Function *F)
     return changed;
 }
 
+Instruction *HI_VarWidthReduce::getCastInsertPoint(Value *Op_V)
+{
+    if (Argument *Arg = dyn_cast<Argument>(Op_V))
+        return &*Arg->getParent()->getEntryBlock().getFirstInsertionPt();
+    Instruction *Op_I = cast<Instruction>(Op_V);
+    if (Op_I->getOpcode() == Instruction::PHI)
+        return Op_I->getParent()->getFirstNonPHI();
+    return Op_I->getNextNode();
+}
+
 // Check Redundancy: Some instructions could be truncated to be an operand, but itself is actually
 // updated with the same bitwidth with the truncation.
 bool HI_VarWidthReduce::RedundantCastRemove(Function *F)
@@ -375,47 +706,44 @@ bool HI_VarWidthReduce::RedundantCastRemove(Function *F)
     if (DEBUG)
         *VarWidthChangeLog << "==============================================\n===================="
                               "==========================\n\n\n\n\n\n";
+    // removing a cast does not change the bitwidth of the other casts, so one sweep of the blocks
+    // is enough
     for (BasicBlock &B : *F)
     {
-        bool rmflag = 1;
-        while (rmflag)
+        for (auto I_it = B.begin(), I_ie = B.end(); I_it != I_ie;)
         {
-            rmflag = 0;
-            for (Instruction &I : B)
+            Instruction &I = *I_it;
+            ++I_it; // the instruction might be erased
+            if (DEBUG)
+                *VarWidthChangeLog << "                         ------->checking redunctan CastI: "
+                                   << I << "\n";
+            if (CastInst *CastI = dyn_cast<CastInst>(&I))
             {
-                if (DEBUG)
-                    *VarWidthChangeLog
-                        << "                         ------->checking redunctan CastI: " << I
-                        << "\n";
-                if (CastInst *CastI = dyn_cast<CastInst>(&I))
+                if (CastI->getOpcode() != Instruction::Trunc &&
+                    CastI->getOpcode() != Instruction::ZExt &&
+                    CastI->getOpcode() != Instruction::SExt)
                 {
-                    if (CastI->getOpcode() != Instruction::Trunc &&
-                        CastI->getOpcode() != Instruction::ZExt &&
-                        CastI->getOpcode() != Instruction::SExt)
-                    {
-                        // Cast Instrctions are more than TRUNC/EXT
-                        continue;
-                    }
-                    // If bitwidth(A)==bitwidth(B) in TRUNT/EXT A to B, then it is not necessary to
-                    // do the instruction
-                    if (CastI->getType()->getIntegerBitWidth() ==
-                        I.getOperand(0)->getType()->getIntegerBitWidth())
-                    {
-                        if (DEBUG)
-                            *VarWidthChangeLog
-                                << "                         ------->remove redunctan CastI: "
-                                << *CastI << "\n";
-                        if (DEBUG)
-                            *VarWidthChangeLog << "                         ------->replace CastI "
-                                                  "with its operand 0: "
-                                               << *I.getOperand(0) << "\n";
-                        // VarWidthChangeLog->flush();
-                        ReplaceUses_withNewOperand_oriBW(&I, I.getOperand(0));
-                        I.eraseFromParent();
-                        rmflag = 1;
-                        changed = 1;
-                        break;
-                    }
+                    // Cast Instrctions are more than TRUNC/EXT
+                    continue;
+                }
+                // If bitwidth(A)==bitwidth(B) in TRUNT/EXT A to B, then it is not necessary to do
+                // the instruction
+                if (CastI->getType()->getIntegerBitWidth() ==
+                    I.getOperand(0)->getType()->getIntegerBitWidth())
+                {
+                    if (DEBUG)
+                        *VarWidthChangeLog
+                            << "                         ------->remove redunctan CastI: " << *CastI
+                            << "\n";
+                    if (DEBUG)
+                        *VarWidthChangeLog << "                         ------->replace CastI "
+                                              "with its operand 0: "
+                                           << *I.getOperand(0) << "\n";
+                    // VarWidthChangeLog->flush();
+                    ReplaceUses_withNewOperand_oriBW(&I, I.getOperand(0));
+                    I2NeedSign.erase(&I);
+                    I.eraseFromParent();
+                    changed = 1;
                 }
             }
         }
@@ -504,6 +832,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -524,6 +853,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -578,6 +908,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -596,6 +927,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -646,6 +978,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -664,6 +997,7 @@ void HI_VarWidthReduce::VarWidthReduce_Validation(Function *F)
                                     << "                         ------->  accomplish replacement "
                                        "of original instruction in uses.\n";
                             // VarWidthChangeLog->flush();
+                            I2NeedSign.erase(I);
                             I->eraseFromParent();
                             if (DEBUG)
                                 *VarWidthChangeLog
@@ -723,9 +1057,11 @@ void HI_VarWidthReduce::ReplaceUses_withNewOperand_newBW(Instruction *from, Valu
 
         // we should not replace the argument with new argument with different BW, it may go wrong
         // to match the definition of the function therefore, we need to bitcast the value "to" to
-        // fit the bitwidth defined in the function definition
-        if (auto Call_I = dyn_cast<CallInst>(tmp_user))
+        // fit the bitwidth defined in the function definition. So do the returned and the stored
+        // values.
+        if (isa<CallInst>(tmp_user) || isa<ReturnInst>(tmp_user) || isa<StoreInst>(tmp_user))
         {
+            Instruction *Call_I = cast<Instruction>(tmp_user);
             if (DEBUG)
                 VarWidthChangeLog->flush();
             const SCEV *tmp_S = SE->getSCEV(to);
@@ -746,7 +1082,7 @@ void HI_VarWidthReduce::ReplaceUses_withNewOperand_newBW(Instruction *from, Valu
             IRBuilder<> Builder(Call_I);
             std::string regNameS = "bcast" + std::to_string(changed_id);
             changed_id++;
-            if (tmp_CR.getLower().isNegative())
+            if (tmp_CR.getLower().isNegative() && mightBeNegative(to))
             {
                 ResultPtr = Builder.CreateSExtOrTrunc(
                     to, from->use_begin()->get()->getType(),
@@ -876,25 +1212,24 @@ void HI_VarWidthReduce::BOI_WidthCast(BinaryOperator *BOI)
         }
         else
         {
-            if (Instruction *Op_I = dyn_cast<Instruction>(I.getOperand(i)))
+            // the arguments might be narrowed by the ranges from the call sites
+            if (isa<Instruction>(I.getOperand(i)) || isa<Argument>(I.getOperand(i)))
             {
+                Value *Op_I = I.getOperand(i);
                 if (DEBUG)
                     *VarWidthChangeLog << "                         ------->  op#" << i << " "
-                                       << *Op_I << " is an instruction\n";
+                                       << *Op_I << " is an instruction or argument\n";
                 // VarWidthChangeLog->flush();
-                Instruction *InsertPoint = nullptr;
-                if (Op_I->getOpcode() == Instruction::PHI)
-                    InsertPoint = Op_I->getParent()->getFirstNonPHI();
-                else
-                    InsertPoint = Op_I->getNextNode();
-                IRBuilder<> Builder(InsertPoint);
+                IRBuilder<> Builder(getCastInsertPoint(Op_I));
 
                 std::string regNameS = "bcast" + std::to_string(changed_id);
                 changed_id++;
                 // create a net type with specific bitwidth
                 Type *NewTy_OP =
                     IntegerType::get(I.getType()->getContext(), Instruction_BitNeeded[&I]);
-                if (I2NeedSign[&I])
+                // a narrowed non-negative operand has no sign bit, so it is zero-extended even
+                // for a signed user
+                if (I2NeedSign[&I] && mightBeNegative(Op_I))
                 {
                     ResultPtr = Builder.CreateSExtOrTrunc(
                         Op_I, NewTy_OP,
@@ -935,8 +1270,10 @@ void HI_VarWidthReduce::BOI_WidthCast(BinaryOperator *BOI)
     if (DEBUG)
         *VarWidthChangeLog << "                         ------->  new_BOI = " << *newBOI << "\n";
     // BOI->replaceAllUsesWith(newBOI) ;
+    I2NeedSign[newBOI] = I2NeedSign[&I];
     ReplaceUses_withNewOperand_newBW(BOI, newBOI);
     CopyInstMetadata(BOI, newBOI);
+    I2NeedSign.erase(&I);
     if (DEBUG)
         *VarWidthChangeLog << "                         ------->  accomplish replacement of "
                               "original instruction in uses.\n";
@@ -996,25 +1333,24 @@ void HI_VarWidthReduce::ICMP_WidthCast(ICmpInst *ICMP_I)
         }
         else
         {
-            if (Instruction *Op_I = dyn_cast<Instruction>(I.getOperand(i)))
+            // the arguments might be narrowed by the ranges from the call sites
+            if (isa<Instruction>(I.getOperand(i)) || isa<Argument>(I.getOperand(i)))
             {
+                Value *Op_I = I.getOperand(i);
                 if (DEBUG)
                     *VarWidthChangeLog << "                         ------->  op#" << i << " "
-                                       << *Op_I << " is an instruction\n";
+                                       << *Op_I << " is an instruction or argument\n";
                 // VarWidthChangeLog->flush();
-                Instruction *InsertPoint = nullptr;
-                if (Op_I->getOpcode() == Instruction::PHI)
-                    InsertPoint = Op_I->getParent()->getFirstNonPHI();
-                else
-                    InsertPoint = Op_I->getNextNode();
-                IRBuilder<> Builder(InsertPoint);
+                IRBuilder<> Builder(getCastInsertPoint(Op_I));
                 std::string regNameS = "bcast" + std::to_string(changed_id);
                 changed_id++;
 
                 // create a net type with specific bitwidth
                 Type *NewTy_OP =
                     IntegerType::get(I.getType()->getContext(), Instruction_BitNeeded[&I]);
-                if (I2NeedSign[&I])
+                // a narrowed non-negative operand has no sign bit, so it is zero-extended even
+                // for a signed user
+                if (I2NeedSign[&I] && mightBeNegative(Op_I))
                 {
                     ResultPtr = Builder.CreateSExtOrTrunc(
                         Op_I, NewTy_OP,
@@ -1059,8 +1395,10 @@ void HI_VarWidthReduce::ICMP_WidthCast(ICmpInst *ICMP_I)
     if (DEBUG)
         *VarWidthChangeLog << "                         ------->  new_CMP = " << *newCMP << "\n";
     // BOI->replaceAllUsesWith(newBOI) ;
+    I2NeedSign[newCMP] = I2NeedSign[&I];
     ReplaceUses_withNewOperand_newBW(ICMP_I, newCMP);
     CopyInstMetadata(ICMP_I, newCMP);
+    I2NeedSign.erase(&I);
     if (DEBUG)
         *VarWidthChangeLog << "                         ------->  accomplish replacement of "
                               "original instruction in uses.\n";
@@ -1119,24 +1457,23 @@ void HI_VarWidthReduce::PHI_WidthCast(llvm::PHINode *PHI_I)
         }
         else
         {
-            if (Instruction *Op_I = dyn_cast<Instruction>(I.getOperand(i)))
+            // the arguments might be narrowed by the ranges from the call sites
+            if (isa<Instruction>(I.getOperand(i)) || isa<Argument>(I.getOperand(i)))
             {
+                Value *Op_I = I.getOperand(i);
                 if (DEBUG)
                     *VarWidthChangeLog << "                         ------->  op#" << i << " "
-                                       << *Op_I << " is an instruction\n";
+                                       << *Op_I << " is an instruction or argument\n";
                 // VarWidthChangeLog->flush();
-                Instruction *InsertPoint = nullptr;
-                if (Op_I->getOpcode() == Instruction::PHI)
-                    InsertPoint = Op_I->getParent()->getFirstNonPHI();
-                else
-                    InsertPoint = Op_I->getNextNode();
-                IRBuilder<> Builder(InsertPoint);
+                IRBuilder<> Builder(getCastInsertPoint(Op_I));
                 std::string regNameS = "bcast" + std::to_string(changed_id);
                 changed_id++;
                 // create a net type with specific bitwidth
                 Type *NewTy_OP =
                     IntegerType::get(I.getType()->getContext(), Instruction_BitNeeded[&I]);
-                if (I2NeedSign[&I])
+                // a narrowed non-negative operand has no sign bit, so it is zero-extended even
+                // for a signed user
+                if (I2NeedSign[&I] && mightBeNegative(Op_I))
                 {
                     ResultPtr = Builder.CreateSExtOrTrunc(
                         Op_I, NewTy_OP,
@@ -1193,8 +1530,10 @@ void HI_VarWidthReduce::PHI_WidthCast(llvm::PHINode *PHI_I)
         *VarWidthChangeLog << "                         ------->  new_PHI_I = " << *new_PHI << "\n";
 
     // BOI->replaceAllUsesWith(newBOI) ;
+    I2NeedSign[new_PHI] = I2NeedSign[&I];
     ReplaceUses_withNewOperand_newBW(PHI_I, new_PHI);
     CopyInstMetadata(PHI_I, new_PHI);
+    I2NeedSign.erase(&I);
     if (DEBUG)
         *VarWidthChangeLog << "                         ------->  accomplish replacement of "
                               "original instruction in uses.\n";
@@ -3,6 +3,7 @@
 // related headers should be included.
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/DepthFirstIterator.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Analysis/LoopInfo.h"
@@ -186,11 +187,11 @@
 
 using namespace llvm;
 
-class HI_VarWidthReduce : public FunctionPass
+class HI_VarWidthReduce : public ModulePass
 {
   public:
     HI_VarWidthReduce(const char *VarWidthChangeLog_Name, bool DEBUG = 0)
-        : FunctionPass(ID), DEBUG(DEBUG)
+        : ModulePass(ID), DEBUG(DEBUG)
     {
         Instruction_Counter = 0;
         Function_Counter = 0;
@@ -263,6 +264,8 @@ class HI_VarWidthReduce : public FunctionPass
         Instruction2Pre_id.clear();
         Blcok2InstructionList_id.clear();
         Instruction_BitNeeded.clear();
+        Value2FixpointRange.clear();
+        Function2ReturnRange.clear();
 
         return false;
     }
@@ -273,7 +276,8 @@ class HI_VarWidthReduce : public FunctionPass
     // }
 
     void getAnalysisUsage(AnalysisUsage &AU) const;
-    virtual bool runOnFunction(Function &M);
+    virtual bool runOnModule(Module &M);
+    bool runOnFunction(Function &F);
     static char ID;
     bool DEBUG;
     // Determine the range for a particular SCEV, but bypass the operands generated from PtrToInt
@@ -302,10 +306,50 @@ class HI_VarWidthReduce : public FunctionPass
     // bitwidth
     void Bitwidth_Analysis(Function *F);
 
+    // Range Analysis: propagate the value ranges of the integer values in the module with a
+    // worklist until a fixpoint is reached, so the ranges can flow through the PHI nodes and the
+    // loop-carried chains, where the SCEV ranges are usually full sets, and across the calls of
+    // the sub-functions, i.e. from the call sites to the arguments and from the returned values
+    // back to the calls.
+    void Range_Analysis(Module &M);
+
+    // whether all the uses of the function are the direct calls of it, so the ranges of its
+    // arguments can be taken from the call sites, e.g. the instantiated functions and the
+    // extracted loops, but not the top function
+    bool hasKnownCallers(Function *F);
+
+    // the range of the instruction computed from the current ranges of its operands
+    ConstantRange evaluateRange(Instruction *I);
+
+    // the current range of the value in the fixpoint analysis, which is empty if it is not
+    // evaluated yet
+    ConstantRange getLatticeRange(Value *V);
+
+    // the range of the value after the fixpoint analysis, a full set if it is unknown
+    ConstantRange getFixpointRange(Value *V);
+
+    // merge the range into the current one, widen it if it is a merge point of the loops or the
+    // recursions, and return whether the current range is changed
+    bool mergeRange(ConstantRange &curCR, ConstantRange CR, bool widen);
+
+    // widen the range of a PHI node to the next signed/unsigned power-of-two bound, so the ranges
+    // of the loop-carried chains converge in a few updates
+    ConstantRange widenRange(ConstantRange CR);
+
+    // narrow the HI range of the value with its range from the fixpoint analysis
+    ConstantRange refineRange(Value *V, ConstantRange CR, bool isUnsigned);
+
+    // whether the value might be negative, i.e. whether it should be sign-extended
+    bool mightBeNegative(Value *V);
+
     // Forward Process: check the bitwidth of operands and output of an instruction, trunc/ext the
     // operands, update the bitwidth of the instruction
     bool InsturctionUpdate_WidthCast(Function *F);
 
+    // the position to insert the trunc/ext of an operand, right after its definition, or at the
+    // beginning of the function for an argument
+    Instruction *getCastInsertPoint(Value *Op_V);
+
     // Forward Process of BinaryOperator: check the bitwidth of operands and output of an
     // instruction, trunc/ext the operands, update the bitwidth of the instruction
     void BOI_WidthCast(BinaryOperator *BOI);
@@ -354,6 +398,15 @@ class HI_VarWidthReduce : public FunctionPass
     DenseMap<const SCEV *, ConstantRange> UnsignedRanges;
     std::map<Instruction *, unsigned int> Instruction_BitNeeded;
 
+    // the ranges of the integer instructions and arguments from the fixpoint analysis, an empty
+    // set means that the value is not evaluated yet. The ranges of a function are dropped once it
+    // is analyzed, and the ValueMap drops the ranges of the erased values, so a new value at a
+    // recycled address cannot inherit a range.
+    ValueMap<Value *, ConstantRange> Value2FixpointRange;
+
+    // the ranges of the values returned by the functions
+    DenseMap<Function *, ConstantRange> Function2ReturnRange;
+
     std::map<Instruction *, bool> I2NeedSign;
 
     std::error_code ErrInfo;
@@ -0,0 +1,36 @@
+#include "HI_InstructionIndex.h"
+
+using namespace llvm;
+
+void HI_InstructionIndex::build(Module &M)
+{
+    Inst2ID.clear();
+    ID2Inst.clear();
+    Block2ID.clear();
+    ID2Block.clear();
+    for (auto &F : M)
+        for (auto &B : F)
+        {
+            Block2ID[&B] = ID2Block.size();
+            ID2Block.push_back(&B);
+            for (auto &I : B)
+            {
+                Inst2ID[&I] = ID2Inst.size();
+                ID2Inst.push_back(&I);
+            }
+        }
+
+    // the operands are numbered after all the instructions, since an operand (e.g. the incoming
+    // value of a PHINode) can be behind its user
+    OperandBegin.clear();
+    OperandIDs.clear();
+    for (auto I : ID2Inst)
+    {
+        OperandBegin.push_back(OperandIDs.size());
+        for (auto &op : I->operands())
+        {
+            auto opI = dyn_cast<Instruction>(op.get());
+            OperandIDs.push_back(opI ? Inst2ID.lookup(opI) : -1);
+        }
+    }
+}
@@ -0,0 +1,306 @@
+#ifndef _HI_InstructionIndex
+#define _HI_InstructionIndex
+
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Instruction.h"
+#include "llvm/IR/Module.h"
+#include <cassert>
+#include <vector>
+
+// The dense numbering of the instructions and the blocks in a module. The IR is not changed
+// during the evaluation, so they are numbered once before it, and the per-instruction state of
+// the evaluation is kept in contiguous columns indexed by the IDs (HI_InstColumn) rather than in
+// trees keyed by the pointers. The instructions of a block get consecutive IDs in program order.
+// The per-block and per-loop state is kept in the same way (HI_BlockColumn), where a loop is
+// identified by its header block, as the evaluator does.
+//
+// An instruction has no field to keep its ID, so getID hashes the pointer. The IDs of the
+// operands are also recorded when the instructions are numbered, so the evaluation walking the
+// instructions of a block by their IDs (see getBlockBeginID) reaches the operands and the columns
+// without any hashing.
+class HI_InstructionIndex
+{
+  public:
+    void build(llvm::Module &M);
+
+    int getInstNum() const
+    {
+        return ID2Inst.size();
+    }
+
+    // the ID of the instruction by hashing its pointer, the walks by IDs should be preferred
+    int getID(const llvm::Instruction *I) const
+    {
+        auto it = Inst2ID.find(I);
+        assert(it != Inst2ID.end() && "the instruction should be numbered before the evaluation");
+        return it->second;
+    }
+
+    llvm::Instruction *getInst(int ID) const
+    {
+        return ID2Inst[ID];
+    }
+
+    // the IDs of the instructions of the block are [getBlockBeginID(B), getBlockEndID(B))
+    int getBlockBeginID(const llvm::BasicBlock *B) const
+    {
+        return getID(&B->front());
+    }
+
+    int getBlockEndID(const llvm::BasicBlock *B) const
+    {
+        return getID(&B->back()) + 1;
+    }
+
+    // the ID of the operand #op of the instruction, -1 if the operand is not an instruction
+    int getOperandID(int ID, unsigned op) const
+    {
+        return OperandIDs[OperandBegin[ID] + op];
+    }
+
+    int getBlockNum() const
+    {
+        return ID2Block.size();
+    }
+
+    int getBlockID(const llvm::BasicBlock *B) const
+    {
+        auto it = Block2ID.find(B);
+        assert(it != Block2ID.end() && "the block should be numbered before the evaluation");
+        return it->second;
+    }
+
+    llvm::BasicBlock *getBlock(int ID) const
+    {
+        return ID2Block[ID];
+    }
+
+  private:
+    llvm::DenseMap<const llvm::Instruction *, int> Inst2ID;
+    std::vector<llvm::Instruction *> ID2Inst;
+
+    llvm::DenseMap<const llvm::BasicBlock *, int> Block2ID;
+    std::vector<llvm::BasicBlock *> ID2Block;
+
+    // the operand IDs of the instruction #ID are OperandIDs[OperandBegin[ID]...]
+    std::vector<int> OperandBegin;
+    std::vector<int> OperandIDs;
+};
+
+// A column of the per-instruction state indexed by the instruction IDs, where a flag records
+// whether the value of an instruction has been set, like the existence of a key in a map
+template <class T> class HI_InstColumn
+{
+  public:
+    HI_InstColumn(const HI_InstructionIndex &index) : index(index)
+    {
+    }
+
+    // drop all the values and fit the column to the numbered instructions
+    void reset()
+    {
+        values.assign(index.getInstNum(), T());
+        recorded.clear();
+        recorded.resize(index.getInstNum());
+    }
+
+    bool count(const llvm::Instruction *I) const
+    {
+        return count(index.getID(I));
+    }
+
+    bool count(int ID) const
+    {
+        return recorded.test(ID);
+    }
+
+    // the value of the instruction, which is marked recorded, like std::map::operator[]
+    T &operator[](const llvm::Instruction *I)
+    {
+        return (*this)[index.getID(I)];
+    }
+
+    T &operator[](int ID)
+    {
+        recorded.set(ID);
+        return values[ID];
+    }
+
+  private:
+    const HI_InstructionIndex &index;
+    std::vector<T> values;
+    llvm::BitVector recorded;
+};
+
+// A set of instructions, as a bit per instruction ID
+class HI_InstSet
+{
+  public:
+    HI_InstSet(const HI_InstructionIndex &index) : index(index)
+    {
+    }
+
+    void reset()
+    {
+        members.clear();
+        members.resize(index.getInstNum());
+    }
+
+    bool count(const llvm::Instruction *I) const
+    {
+        return members.test(index.getID(I));
+    }
+
+    void insert(const llvm::Instruction *I)
+    {
+        members.set(index.getID(I));
+    }
+
+  private:
+    const HI_InstructionIndex &index;
+    llvm::BitVector members;
+};
+
+// A column of the per-block state indexed by the block IDs, e.g. the latency of each block, or
+// of each loop by its header. Like HI_InstColumn, a flag records whether the value of a block has
+// been set.
+template <class T> class HI_BlockColumn
+{
+  public:
+    HI_BlockColumn(const HI_InstructionIndex &index) : index(index)
+    {
+    }
+
+    // drop all the values and fit the column to the numbered blocks
+    void reset()
+    {
+        values.assign(index.getBlockNum(), T());
+        recorded.clear();
+        recorded.resize(index.getBlockNum());
+    }
+
+    // drop all the values, e.g. before the blocks are numbered
+    void clear()
+    {
+        values.clear();
+        recorded.clear();
+    }
+
+    bool count(const llvm::BasicBlock *B) const
+    {
+        return recorded.test(index.getBlockID(B));
+    }
+
+    // the value of the block, which is marked recorded, like std::map::operator[]
+    T &operator[](const llvm::BasicBlock *B)
+    {
+        int ID = index.getBlockID(B);
+        recorded.set(ID);
+        return values[ID];
+    }
+
+  private:
+    const HI_InstructionIndex &index;
+    std::vector<T> values;
+    llvm::BitVector recorded;
+};
+
+// A set of blocks (or of loops by their headers), as a bit per block ID
+class HI_BlockSet
+{
+  public:
+    HI_BlockSet(const HI_InstructionIndex &index) : index(index)
+    {
+    }
+
+    void reset()
+    {
+        members.clear();
+        members.resize(index.getBlockNum());
+    }
+
+    void clear()
+    {
+        members.clear();
+    }
+
+    bool count(const llvm::BasicBlock *B) const
+    {
+        return members.test(index.getBlockID(B));
+    }
+
+    void insert(const llvm::BasicBlock *B)
+    {
+        members.set(index.getBlockID(B));
+    }
+
+  private:
+    const HI_InstructionIndex &index;
+    llvm::BitVector members;
+};
+
+// The view of a column restricted to the instructions of a block, e.g. the critical paths of the
+// instructions evaluated so far in the block under evaluation. Only the instructions of the block
+// are visible, so it behaves like a map local to the block evaluation.
+template <class T> class HI_BlockInstView
+{
+  public:
+    HI_BlockInstView(HI_InstColumn<T> &column, const HI_InstructionIndex &index,
+                     llvm::BasicBlock *B)
+        : column(column), B(B), beginID(index.getBlockBeginID(B)), endID(index.getBlockEndID(B))
+    {
+    }
+
+    llvm::BasicBlock *getBlock() const
+    {
+        return B;
+    }
+
+    int getBeginID() const
+    {
+        return beginID;
+    }
+
+    int getEndID() const
+    {
+        return endID;
+    }
+
+    // whether the instruction #ID is in the block
+    bool contains(int ID) const
+    {
+        return ID >= beginID && ID < endID;
+    }
+
+    bool count(const llvm::Instruction *I) const
+    {
+        return I->getParent() == B && column.count(I);
+    }
+
+    bool count(int ID) const
+    {
+        return contains(ID) && column.count(ID);
+    }
+
+    T &operator[](const llvm::Instruction *I)
+    {
+        assert(I->getParent() == B && "the instruction is out of the block");
+        return column[I];
+    }
+
+    T &operator[](int ID)
+    {
+        assert(contains(ID) && "the instruction is out of the block");
+        return column[ID];
+    }
+
+  private:
+    HI_InstColumn<T> &column;
+    llvm::BasicBlock *B;
+    int beginID;
+    int endID;
+};
+
+#endif
@@ -0,0 +1,52 @@
+#include "HI_ModuloReservationTable.h"
+#include <algorithm>
+
+bool HI_ModuloReservationTable::hasIterationConflict() const
+{
+    std::vector<int> sortedCycles(usageCycles);
+    std::sort(sortedCycles.begin(), sortedCycles.end());
+    int sameCycleNum = 0;
+    for (unsigned i = 0; i < sortedCycles.size(); i++)
+    {
+        if (i > 0 && sortedCycles[i] == sortedCycles[i - 1])
+            sameCycleNum++;
+        else
+            sameCycleNum = 1;
+        if (sameCycleNum > portNum)
+            return true;
+    }
+    return false;
+}
+
+bool HI_ModuloReservationTable::checkII(int II) const
+{
+    if (II < getResMII())
+        return false;
+    if (slotUsage.size() < (unsigned)II)
+        slotUsage.resize(II, 0);
+
+    bool valid = true;
+    for (auto cycle : usageCycles)
+    {
+        if (++slotUsage[cycle % II] > portNum)
+        {
+            valid = false;
+            break;
+        }
+    }
+
+    // only the slots touched by the usages are cleared, so a check is O(usages) rather than O(II)
+    for (auto cycle : usageCycles)
+        slotUsage[cycle % II] = 0;
+    return valid;
+}
+
+int HI_ModuloReservationTable::getMinII(int lowII, int highII) const
+{
+    if (hasIterationConflict())
+        return -1;
+    for (int II = std::max(lowII, std::max(getResMII(), 1)); II <= highII; II++)
+        if (checkII(II))
+            return II;
+    return -1;
+}
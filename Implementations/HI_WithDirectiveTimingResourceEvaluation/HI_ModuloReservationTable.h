@@ -0,0 +1,59 @@
+#ifndef _HI_ModuloReservationTable
+#define _HI_ModuloReservationTable
+
+#include <cassert>
+#include <vector>
+
+// A modulo reservation table (MRT) of a resource with limited ports, e.g. a partition of an array.
+// The usages of the resource in one iteration of a pipelined loop are recorded by their cycles
+// (from the beginning of the iteration). With an initiation interval II, the usages of the
+// overlapped iterations at cycle c are the usages of one iteration at the cycles equal to c
+// modulo II, so an II is valid iff no slot of the table is used more than the port number.
+class HI_ModuloReservationTable
+{
+  public:
+    HI_ModuloReservationTable(int portNum = 1) : portNum(portNum)
+    {
+    }
+
+    // record a usage of the resource at the cycle in one iteration
+    void addUsage(int cycle)
+    {
+        assert(cycle >= 0 && "the usage should be in the iteration");
+        usageCycles.push_back(cycle);
+    }
+
+    int getUsageNum() const
+    {
+        return usageCycles.size();
+    }
+
+    int getPortNum() const
+    {
+        return portNum;
+    }
+
+    // the resource-constrained minimum II, i.e. ceil(usages / ports)
+    int getResMII() const
+    {
+        return (usageCycles.size() + portNum - 1) / portNum;
+    }
+
+    // check whether the usages in one iteration exceed the ports in some cycle, so no II is valid
+    bool hasIterationConflict() const;
+
+    // check whether the usages conflict with the II, O(usages)
+    bool checkII(int II) const;
+
+    // get the minimum valid II in [lowII, highII], -1 if none
+    int getMinII(int lowII, int highII) const;
+
+  private:
+    int portNum;
+    std::vector<int> usageCycles;
+
+    // the occupation of the slots, which is cleared after each check
+    mutable std::vector<int> slotUsage;
+};
+
+#endif
@@ -0,0 +1,240 @@
+#include "HI_ModuloScheduler.h"
+#include "HI_RecurrenceGraph.h"
+#include <algorithm>
+#include <cassert>
+
+void HI_ModuloScheduler::setLatency(int op, int latency)
+{
+    assert(op >= 0 && op < opNum && latency >= 0);
+    opLatency[op] = latency;
+}
+
+int HI_ModuloScheduler::addResource(int capacity)
+{
+    resCapacity.push_back(capacity);
+    return resCapacity.size() - 1;
+}
+
+void HI_ModuloScheduler::addUsage(int op, int resource, int num)
+{
+    assert(op >= 0 && op < opNum && resource >= 0 && resource < (int)resCapacity.size());
+    // an operation using more units than the capacity occupies the entire resource
+    if (resCapacity[resource] > 0 && num > resCapacity[resource])
+        num = resCapacity[resource];
+    if (num > 0)
+        opUsages[op].push_back(std::make_pair(resource, num));
+}
+
+void HI_ModuloScheduler::addEdge(int from, int to, int delay, int distance)
+{
+    assert(from >= 0 && from < opNum && to >= 0 && to < opNum && distance >= 0);
+    inEdges[to].push_back(edges.size());
+    outEdges[from].push_back(edges.size());
+    edges.push_back(Edge{from, to, delay, distance});
+}
+
+int HI_ModuloScheduler::getResMII() const
+{
+    std::vector<int> totalUsage(resCapacity.size(), 0);
+    for (auto &usages : opUsages)
+        for (auto &usage : usages)
+            totalUsage[usage.first] += usage.second;
+    int res = 1;
+    for (unsigned i = 0; i < resCapacity.size(); i++)
+        if (resCapacity[i] > 0)
+            res = std::max(res, (totalUsage[i] + resCapacity[i] - 1) / resCapacity[i]);
+    return res;
+}
+
+int HI_ModuloScheduler::getRecMII() const
+{
+    HI_RecurrenceGraph recurrenceGraph(opNum);
+    for (auto &e : edges)
+        recurrenceGraph.addEdge(e.from, e.to, e.delay, e.distance);
+    return recurrenceGraph.getRecMII();
+}
+
+// the height of an operation is the longest path from it to the end of the iteration, where an
+// edge of distance d is shortened by d * II. It is found by relaxing the edges like Bellman-Ford,
+// and a change after opNum rounds means a cycle of positive length, i.e. II < RecMII.
+bool HI_ModuloScheduler::getHeights(int tryII, std::vector<int> &height) const
+{
+    height.assign(opNum, 0);
+    for (int op = 0; op < opNum; op++)
+        height[op] = opLatency[op];
+    for (int round = 0; round <= opNum; round++)
+    {
+        bool changed = false;
+        for (auto &e : edges)
+        {
+            int tryHeight = height[e.to] + e.delay - tryII * e.distance;
+            if (tryHeight > height[e.from])
+            {
+                height[e.from] = tryHeight;
+                changed = true;
+            }
+        }
+        if (!changed)
+            return true;
+    }
+    return false;
+}
+
+bool HI_ModuloScheduler::isResourceFree(int op, int cycle) const
+{
+    for (auto &usage : opUsages[op])
+    {
+        int capacity = resCapacity[usage.first];
+        if (capacity > 0 && resSlotUsage[usage.first][cycle % II] + usage.second > capacity)
+            return false;
+    }
+    return true;
+}
+
+void HI_ModuloScheduler::placeOp(int op, int cycle)
+{
+    startTime[op] = cycle;
+    for (auto &usage : opUsages[op])
+        resSlotUsage[usage.first][cycle % II] += usage.second;
+}
+
+void HI_ModuloScheduler::removeOp(int op)
+{
+    for (auto &usage : opUsages[op])
+        resSlotUsage[usage.first][startTime[op] % II] -= usage.second;
+    startTime[op] = -1;
+}
+
+bool HI_ModuloScheduler::scheduleWithII(int tryII, int budget)
+{
+    std::vector<int> height;
+    if (!getHeights(tryII, height))
+        return false;
+
+    II = tryII;
+    startTime.assign(opNum, -1);
+    resSlotUsage.assign(resCapacity.size(), std::vector<int>(II, 0));
+    std::vector<int> prevTime(opNum, -1);
+
+    // the operations are scheduled in the order of decreasing height
+    std::vector<int> order(opNum);
+    for (int op = 0; op < opNum; op++)
+        order[op] = op;
+    std::stable_sort(order.begin(), order.end(),
+                     [&](int a, int b) -> bool { return height[a] > height[b]; });
+
+    int unscheduledNum = opNum;
+    while (unscheduledNum > 0)
+    {
+        if (budget-- <= 0)
+            return false;
+
+        int op = -1;
+        for (auto tryOp : order)
+            if (startTime[tryOp] < 0)
+            {
+                op = tryOp;
+                break;
+            }
+
+        // the earliest cycle allowed by the scheduled predecessors
+        int Estart = 0;
+        for (auto edgeID : inEdges[op])
+        {
+            const Edge &e = edges[edgeID];
+            if (e.from != op && startTime[e.from] >= 0)
+                Estart = std::max(Estart, startTime[e.from] + e.delay - II * e.distance);
+        }
+
+        // the II slots from Estart cover the entire modulo reservation table
+        int slot = -1;
+        for (int cycle = Estart; cycle < Estart + II; cycle++)
+            if (isResourceFree(op, cycle))
+            {
+                slot = cycle;
+                break;
+            }
+        if (slot < 0)
+            slot = (prevTime[op] < 0 || Estart > prevTime[op]) ? Estart : prevTime[op] + 1;
+
+        // evict the operations using the resources in the same slot
+        for (auto &usage : opUsages[op])
+        {
+            int capacity = resCapacity[usage.first];
+            if (capacity <= 0)
+                continue;
+            for (int other = 0; other < opNum &&
+                                resSlotUsage[usage.first][slot % II] + usage.second > capacity;
+                 other++)
+            {
+                if (startTime[other] < 0 || startTime[other] % II != slot % II)
+                    continue;
+                for (auto &otherUsage : opUsages[other])
+                    if (otherUsage.first == usage.first)
+                    {
+                        removeOp(other);
+                        unscheduledNum++;
+                        break;
+                    }
+            }
+        }
+
+        placeOp(op, slot);
+        prevTime[op] = slot;
+        unscheduledNum--;
+
+        // evict the successors whose dependences are violated
+        for (auto edgeID : outEdges[op])
+        {
+            const Edge &e = edges[edgeID];
+            if (e.to != op && startTime[e.to] >= 0 &&
+                startTime[e.to] < slot + e.delay - II * e.distance)
+            {
+                removeOp(e.to);
+                unscheduledNum++;
+            }
+        }
+    }
+    return true;
+}
+
+int HI_ModuloScheduler::schedule(int minII, int maxII, int budgetRatio)
+{
+    int lowII = std::max(minII, std::max(getResMII(), getRecMII()));
+    for (int tryII = lowII; tryII <= maxII; tryII++)
+        if (scheduleWithII(tryII, budgetRatio * opNum + 1))
+            return II;
+    II = -1;
+    startTime.assign(opNum, -1);
+    return -1;
+}
+
+int HI_ModuloScheduler::getDepth() const
+{
+    int depth = 0;
+    for (int op = 0; op < opNum; op++)
+        depth = std::max(depth, startTime[op] + opLatency[op]);
+    return depth;
+}
+
+int HI_ModuloScheduler::getStageNum() const
+{
+    assert(II > 0 && "the operations should be scheduled");
+    int res = std::max(1, (getDepth() + II - 1) / II);
+    // an operation without latency may begin at the end of the iteration
+    for (int op = 0; op < opNum; op++)
+        res = std::max(res, startTime[op] / II + 1);
+    return res;
+}
+
+int HI_ModuloScheduler::getStageUsage(int stage, int resource) const
+{
+    assert(II > 0 && "the operations should be scheduled");
+    int res = 0;
+    for (int op = 0; op < opNum; op++)
+        if (startTime[op] / II == stage)
+            for (auto &usage : opUsages[op])
+                if (usage.first == resource)
+                    res += usage.second;
+    return res;
+}
@@ -0,0 +1,103 @@
+#ifndef _HI_ModuloScheduler
+#define _HI_ModuloScheduler
+
+#include <vector>
+
+// An iterative modulo scheduler (B. R. Rau, "Iterative Modulo Scheduling", MICRO 1994) for the
+// operations in one iteration of a pipelined loop. The operations are connected by dependence
+// edges with delays and iteration distances, and they may use resources with limited capacities,
+// e.g. the ports of an array partition or the DSPs. With an initiation interval II, the usages of
+// the overlapped iterations at a cycle are the usages of one iteration at the cycles equal to it
+// modulo II. The operations are scheduled by their heights, and an operation which cannot find a
+// free slot evicts the conflicting ones, until all are scheduled or the budget is used up, in which
+// case the next II is tried.
+class HI_ModuloScheduler
+{
+  public:
+    HI_ModuloScheduler(int opNum)
+        : opNum(opNum), opLatency(opNum, 0), opUsages(opNum), inEdges(opNum), outEdges(opNum),
+          startTime(opNum, -1)
+    {
+    }
+
+    // the cycles from the beginning of the operation to the availability of its result
+    void setLatency(int op, int latency);
+
+    // add a resource and return its ID, a capacity <= 0 means the resource is unlimited, i.e. its
+    // usage is only recorded
+    int addResource(int capacity);
+
+    // the operation uses num units of the resource in the cycle it begins
+    void addUsage(int op, int resource, int num = 1);
+
+    // the sink begins at least delay cycles after the source of distance iterations before
+    void addEdge(int from, int to, int delay, int distance);
+
+    // the resource-constrained minimum II
+    int getResMII() const;
+
+    // the recurrence-constrained minimum II
+    int getRecMII() const;
+
+    // schedule the operations with the minimum II in [max(minII, ResMII, RecMII), maxII], the
+    // budget of each II is budgetRatio * opNum scheduling steps. The achieved II is returned, -1 if
+    // none is found.
+    int schedule(int minII, int maxII, int budgetRatio = 6);
+
+    int getII() const
+    {
+        return II;
+    }
+
+    // the beginning cycle of the operation in the iteration
+    int getStartTime(int op) const
+    {
+        return startTime[op];
+    }
+
+    // the cycles from the beginning to the end of an iteration
+    int getDepth() const;
+
+    // the number of stages, i.e. ceil(depth / II), at least 1 and covering all the operations
+    int getStageNum() const;
+
+    // the usage of the resource by the operations beginning in the stage
+    int getStageUsage(int stage, int resource) const;
+
+  private:
+    struct Edge
+    {
+        int from;
+        int to;
+        int delay;
+        int distance;
+    };
+
+    int opNum;
+    int II = -1;
+    std::vector<int> opLatency;
+    std::vector<int> resCapacity;
+    std::vector<std::vector<std::pair<int, int>>> opUsages;
+    std::vector<Edge> edges;
+    std::vector<std::vector<int>> inEdges;
+    std::vector<std::vector<int>> outEdges;
+    std::vector<int> startTime;
+
+    // the usages of the resources in the slots of the modulo reservation table
+    std::vector<std::vector<int>> resSlotUsage;
+
+    // get the heights of the operations with the II, false if a recurrence is violated by the II
+    bool getHeights(int tryII, std::vector<int> &height) const;
+
+    // check whether the resources used by the operation are free at the cycle
+    bool isResourceFree(int op, int cycle) const;
+
+    void placeOp(int op, int cycle);
+
+    void removeOp(int op);
+
+    // try to schedule the operations with the II within the budget
+    bool scheduleWithII(int tryII, int budget);
+};
+
+#endif
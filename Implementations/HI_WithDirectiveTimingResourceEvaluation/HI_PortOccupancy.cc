@@ -0,0 +1,38 @@
+#include "HI_PortOccupancy.h"
+
+int HI_PortOccupancy::getUsage(int cycle) const
+{
+    auto it = cycle2Usage.find(cycle);
+    return it == cycle2Usage.end() ? 0 : it->second;
+}
+
+void HI_PortOccupancy::addUsage(int cycle)
+{
+    if (++cycle2Usage[cycle] != portNum)
+        return;
+
+    // the cycle becomes full, merge it with the adjacent full runs
+    int begin = cycle, end = cycle + 1;
+    auto next = fullRuns.find(end);
+    if (next != fullRuns.end())
+    {
+        end = next->second;
+        fullRuns.erase(next);
+    }
+    auto prev = fullRuns.lower_bound(cycle);
+    if (prev != fullRuns.begin() && (--prev)->second == cycle)
+    {
+        prev->second = end;
+        return;
+    }
+    fullRuns[begin] = end;
+}
+
+int HI_PortOccupancy::getFirstAvailableCycle(int cycle) const
+{
+    auto it = fullRuns.upper_bound(cycle);
+    if (it == fullRuns.begin())
+        return cycle;
+    --it;
+    return (cycle < it->second) ? it->second : cycle;
+}
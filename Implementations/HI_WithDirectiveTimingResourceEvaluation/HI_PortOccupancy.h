@@ -0,0 +1,39 @@
+#ifndef _HI_PortOccupancy
+#define _HI_PortOccupancy
+
+#include <map>
+
+// The occupancy of a resource with limited ports, e.g. a partition of an array, in the cycles of a
+// block. The usages are counted per cycle, and the runs of consecutive cycles whose ports are all
+// used are merged, so the first cycle with a free port from a given cycle is found in O(log n)
+// rather than by trying the cycles one by one.
+class HI_PortOccupancy
+{
+  public:
+    HI_PortOccupancy(int portNum = 1) : portNum(portNum)
+    {
+    }
+
+    // the number of usages at the cycle, O(log n)
+    int getUsage(int cycle) const;
+
+    bool isAvailable(int cycle) const
+    {
+        return getUsage(cycle) < portNum;
+    }
+
+    // record a usage at the cycle, O(log n)
+    void addUsage(int cycle);
+
+    // the first cycle >= the given one with a free port, O(log n)
+    int getFirstAvailableCycle(int cycle) const;
+
+  private:
+    int portNum;
+    std::map<int, int> cycle2Usage;
+
+    // begin -> end (exclusive) of the runs of the cycles whose ports are all used
+    std::map<int, int> fullRuns;
+};
+
+#endif
@@ -0,0 +1,225 @@
+#include "HI_RecurrenceGraph.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+static const double ratioEps = 1e-9;
+
+void HI_RecurrenceGraph::addEdge(int from, int to, int delay, int distance)
+{
+    assert(from >= 0 && from < nodeNum && to >= 0 && to < nodeNum && distance >= 0);
+    outEdges[from].push_back(edges.size());
+    edges.push_back(Edge{from, to, delay, distance});
+}
+
+// Tarjan's algorithm with an explicit stack, so large loop bodies cannot overflow the call stack
+int HI_RecurrenceGraph::getSCCs(std::vector<int> &SCC_ID) const
+{
+    std::vector<int> index(nodeNum, -1), lowLink(nodeNum, 0);
+    std::vector<bool> onStack(nodeNum, false);
+    std::vector<int> SCCStack;
+    std::vector<std::pair<int, unsigned>> DFSStack;
+    int indexCnt = 0, SCCNum = 0;
+    SCC_ID.assign(nodeNum, -1);
+
+    for (int root = 0; root < nodeNum; root++)
+    {
+        if (index[root] >= 0)
+            continue;
+        DFSStack.push_back(std::make_pair(root, 0));
+        index[root] = lowLink[root] = indexCnt++;
+        SCCStack.push_back(root);
+        onStack[root] = true;
+        while (!DFSStack.empty())
+        {
+            int cur = DFSStack.back().first;
+            unsigned edgePos = DFSStack.back().second;
+            if (edgePos < outEdges[cur].size())
+            {
+                DFSStack.back().second++;
+                int next = edges[outEdges[cur][edgePos]].to;
+                if (index[next] < 0)
+                {
+                    index[next] = lowLink[next] = indexCnt++;
+                    SCCStack.push_back(next);
+                    onStack[next] = true;
+                    DFSStack.push_back(std::make_pair(next, 0));
+                }
+                else if (onStack[next])
+                    lowLink[cur] = std::min(lowLink[cur], index[next]);
+                continue;
+            }
+
+            DFSStack.pop_back();
+            if (!DFSStack.empty())
+            {
+                int parent = DFSStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[cur]);
+            }
+            if (lowLink[cur] == index[cur])
+            {
+                int member;
+                do
+                {
+                    member = SCCStack.back();
+                    SCCStack.pop_back();
+                    onStack[member] = false;
+                    SCC_ID[member] = SCCNum;
+                } while (member != cur);
+                SCCNum++;
+            }
+        }
+    }
+    return SCCNum;
+}
+
+/*
+    Howard's policy iteration for the maximum cycle ratio in a strongly connected component:
+    (1) the policy selects one out-edge for each node, so each node reaches exactly one cycle of
+        the policy graph
+    (2) value determination: the ratio of a node is the ratio of the cycle it reaches, and its
+        potential is the sum of (delay - ratio * distance) along the path to the cycle
+    (3) policy improvement: switch to the out-edges reaching a cycle with a higher ratio, then to
+        the out-edges with higher potentials, until the policy cannot be improved
+*/
+double HI_RecurrenceGraph::getMaxCycleRatio_SCC(const std::vector<int> &SCC_ID, int SCC) const
+{
+    std::vector<int> nodes;
+    for (int i = 0; i < nodeNum; i++)
+        if (SCC_ID[i] == SCC)
+            nodes.push_back(i);
+
+    // (1) the initial policy takes the out-edge with the maximum delay in the component
+    std::vector<int> policy(nodeNum, -1);
+    for (auto node : nodes)
+        for (auto edgeID : outEdges[node])
+            if (SCC_ID[edges[edgeID].to] == SCC &&
+                (policy[node] < 0 || edges[edgeID].delay > edges[policy[node]].delay))
+                policy[node] = edgeID;
+
+    std::vector<double> ratio(nodeNum, 0), potential(nodeNum, 0);
+    std::vector<int> visitMark(nodeNum, -1);
+    std::vector<int> path;
+    int iterLimit = 100 + 10 * nodes.size() * nodes.size();
+    for (int iter = 0; iter < iterLimit; iter++)
+    {
+        // (2) value determination
+        for (auto node : nodes)
+            visitMark[node] = -1;
+        for (auto start : nodes)
+        {
+            if (visitMark[start] >= 0)
+                continue;
+            path.clear();
+            int cur = start;
+            while (visitMark[cur] < 0)
+            {
+                visitMark[cur] = start;
+                path.push_back(cur);
+                cur = edges[policy[cur]].to;
+            }
+
+            int evaluatedPos = path.size();
+            if (visitMark[cur] == start)
+            {
+                // a new cycle of the policy graph, which begins at cur
+                int cyclePos = std::find(path.begin(), path.end(), cur) - path.begin();
+                long long sumDelay = 0, sumDistance = 0;
+                for (int i = cyclePos; i < (int)path.size(); i++)
+                {
+                    sumDelay += edges[policy[path[i]]].delay;
+                    sumDistance += edges[policy[path[i]]].distance;
+                }
+                assert(sumDistance > 0 && "a recurrence should cross iterations");
+                double cycleRatio = (double)sumDelay / sumDistance;
+                ratio[cur] = cycleRatio;
+                potential[cur] = 0;
+                for (int i = path.size() - 1; i > cyclePos; i--)
+                {
+                    const Edge &e = edges[policy[path[i]]];
+                    ratio[path[i]] = cycleRatio;
+                    potential[path[i]] = e.delay - cycleRatio * e.distance + potential[e.to];
+                }
+                evaluatedPos = cyclePos;
+            }
+            for (int i = evaluatedPos - 1; i >= 0; i--)
+            {
+                const Edge &e = edges[policy[path[i]]];
+                ratio[path[i]] = ratio[e.to];
+                potential[path[i]] = e.delay - ratio[e.to] * e.distance + potential[e.to];
+            }
+        }
+
+        // (3) policy improvement by the ratios
+        bool changed = false;
+        for (auto node : nodes)
+        {
+            double bestRatio = ratio[node];
+            for (auto edgeID : outEdges[node])
+            {
+                int next = edges[edgeID].to;
+                if (SCC_ID[next] == SCC && ratio[next] > bestRatio + ratioEps)
+                {
+                    bestRatio = ratio[next];
+                    policy[node] = edgeID;
+                    changed = true;
+                }
+            }
+        }
+        if (changed)
+            continue;
+
+        // (3) policy improvement by the potentials
+        for (auto node : nodes)
+        {
+            double bestPotential = potential[node];
+            for (auto edgeID : outEdges[node])
+            {
+                const Edge &e = edges[edgeID];
+                if (SCC_ID[e.to] != SCC || std::fabs(ratio[e.to] - ratio[node]) > ratioEps)
+                    continue;
+                double tryPotential = e.delay - ratio[node] * e.distance + potential[e.to];
+                if (tryPotential > bestPotential + ratioEps)
+                {
+                    bestPotential = tryPotential;
+                    policy[node] = edgeID;
+                    changed = true;
+                }
+            }
+        }
+        if (!changed)
+            break;
+    }
+
+    double res = -1;
+    for (auto node : nodes)
+        res = std::max(res, ratio[node]);
+    return res;
+}
+
+double HI_RecurrenceGraph::getMaxCycleRatio() const
+{
+    std::vector<int> SCC_ID;
+    int SCCNum = getSCCs(SCC_ID);
+
+    // only the components with cycles, i.e. more than one node or a self-loop, are analyzed
+    std::vector<int> SCCSize(SCCNum, 0);
+    std::vector<bool> SCCHasCycle(SCCNum, false);
+    for (int i = 0; i < nodeNum; i++)
+        SCCSize[SCC_ID[i]]++;
+    for (auto &e : edges)
+        if (e.from == e.to || (SCC_ID[e.from] == SCC_ID[e.to] && SCCSize[SCC_ID[e.from]] > 1))
+            SCCHasCycle[SCC_ID[e.from]] = true;
+
+    double res = -1;
+    for (int SCC = 0; SCC < SCCNum; SCC++)
+        if (SCCHasCycle[SCC])
+            res = std::max(res, getMaxCycleRatio_SCC(SCC_ID, SCC));
+    return res;
+}
+
+int HI_RecurrenceGraph::getRecMII() const
+{
+    double maxRatio = getMaxCycleRatio();
+    return std::max(1, (int)std::ceil(maxRatio - ratioEps));
+}
@@ -0,0 +1,47 @@
+#ifndef _HI_RecurrenceGraph
+#define _HI_RecurrenceGraph
+
+#include <vector>
+
+// A graph of the dependences in a loop. Each edge has a delay (the cycles from the beginning of
+// the source to the beginning of the sink) and an iteration distance (0 for the dependences in
+// an iteration). A recurrence (cycle) requires II >= sum(delay) / sum(distance), so the
+// recurrence-constrained MII is the maximum cycle ratio of the graph.
+class HI_RecurrenceGraph
+{
+  public:
+    HI_RecurrenceGraph(int nodeNum) : nodeNum(nodeNum), outEdges(nodeNum)
+    {
+    }
+
+    // the cycles in the graph should have positive sums of distances
+    void addEdge(int from, int to, int delay, int distance);
+
+    // get the maximum cycle ratio by Howard's policy iteration on each strongly connected
+    // component, -1 if there is no cycle
+    double getMaxCycleRatio() const;
+
+    // get the minimum integer II meeting all the recurrences, at least 1
+    int getRecMII() const;
+
+  private:
+    struct Edge
+    {
+        int from;
+        int to;
+        int delay;
+        int distance;
+    };
+
+    int nodeNum;
+    std::vector<Edge> edges;
+    std::vector<std::vector<int>> outEdges;
+
+    // get the strongly connected components, return the number of them
+    int getSCCs(std::vector<int> &SCC_ID) const;
+
+    // get the maximum cycle ratio in a strongly connected component with cycles
+    double getMaxCycleRatio_SCC(const std::vector<int> &SCC_ID, int SCC) const;
+};
+
+#endif
@@ -28,6 +28,12 @@ bool HI_WithDirectiveTimingResourceEvaluation::runOnModule(
     if (DEBUG)
         *Evaluating_log << " ======================= the module end =======================\n";
 
+    initInstructionState(M);
+    AliasCache.clear();
+    design_clock_period_str = clock_period_str;
+    resolveHLSLibOpcodeIDs();
+    setClock(clock_period_str);
+
     // analyze BRAM accesses in the module before any other analysis
     TraceMemoryDeclarationAndAnalyzeAccessinModule(M);
 
@@ -51,6 +57,9 @@ bool HI_WithDirectiveTimingResourceEvaluation::runOnModule(
     // analyze and output the informaion of top function
     analyzeTopFunction(M);
 
+    if (DEBUG)
+        AliasCache.printStatistics(*ArrayLog);
+
     // gettimeofday (&tv_end, NULL);
     // print_status("done HI_WithDirectiveTimingResourceEvaluation analyzeTopFunction: "
     //     +
@@ -60,6 +69,31 @@ bool HI_WithDirectiveTimingResourceEvaluation::runOnModule(
     return false;
 }
 
+// number the instructions and blocks in the module and reset the per-instruction, per-block and
+// per-loop state, which is stored in the columns indexed by the IDs
+void HI_WithDirectiveTimingResourceEvaluation::initInstructionState(Module &M)
+{
+    InstIndex.build(M);
+    LoopLatency.reset();
+    BlockLatency.reset();
+    LoopResource.reset();
+    BlockResource.reset();
+    BlockEvaluated.reset();
+    LoopEvaluated.reset();
+    Block2EvaluatedLoop.reset();
+    BlockBegin_inLoop.reset();
+    Loop2CP.reset();
+    Loop2IterationLatency.reset();
+    Loop2AchievedII.reset();
+    Loop2PipelineDepth.reset();
+    Inst2TimeSlotInLoop.reset();
+    InstructionCriticalPath_inBlock.reset();
+    Inst_Schedule.reset();
+    Inst2LatestOperand.reset();
+    RegRelease_Schedule.reset();
+    I_RegReused.reset();
+}
+
 // check whether all the sub-function are evaluated
 bool HI_WithDirectiveTimingResourceEvaluation::CheckDependencyFesilility(Function &F)
 {
@@ -104,6 +138,7 @@ void HI_WithDirectiveTimingResourceEvaluation::getAnalysisUsage(AnalysisUsage &A
 // by recursively analysis from the lowest subfunctions
 void HI_WithDirectiveTimingResourceEvaluation::AnalyzeFunctions(Module &M)
 {
+    int sharedEvaluationNum = 0;
     bool all_processed = 0;
     while (!all_processed)
     {
@@ -134,13 +169,28 @@ void HI_WithDirectiveTimingResourceEvaluation::AnalyzeFunctions(Module &M)
                     LI = &getAnalysis<LoopInfoWrapperPass>(F).getLoopInfo();
                     SE = &getAnalysis<ScalarEvolutionWrapperPass>(F).getSE();
                     // AA = &getAnalysis<AAResultsWrapperPass>(F).getAAResults();
+                    setClock(getFunctionClockStr(&F)); // evaluate F in its clock domain
                     ArrayAccessCheckForFunction(&F);
                     getLoopBlockMap(&F);
-                    analyzeFunction(&F);
+
+                    // the instances of a sub-function share the evaluation of an identical one
+                    std::map<Value *, Value *> target2Target;
+                    Function *rep = findIdenticalEvaluatedFunction(&F, target2Target);
+                    if (rep)
+                    {
+                        shareFunctionEvaluation(&F, rep, target2Target);
+                        sharedEvaluationNum++;
+                    }
+                    else
+                        analyzeFunction(&F);
+                    setClock(design_clock_period_str);
                 }
             }
         }
     }
+    if (sharedEvaluationNum > 0)
+        print_status(std::to_string(sharedEvaluationNum) +
+                     " function(s) share the evaluation of the identical functions.");
 }
 
 // analyze and output the informaion of top function
@@ -172,6 +222,7 @@ void HI_WithDirectiveTimingResourceEvaluation::analyzeTopFunction(Module &M)
                 *Evaluating_log << "Top Function: " << F.getName() << " is found";
             topFunctionFound = 1;
             top_function_latency = analyzeFunction(&F).latency;
+            setClock(getFunctionClockStr(&F)); // the latency is in the clock domain of F
 
             // The top function BRAM interface should be considered.
             FunctionResource[&F] = FunctionResource[&F] + BRAMRelatedCostForTopFunction(F);
@@ -196,6 +247,7 @@ void HI_WithDirectiveTimingResourceEvaluation::analyzeTopFunction(Module &M)
             if (DEBUG)
                 *Evaluating_log << printOut << "\n";
             print_info(printOut);
+            setClock(design_clock_period_str);
         }
     }
 }
@@ -251,12 +303,14 @@ int HI_WithDirectiveTimingResourceEvaluation::getTotalStateNum(Module &M)
         if (DEBUG)
             *Evaluating_log << "================================\n              printing schedule "
                                "\n==================================\n";
-        for (auto it : Inst_Schedule)
+        for (int ID = 0, e = InstIndex.getInstNum(); ID < e; ID++)
         {
+            Instruction *I = InstIndex.getInst(ID);
+            if (!Inst_Schedule.count(I))
+                continue;
             if (DEBUG)
-                *Evaluating_log << "inst: [" << *it.first << "] in Block: ["
-                                << it.second.first->getName() << "] #cycle: [" << it.second.second
-                                << "]\n";
+                *Evaluating_log << "inst: [" << *I << "] in Block: [" << I->getParent()->getName()
+                                << "] #cycle: [" << Inst_Schedule[I] << "]\n";
         }
         if (DEBUG)
             Evaluating_log->flush();
@@ -272,14 +326,18 @@ int HI_WithDirectiveTimingResourceEvaluation::getTotalStateNum(Module &M)
             F.getName().find("HIPartitionMux") !=
                 std::string::npos) // bypass the "llvm.xxx" functions..
             continue;
-        BasicBlock *Func_Entry = &(F.getEntryBlock()); // get the entry of the function
+        // a function sharing the evaluation of an identical one has the same stages
+        Function *stageF = getRepresentativeFunction(&F);
+        BasicBlock *Func_Entry = &(stageF->getEntryBlock()); // get the entry of the function
+        setClock(getFunctionClockStr(stageF)); // the stages are in the clock domain of F
         timingBase origin_path_in_F(0, 0, 1, clock_period);
         tmp_BlockCriticalPath_inFunc.clear(); // record the block level critical path in the loop
         tmp_LoopCriticalPath_inFunc
             .clear(); // record the critical path to the end of sub-loops in the loop
         Func_BlockVisited.clear();
-        state_total += getFunctionStageNum(origin_path_in_F, &F, Func_Entry);
+        state_total += getFunctionStageNum(origin_path_in_F, stageF, Func_Entry);
     }
+    setClock(design_clock_period_str);
     return state_total + 2; // TODO: check +2 is for function or module (reset/idle)
 }
 
@@ -16,10 +16,21 @@
 #define Strict_LoadStore_Thredhold 3.25
 #define Strict_CertaintyRatio (7.0 / 8.0)
 
+// the cycles of the two-flop synchronizers for the handshake between two clock domains
+#define ClockDomainSync_Latency 2
+
 #include "ClockInfo.h"
+#include "HI_AliasCache.h"
+#include "HI_HLSLibrary.h"
 #include "HI_InstructionFiles.h"
+#include "HI_InstructionIndex.h"
+#include "HI_ModuloReservationTable.h"
+#include "HI_ModuloScheduler.h"
+#include "HI_PortOccupancy.h"
+#include "HI_RecurrenceGraph.h"
 #include "HI_StringProcess.h"
 #include "HI_print.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/LoopAccessAnalysis.h"
@@ -340,6 +351,21 @@ class HI_DesignConfigInfo
             functionName, std::pair<std::string, bool>(arrayName, enable)));
     }
 
+    // the function is evaluated at the clock period of its clock domain instead of the design
+    // clock, e.g. clock_domain function=f period=5
+    void insertClockDomain(std::string functionName, std::string period_str)
+    {
+        for (auto &domain_pair : clockDomainConfigs)
+        {
+            if (domain_pair.first == functionName)
+            {
+                domain_pair.second = period_str;
+                return;
+            }
+        }
+        clockDomainConfigs.push_back(std::pair<std::string, std::string>(functionName, period_str));
+    }
+
     HI_DesignConfigInfo(const HI_DesignConfigInfo &input)
     {
         clock_period = input.clock_period;
@@ -353,7 +379,10 @@ class HI_DesignConfigInfo
         arrayPortConfigs = input.arrayPortConfigs;
         funcDataflowConfigs = input.funcDataflowConfigs;
         localArrayConfigs = input.localArrayConfigs;
+        clockDomainConfigs = input.clockDomainConfigs;
         HLS_lib_path = input.HLS_lib_path;
+        moduloScheduling = input.moduloScheduling;
+        DSPLimit = input.DSPLimit;
     }
 
     HI_DesignConfigInfo &operator=(const HI_DesignConfigInfo &input)
@@ -369,7 +398,10 @@ class HI_DesignConfigInfo
         arrayPortConfigs = input.arrayPortConfigs;
         funcDataflowConfigs = input.funcDataflowConfigs;
         localArrayConfigs = input.localArrayConfigs;
+        clockDomainConfigs = input.clockDomainConfigs;
         HLS_lib_path = input.HLS_lib_path;
+        moduloScheduling = input.moduloScheduling;
+        DSPLimit = input.DSPLimit;
     }
 
     double clock_period;
@@ -385,7 +417,15 @@ class HI_DesignConfigInfo
     std::vector<std::pair<std::string, std::pair<std::string, bool>>> localArrayConfigs;
     std::vector<std::pair<std::string, std::pair<std::string, int>>> arrayPortConfigs;
     std::vector<std::pair<std::string, bool>> funcDataflowConfigs;
+    std::vector<std::pair<std::string, std::string>> clockDomainConfigs;
     std::map<std::string, int> LoopLabel2UnrollFactor;
+
+    // evaluate the pipelined loops with the iterative modulo scheduler
+    // (loop_pipeline_scheduler = modulo), otherwise the II is estimated by the heuristic checks
+    bool moduloScheduling = false;
+
+    // the DSPs available to the modulo scheduler (resource_limit DSP=N), -1 if unlimited
+    int DSPLimit = -1;
 };
 
 raw_ostream &operator<<(raw_ostream &stream, const HI_DesignConfigInfo &tb);
@@ -451,10 +491,6 @@ class inst_timing_resource_info
     }
 };
 
-// For each type of instruction, there will be a list to store a series of information corresponding
-// to different parameters
-typedef std::map<int, std::map<int, std::map<std::string, inst_timing_resource_info>>>
-    Info_type_list;
 #endif
 
 // Pass for simple evluation of the latency of the top function, without considering HLS directives
@@ -472,12 +508,12 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         std::map<std::string, int> &LoopLabel2UnrollFactor,
         std::map<std::string, int> &FuncParamLine2OutermostSize,
         std::map<std::string, std::vector<int>> &IRFunc2BeginLine,
-        std::map<std::string, Info_type_list> &BiOp_Info_name2list_map, bool DEBUG = 0)
+        const HI_HLSLibTable &HLSLibTable, bool DEBUG = 0, const char *FF_log_name = "FF_LOG")
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel),
           IRLoop2OriginTripCount(IRLoop2OriginTripCount), LoopLabel2II(LoopLabel2II),
           LoopLabel2UnrollFactor(LoopLabel2UnrollFactor),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
-          IRFunc2BeginLine(IRFunc2BeginLine), BiOp_Info_name2list_map(BiOp_Info_name2list_map),
+          IRFunc2BeginLine(IRFunc2BeginLine), HLSLibTable(&HLSLibTable),
           DEBUG(DEBUG)
     {
         BlockEvaluated.clear();
@@ -489,7 +525,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         Evaluating_log = new raw_fd_ostream(evaluating_log_name, ErrInfo, sys::fs::F_None);
         BRAM_log = new raw_fd_ostream(BRAM_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        FF_log = new raw_fd_ostream("FF_LOG", ErrInfo, sys::fs::F_None);
+        FF_log = new raw_fd_ostream(FF_log_name, ErrInfo, sys::fs::F_None);
         ArrayLog = new raw_fd_ostream(ArrayLog_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         Parse_Config_fromFile();
@@ -509,12 +545,12 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         std::map<std::string, int> &LoopLabel2UnrollFactor,
         std::map<std::string, int> &FuncParamLine2OutermostSize,
         std::map<std::string, std::vector<int>> &IRFunc2BeginLine,
-        std::map<std::string, Info_type_list> &BiOp_Info_name2list_map, bool DEBUG = 0)
+        const HI_HLSLibTable &HLSLibTable, bool DEBUG = 0, const char *FF_log_name = "FF_LOG")
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel),
           IRLoop2OriginTripCount(IRLoop2OriginTripCount), LoopLabel2II(LoopLabel2II),
           LoopLabel2UnrollFactor(LoopLabel2UnrollFactor),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
-          IRFunc2BeginLine(IRFunc2BeginLine), BiOp_Info_name2list_map(BiOp_Info_name2list_map),
+          IRFunc2BeginLine(IRFunc2BeginLine), HLSLibTable(&HLSLibTable),
           DEBUG(DEBUG), configInfo(configInfo)
     {
         BlockEvaluated.clear();
@@ -526,7 +562,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         Evaluating_log = new raw_fd_ostream(evaluating_log_name, ErrInfo, sys::fs::F_None);
         BRAM_log = new raw_fd_ostream(BRAM_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        FF_log = new raw_fd_ostream("FF_LOG", ErrInfo, sys::fs::F_None);
+        FF_log = new raw_fd_ostream(FF_log_name, ErrInfo, sys::fs::F_None);
         ArrayLog = new raw_fd_ostream(ArrayLog_name, ErrInfo, sys::fs::F_None);
         Parse_Config(configInfo);
     }
@@ -541,12 +577,12 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         std::map<std::string, int> &LoopLabel2II,
         std::map<std::string, int> &LoopLabel2UnrollFactor,
         std::map<std::string, int> &FuncParamLine2OutermostSize,
-        std::map<std::string, std::vector<int>> &IRFunc2BeginLine, bool DEBUG = 0)
+        std::map<std::string, std::vector<int>> &IRFunc2BeginLine, bool DEBUG = 0,
+        const char *FF_log_name = "FF_LOG")
         : ModulePass(ID), IRLoop2LoopLabel(IRLoop2LoopLabel), LoopLabel2II(LoopLabel2II),
           LoopLabel2UnrollFactor(LoopLabel2UnrollFactor),
           FuncParamLine2OutermostSize(FuncParamLine2OutermostSize),
-          IRFunc2BeginLine(IRFunc2BeginLine),
-          BiOp_Info_name2list_map(this->BiOp_Info_name2list_map_contain), DEBUG(DEBUG)
+          IRFunc2BeginLine(IRFunc2BeginLine), HLSLibTable(nullptr), DEBUG(DEBUG)
     {
         BlockEvaluated.clear();
         LoopEvaluated.clear();
@@ -557,7 +593,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         Evaluating_log = new raw_fd_ostream(evaluating_log_name, ErrInfo, sys::fs::F_None);
         BRAM_log = new raw_fd_ostream(BRAM_log_name, ErrInfo, sys::fs::F_None);
         top_function_name = std::string(top_function);
-        FF_log = new raw_fd_ostream("FF_LOG", ErrInfo, sys::fs::F_None);
+        FF_log = new raw_fd_ostream(FF_log_name, ErrInfo, sys::fs::F_None);
         ArrayLog = new raw_fd_ostream(ArrayLog_name, ErrInfo, sys::fs::F_None);
         // get the configureation from the file, e.g. clock period
         Parse_Config_fromFile();
@@ -603,6 +639,9 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         Func_BlockEvaluated.clear();
         LoopEvaluated.clear();
         FunctionEvaluated.clear();
+        StructureHash2EvaluatedFunctions.clear();
+        Function2Representative.clear();
+        Function2PartitionCnt.clear();
         InstructionEvaluated.clear();
         BlockVisited.clear();
         Func_BlockVisited.clear();
@@ -614,7 +653,6 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         tmp_LoopCriticalPath_inFunc.clear();
         tmp_BlockCriticalPath_inLoop.clear();
         tmp_SubLoop_CriticalPath.clear();
-        InstructionCriticalPath_inBlock.clear();
         FuncName2LoopIRNames.clear();
 
         return false;
@@ -670,11 +708,15 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     std::map<Loop *, int> Loop_id;
 
+    // the dense IDs of the instructions and blocks in the module, the per-instruction, per-block
+    // and per-loop (by the loop header) state below is stored in the columns indexed by them
+    HI_InstructionIndex InstIndex;
+
     // the latency of each loop
-    std::map<BasicBlock *, timingBase> LoopLatency;
+    HI_BlockColumn<timingBase> LoopLatency{InstIndex};
 
     // the latency of each block
-    std::map<BasicBlock *, timingBase> BlockLatency;
+    HI_BlockColumn<timingBase> BlockLatency{InstIndex};
 
     // the latency of each function
     std::map<Function *, timingBase> FunctionLatency;
@@ -683,10 +725,10 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     std::map<std::string, timingBase> FuncName2Latency;
 
     // the resource of each loop
-    std::map<BasicBlock *, resourceBase> LoopResource;
+    HI_BlockColumn<resourceBase> LoopResource{InstIndex};
 
     // the resource of each block
-    std::map<BasicBlock *, resourceBase> BlockResource;
+    HI_BlockColumn<resourceBase> BlockResource{InstIndex};
 
     // the resource of each function
     std::map<Function *, resourceBase> FunctionResource;
@@ -695,10 +737,15 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     std::map<std::string, resourceBase> FuncName2Resource;
 
     // record whether the component is evaluated
-    std::set<BasicBlock *> BlockEvaluated;
+    HI_BlockSet BlockEvaluated{InstIndex};
     std::set<BasicBlock *> Func_BlockEvaluated;
-    std::set<BasicBlock *> LoopEvaluated;
+    HI_BlockSet LoopEvaluated{InstIndex};
     std::set<Function *> FunctionEvaluated;
+
+    // the evaluated functions bucketed by their structure hashes, and the representative of each
+    // function sharing the evaluation of an identical one
+    std::map<size_t, std::vector<Function *>> StructureHash2EvaluatedFunctions;
+    std::map<Function *, Function *> Function2Representative;
     std::set<Instruction *> InstructionEvaluated;
     std::set<Value *> Value_FFAssigned;
     std::set<BasicBlock *> BlockVisited;
@@ -731,13 +778,13 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     // record which evaluated loop the block is belong to, so the pass can directly trace to the
     // loop for the latency
-    std::map<BasicBlock *, Loop *> Block2EvaluatedLoop;
+    HI_BlockColumn<Loop *> Block2EvaluatedLoop{InstIndex};
 
     // record the critical path from the loop header to the end of the specific block
     std::map<Loop *, std::map<BasicBlock *, timingBase>> BlockCriticalPath_inLoop;
 
     // record the critical path from the loop header to the beginning of the specific block
-    std::map<BasicBlock *, timingBase> BlockBegin_inLoop;
+    HI_BlockColumn<timingBase> BlockBegin_inLoop{InstIndex};
 
     // record the critical path to the end of block in the function
     std::map<BasicBlock *, timingBase> tmp_BlockCriticalPath_inFunc;
@@ -752,25 +799,28 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     std::map<Loop *, timingBase> tmp_SubLoop_CriticalPath;
 
     // for II evaluation, check the instruction time slot
-    std::map<Instruction *, int> Inst2TimeSlotInLoop;
+    HI_InstColumn<int> Inst2TimeSlotInLoop{InstIndex};
 
     // the CP for each iteration of the loop
-    std::map<BasicBlock *, int> Loop2CP;
+    HI_BlockColumn<int> Loop2CP{InstIndex};
 
     // record the critical path from the block entry to the end of the specific instruction
-    std::map<BasicBlock *, std::map<Instruction *, timingBase>> InstructionCriticalPath_inBlock;
+    HI_InstColumn<timingBase> InstructionCriticalPath_inBlock{InstIndex};
 
-    // Instruction Schedule
-    std::map<Instruction *, std::pair<BasicBlock *, int>> Inst_Schedule;
+    // Instruction Schedule: the cycle in its block where the instruction is scheduled
+    HI_InstColumn<int> Inst_Schedule{InstIndex};
 
     // record the latest operand of each instruction
-    std::map<Instruction *, Instruction *> Inst2LatestOperand;
+    HI_InstColumn<Instruction *> Inst2LatestOperand{InstIndex};
 
     // record when the register for the result of Instruction can be release
-    std::map<Instruction *, std::pair<BasicBlock *, int>> RegRelease_Schedule;
+    HI_InstColumn<std::pair<BasicBlock *, int>> RegRelease_Schedule{InstIndex};
 
     // record whether the result reg of the instruction I has been reused
-    std::set<Instruction *> I_RegReused;
+    HI_InstSet I_RegReused{InstIndex};
+
+    // number the instructions and blocks in the module and reset the state in the columns
+    void initInstructionState(Module &M);
 
     // Instruction related to target
     std::map<Value *, std::set<Value *>> Value2Target;
@@ -779,8 +829,9 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     std::map<std::pair<Value *, partition_info>, std::vector<std::pair<BasicBlock *, int>>>
         targetPartition2BlockCycleAccessCnt;
 
-    // an intermediate set for II evaluation recording which partitions will be accessed in a loop
-    std::set<std::pair<Value *, partition_info>> accessPartitionsForIITest;
+    // an intermediate map for II evaluation recording the modulo reservation tables of the
+    // partitions accessed in a loop
+    std::map<std::pair<Value *, partition_info>, HI_ModuloReservationTable> accessMRTsForIITest;
 
     // record the access property of the target in function
     enum accessPropertyType
@@ -795,18 +846,16 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     void updateAccessProperty_Function(std::pair<Value *, Function *> val_func_pair,
                                        accessPropertyType updateTy);
 
-    std::map<BasicBlock *, timingBase> Loop2IterationLatency;
-    std::map<BasicBlock *, int> Loop2AchievedII;
+    HI_BlockColumn<timingBase> Loop2IterationLatency{InstIndex};
+    HI_BlockColumn<int> Loop2AchievedII{InstIndex};
     std::map<std::string, int> LoopLabel2AchievedII;
 
+    // the pipeline depth found by the modulo scheduler, i.e. the cycles of an iteration
+    HI_BlockColumn<int> Loop2PipelineDepth{InstIndex};
+
     // check whether the two instructions have the same access targets
     bool hasSameTargets(Instruction *I0, Instruction *I1);
 
-    // among the scheduled instructions, find the latest access to the specific target
-    Instruction *
-    findLatestPointerAccess(Instruction *curI, std::set<Value *> targets,
-                            std::map<Instruction *, timingBase> &cur_InstructionCriticalPath);
-
     // // demangle the name of functions
     // std::string demangleFunctionName(std::string mangled_name);
 
@@ -845,11 +894,9 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // get the number of stage in the block
     int getStageNumOfBlock(BasicBlock *B);
 
-    // get the function critical path by traversing the blocks based on DFS and compute the resource
-    // cost
-    void analyzeFunction_traverseFromEntryToExiting(timingBase tmp_critical_path, Function *F,
-                                                    BasicBlock *curBlock,
-                                                    resourceBase &resourceAccumulator);
+    // get the critical paths in the function by traversing the blocks/outer loops in topological
+    // order and compute the resource cost
+    void analyzeFunction_longestPath(Function *F, resourceBase &resourceAccumulator);
 
     // analyze the access property of the targets in the function
     void accessPropertyAnalysis_Function(Function *F);
@@ -865,26 +912,130 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // check whether the array is specified as local array in dataflow, (unchanged during dataflow)
     bool isLocalArray(Value *target);
 
-    // get the loop latency by traversing from the header to the exiting blocks and evluation
-    // resource
-    void LoopLatencyResourceEvaluation_traversFromHeaderToExitingBlocks(
-        timingBase tmp_critical_path, Loop *L, BasicBlock *curBlock,
-        resourceBase &resourceAccumulator);
+    // get the clock period of the clock domain of the function, i.e. the design clock unless the
+    // function is assigned to another domain (clock_domain function=f period=5)
+    std::string getFunctionClockStr(Function *F);
+
+    // set the clock of the evaluation, which is used by the timing/resource lookups
+    void setClock(std::string period_str);
+
+    // convert the timing of a sub-function in its clock domain into the cycles of the clock
+    // domain of the caller, with the synchronization if the domains are different
+    timingBase convertClockDomain(timingBase calleeTiming, Function *callerF);
+
+    // get the hash of the structure of the function, i.e. the operations in its blocks and the
+    // sub-functions it calls (represented by their representatives), so the instances of a
+    // function cloned by HI_FunctionInstantiation get the same hash
+    size_t getFunctionStructureHash(Function *F);
+
+    // get the representative of the function, which it shares the evaluation with, or itself
+    Function *getRepresentativeFunction(Function *F);
+
+    // check whether F is identical to the evaluated function rep, including the partitions of the
+    // arrays accessed via their arguments, and map the targets accessed by rep to the ones of F
+    bool isFunctionIdenticalTo(Function *F, Function *rep,
+                               std::map<Value *, Value *> &target2Target);
+
+    // find an evaluated function identical to F, which F can share the evaluation with
+    Function *findIdenticalEvaluatedFunction(Function *F,
+                                             std::map<Value *, Value *> &target2Target);
+
+    // evaluate F by the evaluation of the identical function rep, while the states related to the
+    // accesses in F (e.g. the partitions they access) are recorded for F itself
+    void shareFunctionEvaluation(Function *F, Function *rep,
+                                 std::map<Value *, Value *> &target2Target);
+
+    // A process of a dataflow function, i.e. a call of a sub-function
+    struct DataflowProcess
+    {
+        CallInst *callI;
+        int latency;  // the latency of an invocation
+        int interval; // the interval between the invocations
+        int start;    // the start of the first invocation
+        int finish;   // the finish of the first invocation
+        std::vector<Value *> targets;
+    };
+
+    // A channel of the target array from the producer process to the consumer process, which is
+    // a FIFO if the array is streamed, otherwise a ping-pong buffer
+    struct DataflowChannel
+    {
+        Value *target;
+        int producer; // the index of the process
+        int consumer;
+        bool isFIFO;
+        int depth; // the depth of the FIFO
+    };
+
+    // get the processes (calls) in the block of the dataflow function and the channels between
+    // them
+    void getDataflowProcessesAndChannels(Function *F, BasicBlock *blockforcallIs,
+                                         std::vector<DataflowProcess> &processes,
+                                         std::vector<DataflowChannel> &channels);
+
+    // schedule the first invocation of each process, overlapped by the channels in the dataflow
+    // or ordered by the shared targets sequentially, and return the latency of the processes
+    int scheduleDataflowProcesses(std::vector<DataflowProcess> &processes,
+                                  const std::vector<DataflowChannel> &channels, bool dataflow);
+
+    // check whether the only access to the target in the function is a load (or store) visiting
+    // each element once in the increasing order of the offset
+    bool isStreamingAccess(Function *F, Value *target, bool isWrite);
+
+    // get the bitwidth of the elements of the target array
+    int getElementBitWidth(Value *target);
+
+    // get the resource of a FIFO with the specific width and depth
+    resourceBase getFIFOResource(int width, int depth);
+
+    // report the slowest library clock of each process which keeps the steady-state II of the
+    // dataflow function, i.e. only the bottleneck process needs a faster clock for a higher
+    // throughput
+    void reportDataflowClockAssignment(Function *F, const std::vector<DataflowProcess> &processes,
+                                       int bottleneck);
+
+    // get the critical paths in the loop body by traversing the blocks/sub-loops in topological
+    // order and evaluate the resource
+    void LoopLatencyResourceEvaluation_longestPath(Loop *L, resourceBase &resourceAccumulator);
 
     // get the II factor for loop pipelining, if there is directives of pipeline for this loop
     int checkIIForLoop(Loop *curLoop,
                        std::map<BasicBlock *, timingBase> &tmp_BlockCriticalPath_inLoop);
 
-    // the BRAM-related II for the loop
+    // the BRAM-related MII for the loop, i.e. the resource-constrained MII of the modulo
+    // reservation tables of the accessed partitions, which are built here
     int checkAccessIIForLoop(Loop *curLoop);
 
-    // check the BRAM-related II for the loop by enumerating II and checking port constraint for
-    // each cycle for each partition
-    int checkAccessIIForLoop_enumerateCheck(Loop *curLoop);
+    // the minimum II valid for the scheduled accesses in the loop, checked with the modulo
+    // reservation tables built by checkAccessIIForLoop, -1 if none
+    int checkAccessIIForLoop_scheduled(Loop *curLoop);
 
     // the Dependence-related II for the loop
     int checkDependenceIIForLoop(Loop *curLoop);
 
+    // a dependence between the instructions in the dependence graph of a loop
+    struct LoopDependenceEdge
+    {
+        int from;
+        int to;
+        int delay;    // the cycles from the beginning of the source to the beginning of the sink
+        int distance; // the number of iterations crossed
+    };
+
+    // build the dependence graph of the scheduled instructions in the loop from the SSA uses, the
+    // header PHIs and InstInst2DependenceDistance
+    void getLoopDependenceGraph(Loop *curLoop, std::vector<Instruction *> &ops,
+                                std::vector<int> &opLatency,
+                                std::vector<LoopDependenceEdge> &edges);
+
+    // the recurrence-constrained II for the loop, i.e. the maximum cycle ratio of the dependence
+    // graph
+    int checkRecurrenceIIForLoop(Loop *curLoop);
+
+    // schedule the pipelined loop with the iterative modulo scheduler from minII, return the
+    // achieved II (-1 if none), the pipeline depth and the resource of each stage are recorded
+    int moduloScheduleLoop(Loop *curLoop, int minII);
+
     // find the earliest user of the load instruction (maybe for reschedule)
     int findEarlietUseTimeInTheLoop(Loop *curLoop, Instruction *R_I);
 
@@ -917,9 +1068,8 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // each FP opcode among block.
     resourceBase costRescheduleFPDSPOperators_forFunction(Function *F);
 
-    // mark the block in loop with latency by traversing from the header to the exiting blocks
-    void MarkBlock_traversFromHeaderToExitingBlocks(timingBase total_latency, Loop *L,
-                                                    BasicBlock *curBlock);
+    // mark the blocks in the loop, so later processing can regard the loop as an integration
+    void MarkBlock_inLoop(Loop *L);
 
     // evaluate the block latency and resource by traversing the instructions
     timingBase BlockLatencyResourceEvaluation(BasicBlock *B);
@@ -974,6 +1124,10 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     std::string clock_period_str = "10.0";
 
+    // the clock of the design, while clock_period/clock_period_str are the clock of the domain
+    // of the function under evaluation
+    std::string design_clock_period_str = "10.0";
+
     std::string HLS_lib_path = "";
     ////////////////////////////////////////////////////////////////////////////////////////////////////
     //////////////////// Declaration related to timing and resource of instructions
@@ -1255,10 +1409,52 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     resourceBase topFunction_resource; // = resourceBase();
 
-    // A map from opcode to the information list of timing and resource
-    std::map<std::string, Info_type_list> &BiOp_Info_name2list_map;
+    // A node in the DAG of a function/loop body for the critical path analysis, i.e. a block or a
+    // (sub-)loop regarded as an integration
+    struct CriticalPathNode
+    {
+        BasicBlock *B; // the block, or the header of the loop
+        Loop *L;       // nullptr for a block
+        timingBase latency;
+        timingBase begin; // the critical path to the beginning of the node
+        timingBase end;   // the critical path to the end of the node
+        std::vector<int> succs;
+    };
+
+    // get the critical paths to the nodes in the function F (curLoop == nullptr, the most outer
+    // loops are nodes) or in the body of curLoop (the evaluated sub-loops are nodes) in O(V+E)
+    // and accumulate their resource
+    void getCriticalPathNodes(Function *F, Loop *curLoop, resourceBase &resourceAccumulator,
+                              std::vector<CriticalPathNode> &nodes);
+
+    // The table of timing and resource information indexed by opcode, bitwidths and clock period
+    // (read-only, since it could be shared by several evaluators)
+    const HI_HLSLibTable *HLSLibTable;
+
+    std::unique_ptr<HI_HLSLibTable> HLSLibTable_contain;
+
+    // the ID of the clock period of the evaluation and the IDs of the opcodes in HLSLibTable. They
+    // are resolved once (the clock ID whenever the clock domain changes, see setClock), so the
+    // instructions are looked up by (opcode ID, bitwidths, clock ID) without any string.
+    int clock_period_ID = -1;
+    std::vector<int> instOpcode2LibID;
+    std::vector<int> doubleInstOpcode2LibID;
+    int taddLibID = -1;
+
+    // resolve the IDs of the opcodes of the LLVM instructions in HLSLibTable
+    void resolveHLSLibOpcodeIDs();
 
-    std::map<std::string, Info_type_list> BiOp_Info_name2list_map_contain;
+    // the ID in HLSLibTable of an LLVM instruction opcode, e.g. Instruction::FAdd, where the
+    // floating-point operations on double values have their own entries, e.g. dadd
+    int getLibOpcodeID(unsigned instOpcode, bool isDouble = false) const
+    {
+        return isDouble ? doubleInstOpcode2LibID[instOpcode] : instOpcode2LibID[instOpcode];
+    }
+
+    // get the record of a specific instruction, based on its opcode ID, operand_bitwidth,
+    // result_bitwidth and clock ID
+    const HI_HLSLibRecord &getInstRecord(int opcodeID, int operand_bitwid, int res_bitwidth,
+                                         int clockID);
 
     // get the information of a specific instruction, based on its opcode, operand_bitwidth,
     // result_bitwidth and clock period
@@ -1266,14 +1462,14 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
                                             int res_bitwidth, std::string period);
 
     // Organize the information into timingBase after getting the information of a specific
-    // instruction, based on its opcode, operand_bitwidth, result_bitwidth and clock period.
-    timingBase get_inst_TimingInfo_result(std::string opcode, int operand_bitwid, int res_bitwidth,
-                                          std::string period);
+    // instruction, based on its opcode ID, operand_bitwidth, result_bitwidth and clock ID.
+    timingBase get_inst_TimingInfo_result(int opcodeID, int operand_bitwid, int res_bitwidth,
+                                          int clockID);
 
     // Organize the information into resourceBase after getting the information of a specific
-    // instruction, based on its opcode, operand_bitwidth, result_bitwidth and clock period.
-    resourceBase get_inst_ResourceInfo_result(std::string opcode, int operand_bitwid,
-                                              int res_bitwidth, std::string period);
+    // instruction, based on its opcode ID, operand_bitwidth, result_bitwidth and clock ID.
+    resourceBase get_inst_ResourceInfo_result(int opcodeID, int operand_bitwid, int res_bitwidth,
+                                              int clockID);
 
     // int get_N_DSP(std::string opcode, int operand_bitwid , int res_bitwidth, std::string period);
     // int get_N_FF(std::string opcode, int operand_bitwid , int res_bitwidth, std::string period);
@@ -1283,7 +1479,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // period);
 
     // evaluate the number of FF needed by the instruction
-    resourceBase FF_Evaluate(std::map<Instruction *, timingBase> &cur_InstructionCriticalPath,
+    resourceBase FF_Evaluate(HI_BlockInstView<timingBase> &cur_InstructionCriticalPath,
                              Instruction *cur_I);
 
     // trace back to find the original operator, bypassing SExt and ZExt operations
@@ -1294,21 +1490,11 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     Value *byPassBitcastOp(Value *cur_I_val);
 
     // evaluate the number of LUT needed by the PHI instruction
-    resourceBase IndexVar_LUT(std::map<Instruction *, timingBase> &cur_InstructionCriticalPath,
+    resourceBase IndexVar_LUT(HI_BlockInstView<timingBase> &cur_InstructionCriticalPath,
                               Instruction *I);
 
-    // check whether a specific information is in the database
-    bool checkInfoAvailability(std::string opcode, int operand_bitwid, int res_bitwidth,
-                               std::string period);
-
-    // check whether we can infer the information by increasing the clock frequency
-    bool checkFreqProblem(std::string opcode, int operand_bitwid, int res_bitwidth,
-                          std::string period);
-
-    // if the information is not found in database, we may infer the information by increasing the
-    // clock frequency
-    inst_timing_resource_info checkInfo_HigherFreq(std::string opcode, int operand_bitwid,
-                                                   int res_bitwidth, std::string period);
+    // check whether a specific information is characterized in the database
+    bool checkInfoAvailability(int opcodeID, int operand_bitwid, int res_bitwidth, int clockID);
 
     // Trace back to get the bitwidth of an operand, bypassing truct/zext/sext
     int getOriginalBitwidth(Value *Val);
@@ -1371,6 +1557,10 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     std::map<std::pair<Instruction *, std::pair<Value *, partition_info>>, timingBase>
         scheduledAccess_timing;
 
+    // record the port occupancy of the partitions of the targets in the cycles of the blocks
+    std::map<std::pair<Value *, partition_info>, std::map<BasicBlock *, HI_PortOccupancy>>
+        targetPartition2BlockOccupancy;
+
     // record the access take place in which cycle
     std::map<BasicBlock *, std::map<std::pair<Value *, partition_info>, int>> accessCounterForBlock;
 
@@ -1386,6 +1576,9 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     std::map<std::pair<Instruction *, Instruction *>, int> InstInst2DependenceDistance;
 
+    // the memoized constant differences between the addresses of the accesses
+    HI_AliasCache AliasCache;
+
     // Trace Memory Declaration in Module
     // analyze BRAM accesses in the module before any other analysis
     void TraceMemoryDeclarationAndAnalyzeAccessinModule(llvm::Module &M);
@@ -1431,6 +1624,10 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     timingBase handleBRAMAccessFor(Instruction *access, Value *target, BasicBlock *cur_block,
                                    timingBase cur_Timing, partition_info target_partition);
 
+    // get the port occupancy of the partition of the target in the block
+    HI_PortOccupancy &getPortOccupancy(Value *target, BasicBlock *cur_block,
+                                       partition_info target_partition);
+
     // record the schedule information
     void insertBRAMAccessInfo(Value *target, BasicBlock *cur_block, int cur_latency,
                               Instruction *access, partition_info target_partition);
@@ -1521,9 +1718,29 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     void getAllPotentialOffsetByRecuresiveSearch(HI_AccessInfo &accessInfo, int loopDep,
                                                  int last_level_offset, std::vector<int> &res);
 
+    // get the partitions reachable by a predictable access and whether its offsets
+    // increase/decrease by one, in closed form from the initial offset, increments and trip counts
+    // of the loops. false is returned if the access does not fit and the offsets should be
+    // enumerated.
+    bool getPartitionsInClosedForm(HI_AccessInfo &info, std::vector<partition_info> &partitions,
+                                   bool &incByOne, bool &decByOne);
+
+    // get the partitions reachable by a predictable access and whether its offsets
+    // increase/decrease by one, by emulating the loops to enumerate the offsets
+    void getPartitionsByEnumeration(HI_AccessInfo &info, std::vector<partition_info> &partitions,
+                                    bool &incByOne, bool &decByOne);
+
+    // check whether the partitions of the access in closed form are the same as the enumerated
+    // ones. true is returned if they are the same or the closed form does not fit the access.
+    bool checkPartitionsInClosedForm(HI_AccessInfo &info);
+
     // get all the partitions for the access target of the access instruction
     std::vector<partition_info> getAllPartitionFor(Instruction *access);
 
+    // get the partitions which the access may visit, i.e. the predicted partitions, or all the
+    // partitions if the access pattern is unpredictable
+    std::vector<partition_info> getTargetPartitionsForAccess(Instruction *access);
+
     // get all the partitions for the access target of the access instruction
     void getAllPartitionBasedOnInfo(HI_AccessInfo &info, int curDim, std::vector<int> &tmp_partID,
                                     std::vector<partition_info> &res);
@@ -1531,6 +1748,11 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // check whether the two SCEV have const distance
     Optional<APInt> computeConstantDifference(const SCEV *More, const SCEV *Less);
 
+    // the constant distance between the addresses (S0/S1) of the two accesses, which is memoized
+    // in AliasCache
+    Optional<int64_t> getAddressDifference(Instruction *I0, Instruction *I1, const SCEV *S0,
+                                           const SCEV *S1);
+
     // check whether the two instructions have loop carried dependence
     // if there is such dependence, record the distance in InstInst2DependenceDistance
     void checkLoopCarriedDependent(Instruction *I0, Instruction *I1, Loop *curLoop);
@@ -1802,7 +2024,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
             target = nullptr;
         }
 
-        partition_info operator=(const partition_info &input)
+        partition_info &operator=(const partition_info &input)
         {
             assert(input.target);
             target = input.target;
@@ -1810,6 +2032,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
             port_num = input.port_num;
             for (int i = 0; i < num_dims; i++)
                 partition_id[i] = input.partition_id[i];
+            return *this;
         }
 
         partition_info(const partition_info &input)
@@ -1848,6 +2071,7 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
         }
         stream << tb.partition_id[0] << "]   port_num=";
         stream << tb.port_num << " ";
+        return stream;
     }
 
     friend raw_ostream &operator<<(raw_ostream &stream, const HI_ArrayInfo &tb)
@@ -1955,6 +2179,10 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
 
     std::map<partition_info, std::pair<int, int>> partition2cnt;
 
+    // the accesses of the function to the partitions, recorded by insertBRAMAccessInfo, which are
+    // counted again for the functions sharing its evaluation
+    std::map<Function *, std::map<partition_info, std::pair<int, int>>> Function2PartitionCnt;
+
     // record the array informtiion
     std::map<Value *, HI_ArrayInfo> Target2ArrayInfo;
 
@@ -2354,6 +2582,12 @@ class HI_WithDirectiveTimingResourceEvaluation : public ModulePass
     // parse the argument for loop pipelining
     void parseLoopPipeline(std::stringstream &iss, HI_DesignConfigInfo &desginconfig);
 
+    // parse the argument for resource limitation
+    void parseResourceLimit(std::stringstream &iss, HI_DesignConfigInfo &desginconfig);
+
+    // parse the argument for the clock domain of a function
+    void parseClockDomain(std::stringstream &iss, HI_DesignConfigInfo &desginconfig);
+
     // match the configuration and the corresponding declaration of memory (array)
     void matchArrayAndConfiguration(Value *target, HI_ArrayInfo &resArrayInfo);
 
@@ -30,7 +30,7 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
     if (DEBUG)
         *Evaluating_log << "---- Evaluating Block Latency for Block: " << B->getName() << ":\n";
 
-    if (BlockLatency.find(B) != BlockLatency.end())
+    if (BlockLatency.count(B))
     {
         if (DEBUG)
             *Evaluating_log << "---- Done evaluation of Block Latency for Block: " << B->getName()
@@ -39,7 +39,11 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
     }
 
     // A container records the critical path from the block entry to specific instruction
-    std::map<Instruction *, timingBase> cur_InstructionCriticalPath;
+    HI_BlockInstView<timingBase> cur_InstructionCriticalPath(InstructionCriticalPath_inBlock,
+                                                             InstIndex, B);
+
+    // the latest access (Load/Store/Call) among the evaluated instructions, to any target
+    Instruction *latestAccess = nullptr;
 
     // initialize the timing and resource statistics
     timingBase max_critical_path(0, 0, 1, clock_period);
@@ -50,11 +54,15 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
     // (1) iterate the instructions in the block
     if (B->getInstList().size() > 1) // ignore block with only branch instruction
     {
-        for (Instruction &rI : *B)
+        // the instructions and their operands are walked by their IDs, so the state in the columns
+        // is accessed without hashing the pointers
+        for (int ID = cur_InstructionCriticalPath.getBeginID(),
+                 endID = cur_InstructionCriticalPath.getEndID();
+             ID < endID; ID++)
         {
-            Instruction *I = &rI;
+            Instruction *I = InstIndex.getInst(ID);
             timingBase tmp_I_latency = getInstructionLatency(I);
-            cur_InstructionCriticalPath[I] = origin_path + tmp_I_latency;
+            cur_InstructionCriticalPath[ID] = origin_path + tmp_I_latency;
             bool Chained = 0;
             bool PartialChained = 0;
 
@@ -68,18 +76,21 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
             timingBase partialChainedTiming;
             resourceBase partialChainedResource;
 
+            // the pointers in the operands of the access, by which the targets are accessed
+            std::vector<Value *> ptrInOperands;
+
             // for general instructions, we find the latest-finished operand of them
-            for (User::op_iterator I_tmp = I->op_begin(), I_Pred_end = I->op_end();
-                 I_tmp != I_Pred_end; ++I_tmp) // update the critical path to I by checking its
-                                               // predecessors' critical path
+            // update the critical path to I by checking its predecessors' critical path
+            for (unsigned op = 0, opNum = I->getNumOperands(); op < opNum; op++)
             {
-                if (auto I_Pred = dyn_cast<Instruction>(I_tmp))
+                int predID = InstIndex.getOperandID(ID, op);
+                if (predID >= 0)
                 {
+                    Instruction *I_Pred = InstIndex.getInst(predID);
                     // (1) ensure that the predecessor is in the block and before I
                     // (2) considering that some predecessors may be located behind the instruction
                     // itself (not in cur_InstructionCriticalPath yet) in some loop structures
-                    if (BlockContain(B, I_Pred) && cur_InstructionCriticalPath.find(I_Pred) !=
-                                                       cur_InstructionCriticalPath.end())
+                    if (cur_InstructionCriticalPath.count(predID))
                     {
                         if (I->getOpcode() == Instruction::Add ||
                             I->getOpcode() == Instruction::Sub)
@@ -101,14 +112,14 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                             // TODO: maybe we need to rethink the machanism carefully
                             // *Evaluating_log << "        --------- Evaluated Instruction critical
                             // path for Instruction: <<" << *I << " which can be chained.\n";
-                            if (cur_InstructionCriticalPath[I_Pred] >
-                                cur_InstructionCriticalPath[I]) // addition chained with
-                                                                // multiplication
+                            if (cur_InstructionCriticalPath[predID] >
+                                cur_InstructionCriticalPath[ID]) // addition chained with
+                                                                 // multiplication
                             {
-                                cur_InstructionCriticalPath[I] =
-                                    cur_InstructionCriticalPath[I_Pred];
-                                latest_timing = cur_InstructionCriticalPath[I_Pred];
-                                Inst2LatestOperand[I] = I_Pred;
+                                cur_InstructionCriticalPath[ID] =
+                                    cur_InstructionCriticalPath[predID];
+                                latest_timing = cur_InstructionCriticalPath[predID];
+                                Inst2LatestOperand[ID] = I_Pred;
                             }
                             if (DEBUG)
                                 *Evaluating_log << "  " << *I << " is completely chained with "
@@ -120,32 +131,32 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                         {
                             // *Evaluating_log << "        --------- Evaluated Instruction critical
                             // path for Instruction: <<" << *I << " which cannot be chained.\n";
-                            if (cur_InstructionCriticalPath[I_Pred] + tmp_I_latency >=
-                                cur_InstructionCriticalPath[I]) // update the critical path
+                            if (cur_InstructionCriticalPath[predID] + tmp_I_latency >=
+                                cur_InstructionCriticalPath[ID]) // update the critical path
                             {
-                                cur_InstructionCriticalPath[I] =
-                                    cur_InstructionCriticalPath[I_Pred] + tmp_I_latency;
-                                latest_timing = cur_InstructionCriticalPath[I_Pred];
-                                Inst2LatestOperand[I] = I_Pred;
+                                cur_InstructionCriticalPath[ID] =
+                                    cur_InstructionCriticalPath[predID] + tmp_I_latency;
+                                latest_timing = cur_InstructionCriticalPath[predID];
+                                Inst2LatestOperand[ID] = I_Pred;
                             }
                         }
                     }
                 }
             }
 
-            if (Inst2LatestOperand.find(I) != Inst2LatestOperand.end())
+            if (Inst2LatestOperand.count(ID))
             {
-                auto I_Pred = Inst2LatestOperand[I];
+                auto I_Pred = Inst2LatestOperand[ID];
                 // currerntly some adders might be partially chained togather
                 if (canPartitalChainOrNot(
                         I_Pred,
                         I)) //  && (cur_InstructionCriticalPath[I_Pred] + tmp_I_latency).latency ==
                             //  cur_InstructionCriticalPath[I].latency
                 {
-                    cur_InstructionCriticalPath[I] =
+                    cur_InstructionCriticalPath[ID] =
                         cur_InstructionCriticalPath[I_Pred] + getPartialTimingOverhead(I_Pred, I);
                     latest_timing = cur_InstructionCriticalPath[I_Pred];
-                    partialChainedResource = getPartialResourceOverhead(Inst2LatestOperand[I], I);
+                    partialChainedResource = getPartialResourceOverhead(Inst2LatestOperand[ID], I);
                     PartialChained = 1;
                     if (DEBUG)
                         *Evaluating_log << "  " << *I << " is partially chained with " << *I_Pred
@@ -172,6 +183,7 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
             //      XXX = load *ptr_A
             //  the load operands may not include the call instruction but there are implict
             //  dependences.
+            bool isTrackedAccess = false;
             if (I->getOpcode() == Instruction::Load || I->getOpcode() == Instruction::Store ||
                 I->getOpcode() == Instruction::Call)
             {
@@ -185,9 +197,9 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                         bypassAnalysis = true;
                 }
 
+                isTrackedAccess = !bypassAnalysis;
                 if (!bypassAnalysis)
                 {
-                    std::vector<Value *> ptrInOperands;
                     if (DEBUG)
                         *BRAM_log << "   current access :  " << *I << "\n";
                     checkPtrInOperands(I, ptrInOperands);
@@ -203,16 +215,17 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                             *BRAM_log << "\n";
                         }
 
-                        Instruction *latestPointerAccess = findLatestPointerAccess(
-                            I, Value2Target[tmp_ptr], cur_InstructionCriticalPath);
+                        // the dependences are kept conservative: the call is ordered after the
+                        // latest access to any target, and the accesses after the latest call
+                        Instruction *latestPointerAccess =
+                            Value2Target[tmp_ptr].empty() ? nullptr : latestAccess;
                         if (latestPointerAccess)
                         {
                             if (DEBUG)
                                 *BRAM_log
                                     << "           has pointer access :  " << *latestPointerAccess
                                     << "\n";
-                            if (cur_InstructionCriticalPath.find(latestPointerAccess) !=
-                                    cur_InstructionCriticalPath.end() &&
+                            if (cur_InstructionCriticalPath.count(latestPointerAccess) &&
                                 latestPointerAccess != I)
                             {
                                 if (I->getOpcode() != Instruction::Call &&
@@ -221,18 +234,18 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                                     continue;
                                 if (cur_InstructionCriticalPath[latestPointerAccess] +
                                         tmp_I_latency >
-                                    cur_InstructionCriticalPath[I]) // update the critical path
+                                    cur_InstructionCriticalPath[ID]) // update the critical path
                                 {
                                     if (DEBUG)
                                         *BRAM_log << "   current access :  " << *I
                                                   << " limited by previous access: "
                                                   << *latestPointerAccess << "\n";
-                                    cur_InstructionCriticalPath[I] =
+                                    cur_InstructionCriticalPath[ID] =
                                         cur_InstructionCriticalPath[latestPointerAccess] +
                                         tmp_I_latency;
                                     latest_timing =
                                         cur_InstructionCriticalPath[latestPointerAccess];
-                                    Inst2LatestOperand[I] = latestPointerAccess;
+                                    Inst2LatestOperand[ID] = latestPointerAccess;
                                 }
                             }
                         }
@@ -246,23 +259,9 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
             if (I->getOpcode() == Instruction::Load || I->getOpcode() == Instruction::Store)
             {
 
-                HI_AccessInfo cur_access_info = getAccessInfoForAccessInst(I);
-                std::vector<partition_info> target_partitions;
-
-                // obtain the target partitions for the access for the scheduling
-                if (cur_access_info.unpredictable)
-                {
-                    // if the access has unpredictable pattern, schedule the accesses for all the
-                    // partition
-                    target_partitions = getAllPartitionFor(I);
-                    // assert(false && "unfinished.");
-                }
-                else
-                {
-                    // if the access has predictable pattern, schedule the accesses for the
-                    // predicted partitions
-                    target_partitions = getPartitionFor(I);
-                }
+                // obtain the target partitions for the access for the scheduling. If the access
+                // has unpredictable pattern, schedule the accesses for all the partition
+                std::vector<partition_info> target_partitions = getTargetPartitionsForAccess(I);
 
                 checkPartitionBenefit(target_partitions, I);
 
@@ -275,7 +274,7 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                 {
                     if (DEBUG)
                     {
-                        if (Inst2LatestOperand.find(I) != Inst2LatestOperand.end())
+                        if (Inst2LatestOperand.count(ID))
                         {
                             if (DEBUG)
                                 *Evaluating_log
@@ -293,7 +292,7 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                             if (DEBUG)
                                 Evaluating_log->flush();
                             if (DEBUG)
-                                *Evaluating_log << "\n addressI:" << *Inst2LatestOperand[I]
+                                *Evaluating_log << "\n addressI:" << *Inst2LatestOperand[ID]
                                                 << " is ready at " << latest_timing;
                             if (DEBUG)
                                 Evaluating_log->flush();
@@ -338,24 +337,24 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                     if (tmp_schedule > latest_schedule_access)
                         latest_schedule_access = tmp_schedule;
                 }
-                cur_InstructionCriticalPath[I] = latest_schedule_access;
+                cur_InstructionCriticalPath[ID] = latest_schedule_access;
                 AccessesList.push_back(I);
             }
 
             // for the operands in different cycles, we need to insert FFs for them
             // update the lifetime of the predecessors' result registers
             // by keeping updating the latest user of the result of the operand (I_Pred)
-            for (User::op_iterator I_tmp = I->op_begin(), I_Pred_end = I->op_end();
-                 I_tmp != I_Pred_end; ++I_tmp) // update the critical path to I by checking its
-                                               // predecessors' critical path
+            for (unsigned op = 0, opNum = I->getNumOperands(); op < opNum; op++)
             {
-                if (auto I_Pred = dyn_cast<Instruction>(I_tmp))
+                int predID = InstIndex.getOperandID(ID, op);
+                if (predID >= 0)
                 {
+                    Instruction *I_Pred = InstIndex.getInst(predID);
                     // update the latest user of the result of the operand (I_Pred)
                     // so we can know when a result reg can be released (ResultRelease).
                     updateResultRelease(
                         I, I_Pred,
-                        (cur_InstructionCriticalPath[I] - getInstructionLatency(I)).latency);
+                        (cur_InstructionCriticalPath[ID] - getInstructionLatency(I)).latency);
                 }
             }
 
@@ -370,7 +369,7 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
                 }
                 else if (!checkAndTryRecordReuseOperatorDSP(
                              I,
-                             (cur_InstructionCriticalPath[I] - getInstructionLatency(I)).latency))
+                             (cur_InstructionCriticalPath[ID] - getInstructionLatency(I)).latency))
                 {
                     resourceAccmulator = resourceAccmulator + getInstructionResource(I);
                 }
@@ -389,16 +388,24 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
             resourceAccmulator = resourceAccmulator + FF_Num + PHI_LUT_Num;
 
             // record where the instruction is scheduled
-            Inst_Schedule[I] = std::pair<BasicBlock *, int>(
-                B, (cur_InstructionCriticalPath[I] - getInstructionLatency(I)).latency);
+            Inst_Schedule[ID] =
+                (cur_InstructionCriticalPath[ID] - getInstructionLatency(I)).latency;
+
+            // the critical path of the instruction is settled, record it as the latest access if
+            // it finishes later than the recorded one. The evaluation goes in program order, so the
+            // earlier access is kept if both finish at the same time.
+            if (isTrackedAccess &&
+                (!latestAccess ||
+                 cur_InstructionCriticalPath[ID] > cur_InstructionCriticalPath[latestAccess]))
+                latestAccess = I;
 
             // (3) get the maximum CP among instructions and take it as the CP of block
-            if (cur_InstructionCriticalPath[I] > max_critical_path)
-                max_critical_path = cur_InstructionCriticalPath[I];
+            if (cur_InstructionCriticalPath[ID] > max_critical_path)
+                max_critical_path = cur_InstructionCriticalPath[ID];
             if (DEBUG)
                 *Evaluating_log
                     << "--------- Evaluated Instruction critical path for Instruction: <<" << *I
-                    << ">> and its CP is :" << cur_InstructionCriticalPath[I]
+                    << ">> and its CP is :" << cur_InstructionCriticalPath[ID]
                     << " the resource cost is: "
                     << (Chained ? (resourceBase(0, 0, 0, clock_period))
                                 : (PartialChained ? partialChainedResource
@@ -432,15 +439,13 @@ HI_WithDirectiveTimingResourceEvaluation::BlockLatencyResourceEvaluation(BasicBl
         for (Instruction &rI : *B)
         {
             Instruction *I = &rI;
-            Inst_Schedule[I] = std::pair<BasicBlock *, int>(B, 0);
+            Inst_Schedule[I] = 0;
         }
     }
 
     // record the use of the DSP for floating point.
     recordCostRescheduleFPDSPOperators_forBlock(B, max_critical_path.latency);
 
-    InstructionCriticalPath_inBlock[B] = cur_InstructionCriticalPath;
-
     BlockLatency[B] = max_critical_path;
     BlockResource[B] = resourceAccmulator;
     if (DEBUG)
@@ -459,46 +464,6 @@ bool HI_WithDirectiveTimingResourceEvaluation::BlockContain(BasicBlock *B, Instr
     return I->getParent() == B;
 }
 
-// among the scheduled instructions, find the latest access to the specific target
-// excluding the instruction "curI"
-Instruction *HI_WithDirectiveTimingResourceEvaluation::findLatestPointerAccess(
-    Instruction *curI, std::set<Value *> targets,
-    std::map<Instruction *, timingBase> &cur_InstructionCriticalPath)
-{
-    timingBase latest_timing(0, 0, 1, clock_period);
-    Instruction *res_I = nullptr;
-    for (auto target : targets)
-    {
-        for (auto it : cur_InstructionCriticalPath)
-        {
-            if (auto I = dyn_cast<Instruction>(it.first))
-            {
-                if (I == curI)
-                    continue;
-                if (I->getOpcode() == Instruction::Load || I->getOpcode() == Instruction::Store ||
-                    I->getOpcode() == Instruction::Call)
-                {
-                    if (auto callI = dyn_cast<CallInst>(I))
-                    {
-                        if (callI->getCalledFunction()->getName().find("llvm.") !=
-                                std::string::npos ||
-                            callI->getCalledFunction()->getName().find("HIPartitionMux") !=
-                                std::string::npos)
-                            continue;
-                    }
-                    if (it.second > latest_timing)
-                    {
-                        latest_timing = it.second;
-                        res_I = I;
-                    }
-                }
-            }
-        }
-    }
-
-    return res_I;
-}
-
 /*
     get the latency of functions in the path to the instruction
 */
@@ -508,10 +473,11 @@ int HI_WithDirectiveTimingResourceEvaluation::getFunctionLatencyInPath(Instructi
 
     if (CallInst *callI = dyn_cast<CallInst>(I))
     {
-        res = FunctionLatency[callI->getCalledFunction()].latency;
+        res = convertClockDomain(FunctionLatency[callI->getCalledFunction()], callI->getFunction())
+                  .latency;
     }
 
-    if (Inst2LatestOperand.find(I) == Inst2LatestOperand.end())
+    if (!Inst2LatestOperand.count(I))
         return res;
 
     Instruction *preI = Inst2LatestOperand[I];
@@ -525,12 +491,12 @@ int HI_WithDirectiveTimingResourceEvaluation::getFunctionLatencyInPath(Instructi
 // get the number of stage arrive the instruction
 int HI_WithDirectiveTimingResourceEvaluation::getStageTo(Instruction *I)
 {
-    assert(Inst_Schedule.find(I) != Inst_Schedule.end());
+    assert(Inst_Schedule.count(I));
     int instruction_latency = getInstructionLatency(I).latency;
     if (instruction_latency == -1)
-        return Inst_Schedule[I].second + 1 - getFunctionLatencyInPath(I);
+        return Inst_Schedule[I] + 1 - getFunctionLatencyInPath(I);
     else
-        return Inst_Schedule[I].second + instruction_latency - getFunctionLatencyInPath(I);
+        return Inst_Schedule[I] + instruction_latency - getFunctionLatencyInPath(I);
 }
 
 // get the number of stage in the block
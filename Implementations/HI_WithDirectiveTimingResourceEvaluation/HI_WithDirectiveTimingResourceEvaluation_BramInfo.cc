@@ -406,7 +406,9 @@ HI_WithDirectiveTimingResourceEvaluation::handleBRAMAccessFor(
                 *BRAM_log << "    the access instruction: " << *access << " for the target ["
                           << target->getName() << "] CANNOT be scheduled in cycle #"
                           << cur_Timing.latency << " of Block:" << cur_block->getName() << "\n";
-            cur_Timing.latency++;
+            // skip the cycles where the ports of the partition are all used
+            cur_Timing.latency = getPortOccupancy(target, cur_block, target_partition)
+                                     .getFirstAvailableCycle(cur_Timing.latency + 1);
             cur_Timing.timing = 0;
             if (checkBRAMAvailabilty(access, target, LoadOrStore, cur_block, cur_Timing,
                                      target_partition))
@@ -486,23 +488,12 @@ bool HI_WithDirectiveTimingResourceEvaluation::checkBRAMAvailabilty(
     // for (auto aliasI : accessAliasMap[access])
     // {
 
-    //     if (Inst_Schedule[aliasI].second)
+    //     if (Inst_Schedule[aliasI])
     // }
 
-    int cnt = 0;
-    HI_AccessInfo curAccessInfo = getAccessInfoForAccessInst(access);
-
     // check whether there is congestion when trying to access the BRAM
-    // by checking the list of scheduled accesses in the basic block
-    for (auto lat_Inst_pair : target2LastAccessCycleInBlock[target][cur_block])
-    {
-        Instruction *preI = lat_Inst_pair.second;
-        HI_AccessInfo preAccessInfo = getAccessInfoForAccessInst(preI);
-        if (lat_Inst_pair.first.first == cur_Timing.latency &&
-            (lat_Inst_pair.first.second ==
-             target_partition /* ||  preAccessInfo.unpredictable || curAccessInfo.unpredictable */))
-            cnt++;
-    }
+    // by checking the port occupancy of the partition in the basic block
+    int cnt = getPortOccupancy(target, cur_block, target_partition).getUsage(cur_Timing.latency);
 
     if (DEBUG)
         *BRAM_log << "for partition #" << target_partition << ": " << cnt
@@ -515,6 +506,19 @@ bool HI_WithDirectiveTimingResourceEvaluation::checkBRAMAvailabilty(
     return true;
 }
 
+// get the port occupancy of the partition of the target in the block
+HI_PortOccupancy &HI_WithDirectiveTimingResourceEvaluation::getPortOccupancy(
+    Value *target, BasicBlock *cur_block, partition_info target_partition)
+{
+    std::pair<Value *, partition_info> tmp_pair =
+        std::pair<Value *, partition_info>(target, target_partition);
+    auto &block2Occupancy = targetPartition2BlockOccupancy[tmp_pair];
+    auto it = block2Occupancy.find(cur_block);
+    if (it == block2Occupancy.end())
+        it = block2Occupancy.emplace(cur_block, HI_PortOccupancy(target_partition.port_num)).first;
+    return it->second;
+}
+
 // record the schedule information
 void HI_WithDirectiveTimingResourceEvaluation::insertBRAMAccessInfo(Value *target,
                                                                     BasicBlock *cur_block,
@@ -530,31 +534,32 @@ void HI_WithDirectiveTimingResourceEvaluation::insertBRAMAccessInfo(Value *targe
     std::pair<Value *, partition_info> tmp_pair =
         std::pair<Value *, partition_info>(target, target_partition);
 
-    if (partition2cnt.find(target_partition) == partition2cnt.end())
-        partition2cnt[target_partition] = std::pair<int, int>(0, 0);
-
+    // the access is also counted for its function, so the functions sharing the evaluation of
+    // the function count it again without re-scheduling (see shareFunctionEvaluation)
+    std::pair<int, int> &cnt = partition2cnt[target_partition];
+    std::pair<int, int> &functionCnt =
+        Function2PartitionCnt[cur_block->getParent()][target_partition];
     if (access->getOpcode() == Instruction::Load)
-        partition2cnt[target_partition].first++;
+    {
+        cnt.first++;
+        functionCnt.first++;
+    }
     else
-        partition2cnt[target_partition].second++;
+    {
+        cnt.second++;
+        functionCnt.second++;
+    }
 
-    int checkCnt = 0;
-    for (auto b_l_pair : targetPartition2BlockCycleAccessCnt[tmp_pair])
+    HI_PortOccupancy &occupancy = getPortOccupancy(target, cur_block, target_partition);
+    if (occupancy.getUsage(cur_latency) >= target_partition.port_num)
     {
-        if (b_l_pair.first == cur_block && cur_latency == b_l_pair.second)
-        {
-            checkCnt++;
-            if (checkCnt >= target_partition.port_num)
-            {
-                if (DEBUG)
-                    *BRAM_log << " error with block: " << cur_block->getName() << " at cycle#"
-                              << cur_latency << "\n";
-                llvm::errs() << " error with block: " << cur_block->getName() << " at cycle#"
-                             << cur_latency << "\n";
-                break;
-            }
-        }
+        if (DEBUG)
+            *BRAM_log << " error with block: " << cur_block->getName() << " at cycle#"
+                      << cur_latency << "\n";
+        llvm::errs() << " error with block: " << cur_block->getName() << " at cycle#"
+                     << cur_latency << "\n";
     }
+    occupancy.addUsage(cur_latency);
     targetPartition2BlockCycleAccessCnt[tmp_pair].push_back(
         std::pair<BasicBlock *, int>(cur_block, cur_latency));
     // td::map<BasicBlock*,std::map<std::pair<Value*, partition_info>, int>> accessCounterForBlock;
@@ -1513,40 +1518,18 @@ HI_WithDirectiveTimingResourceEvaluation::getPartitionFor(Instruction *access)
         }
     }
 
-    int num_partitions = 1;
-    for (int i = 0; i < tmp_res.num_dims; i++)
-        num_partitions *= tmp_res.partition_size[i];
-
-    auto offsets = generatePotentialOffset(tmp_res);
     bool incByOne = 1;
     bool decByOne = 1;
-    for (int i = 0; i < offsets.size(); i++)
+    if (tmp_res.reverse_loop_dep <= 0 ||
+        !getPartitionsInClosedForm(tmp_res, partitions, incByOne, decByOne))
     {
-        int tmp_offset = offsets[i];
-        if (i > 0)
-        {
-            if (offsets[i] - offsets[i - 1] != 1)
-                incByOne = 0;
-            if (offsets[i] - offsets[i - 1] != -1)
-                decByOne = 0;
-        }
-
-        if (num_partitions != partitions.size())
-        {
-            // ArrayLog->flush();
-            // some time the remainder loop after unrolling will lead to fake out-of-range access,
-            // ignore it.
-            partition_info newPartitionForCheck =
-                getAccessPartitionBasedOnAccessInfoAndInc(tmp_res, tmp_offset);
-            if (DEBUG)
-                *ArrayLog << tmp_offset << "-" << newPartitionForCheck << ", ";
-            // int cur_dim_index = (tmp_offset / tmp_res.sub_element_num[partition_dimension] %
-            // tmp_res.sub_element_num[partition_dimension+1]); if (!tryRecordPartition(partitions,
-            // newPartitionForCheck))
-            //     break;
-            tryRecordPartition(partitions, newPartitionForCheck);
-        }
+        // the closed form does not fit the access, e.g. the index carries between the dimensions,
+        // so emulate the loops to enumerate the offsets
+        getPartitionsByEnumeration(tmp_res, partitions, incByOne, decByOne);
     }
+    else if (DEBUG && !checkPartitionsInClosedForm(tmp_res))
+        print_warning("The partitions of the access in closed form differ from the enumerated "
+                      "ones, check the ArrayLog.");
 
     // here we need to check:
     // whether the partition selection of array number requires remainder calculation.
@@ -1883,12 +1866,12 @@ bool HI_WithDirectiveTimingResourceEvaluation::hasRAWHazard(Instruction *loadI,
             {
                 // Redundant load with alias access should have been removed
                 // therefore, this could be potential conflict, reject the access
-                if (Inst_Schedule[preI].second >= cycle && !noAliasHazard(loadI, preI))
+                if (Inst_Schedule[preI] >= cycle && !noAliasHazard(loadI, preI))
                 {
                     if (DEBUG)
                         *BRAM_log << "\nload instruction: " << *loadI
                                   << " RAW hazard with store instruction: " << *preI << " at cycle#"
-                                  << Inst_Schedule[preI].second << "\n";
+                                  << Inst_Schedule[preI] << "\n";
                     return true;
                 }
             }
@@ -2624,6 +2607,353 @@ void HI_WithDirectiveTimingResourceEvaluation::getAllPotentialOffsetByRecuresive
     }
 }
 
+/*
+    get the partitions reachable by a predictable access in closed form, in the time independent
+    of the trip counts, rather than emulating all the combinations of the loop iterations:
+    (1) the offset is init + sum(i_L * inc_L), 0 <= i_L < trip_L. The increment of each loop is
+        assigned to the outermost dimension whose sub_element_num divides it. If the index of each
+        inner dimension stays in its range, there is no carry between the dimensions and the
+        offsets are the cartesian product of the indices of the dimensions. The offsets out of
+        the array are ignored, i.e. the index of the outermost dimension is capped.
+    (2) the steps of a dimension are made positive by starting from the minimal index. For one
+        loop, the indices are an arithmetic progression, whose cyclic partitions repeat with the
+        period P/gcd(step,P) and whose block partitions are contiguous if the step is not larger
+        than the block. For more loops, the reachable residues (cyclic, without cap) or indices
+        are accumulated loop by loop.
+    (3) the offsets increase/decrease by one iff each effective loop (trip count > 1) increments
+        the offset by +/- the number of the iterations of the loops inside it. The iterations
+        entirely out of the array are trimmed first.
+    false is returned if the access does not fit and the offsets should be enumerated.
+*/
+bool HI_WithDirectiveTimingResourceEvaluation::getPartitionsInClosedForm(
+    HI_AccessInfo &info, std::vector<partition_info> &partitions, bool &incByOne, bool &decByOne)
+{
+    int num_dims = info.num_dims;
+    int loopDep = info.reverse_loop_dep;
+    int64_t init = info.initial_offset;
+    int64_t total = (int64_t)info.dim_size[num_dims - 1] * info.sub_element_num[num_dims - 1];
+    if (init < 0)
+        return false;
+
+    std::vector<partition_info> res_partitions;
+    bool res_incByOne = 1, res_decByOne = 1;
+
+    // a loop without iteration leads to no offset
+    for (int L = 0; L < loopDep; L++)
+        if (info.trip_count[L] <= 0)
+        {
+            partitions = res_partitions;
+            incByOne = decByOne = 1;
+            return true;
+        }
+
+    // (1) decompose the offset into the indices of the dimensions
+    std::vector<int64_t> initIndex(num_dims);
+    for (int d = 0; d < num_dims; d++)
+    {
+        initIndex[d] = init / info.sub_element_num[d];
+        if (d < num_dims - 1)
+            initIndex[d] %= info.dim_size[d];
+    }
+    // (step, trip count) of the loops for each dimension
+    std::vector<std::vector<std::pair<int64_t, int64_t>>> dimLoops(num_dims);
+    for (int L = 0; L < loopDep; L++)
+    {
+        if (info.trip_count[L] == 1 || info.inc_index[L] == 0)
+            continue;
+        int d = num_dims - 1;
+        while (info.inc_index[L] % info.sub_element_num[d])
+            d--;
+        dimLoops[d].push_back(
+            std::make_pair(info.inc_index[L] / info.sub_element_num[d], info.trip_count[L]));
+    }
+
+    // (2) get the reachable partitions of each dimension
+    std::vector<std::vector<int>> dimPartitions(num_dims);
+    for (int d = 0; d < num_dims; d++)
+    {
+        int64_t minIndex = initIndex[d], maxIndex = initIndex[d];
+        for (auto &loop : dimLoops[d])
+        {
+            int64_t span = (loop.second - 1) * loop.first;
+            minIndex += std::min<int64_t>(0, span);
+            maxIndex += std::max<int64_t>(0, span);
+        }
+        int64_t capIndex = info.dim_size[d] - 1;
+        if (minIndex < 0 || (d < num_dims - 1 && maxIndex > capIndex))
+            return false;
+
+        int partNum = info.partition_size[d];
+        int64_t blockSize = (info.dim_size[d] + partNum - 1) / partNum;
+        auto getPartitionID = [&](int64_t index) -> int {
+            return info.cyclic[d] ? index % partNum : index / blockSize;
+        };
+        BitVector reachable(partNum);
+
+        if (minIndex > capIndex)
+        {
+            // all the offsets are out of the array
+        }
+        else if (dimLoops[d].size() <= 1)
+        {
+            int64_t step = dimLoops[d].empty() ? 1 : std::abs(dimLoops[d][0].first);
+            int64_t tripCount = dimLoops[d].empty() ? 1 : dimLoops[d][0].second;
+            tripCount = std::min(tripCount, (capIndex - minIndex) / step + 1);
+            if (info.cyclic[d])
+            {
+                int64_t period = partNum / GreatestCommonDivisor64(step, partNum);
+                for (int64_t i = 0; i < std::min(tripCount, period); i++)
+                    reachable.set(getPartitionID(minIndex + i * step));
+            }
+            else if (step <= blockSize)
+            {
+                for (int64_t ID = getPartitionID(minIndex),
+                             lastID = getPartitionID(minIndex + (tripCount - 1) * step);
+                     ID <= lastID; ID++)
+                    reachable.set(ID);
+            }
+            else
+            {
+                // each iteration reaches a different block, at most partNum iterations
+                for (int64_t i = 0; i < tripCount; i++)
+                    reachable.set(getPartitionID(minIndex + i * step));
+            }
+        }
+        else if (info.cyclic[d] && maxIndex <= capIndex)
+        {
+            // accumulate the residues modulo the partition factor
+            BitVector residues(partNum);
+            residues.set(minIndex % partNum);
+            for (auto &loop : dimLoops[d])
+            {
+                int64_t step = std::abs(loop.first) % partNum;
+                int64_t period = partNum / GreatestCommonDivisor64(step, partNum);
+                BitVector nextResidues(partNum);
+                for (int r : residues.set_bits())
+                    for (int64_t i = 0; i < std::min(loop.second, period); i++)
+                        nextResidues.set((r + i * step) % partNum);
+                residues = nextResidues;
+            }
+            reachable = residues;
+        }
+        else
+        {
+            // accumulate the reachable indices, the window of each index covers the indices
+            // trip_count steps before it
+            int64_t width = std::min(maxIndex, capIndex) - minIndex + 1;
+            std::vector<bool> indices(width, false);
+            indices[0] = true;
+            for (auto &loop : dimLoops[d])
+            {
+                int64_t step = std::abs(loop.first);
+                std::vector<int> window(width, 0);
+                std::vector<bool> nextIndices(width, false);
+                for (int64_t x = 0; x < width; x++)
+                {
+                    window[x] = indices[x] + (x >= step ? window[x - step] : 0) -
+                                (x >= loop.second * step ? indices[x - loop.second * step] : 0);
+                    nextIndices[x] = window[x] > 0;
+                }
+                indices = nextIndices;
+            }
+            for (int64_t x = 0; x < width; x++)
+                if (indices[x])
+                    reachable.set(getPartitionID(minIndex + x));
+        }
+
+        for (int ID : reachable.set_bits())
+            dimPartitions[d].push_back(ID);
+        if (dimPartitions[d].empty())
+        {
+            partitions = res_partitions;
+            incByOne = decByOne = 1;
+            return true;
+        }
+    }
+
+    // (3) check whether the offsets increase/decrease by one, after trimming the iterations
+    // entirely out of the array
+    int64_t minOffset = init;
+    for (int L = 0; L < loopDep; L++)
+        minOffset += std::min<int64_t>(0, (int64_t)(info.trip_count[L] - 1) * info.inc_index[L]);
+    int64_t baseOffset = init, maxOffset, innerIterations = 1;
+    bool multiIterations = 0;
+    std::vector<int64_t> tripCounts(loopDep);
+    for (int L = 0; L < loopDep; L++)
+    {
+        int64_t inc = info.inc_index[L], tripCount = info.trip_count[L];
+        if (inc > 0)
+            tripCount = std::min(tripCount, (total - 1 - minOffset) / inc + 1);
+        else if (inc < 0)
+        {
+            // the offsets of the first iterations are the highest ones
+            int64_t highest = minOffset - (tripCount - 1) * inc;
+            int64_t trimmed = highest < total ? 0 : (highest - total) / -inc + 1;
+            baseOffset += trimmed * inc;
+            tripCount -= trimmed;
+        }
+        tripCounts[L] = tripCount;
+    }
+    maxOffset = baseOffset;
+    for (int L = 0; L < loopDep; L++)
+    {
+        maxOffset += std::max<int64_t>(0, (tripCounts[L] - 1) * info.inc_index[L]);
+        if (tripCounts[L] <= 1)
+            continue;
+        multiIterations = 1;
+        if (info.inc_index[L] != innerIterations)
+            res_incByOne = 0;
+        if (info.inc_index[L] != -innerIterations)
+            res_decByOne = 0;
+        if (innerIterations <= INT32_MAX)
+            innerIterations *= tripCounts[L];
+    }
+
+    if (!multiIterations)
+        res_incByOne = res_decByOne = 1;
+    else if (maxOffset >= total)
+    {
+        // the offsets out of the array are ignored: a prefix of the increasing offsets or a
+        // suffix of the decreasing offsets is left
+        if (res_incByOne)
+            res_decByOne = std::min(maxOffset, total - 1) <= baseOffset;
+        else if (res_decByOne)
+            res_incByOne = std::min(baseOffset, total - 1) <= minOffset;
+        else
+            return false;
+    }
+
+    // the cartesian product of the partitions of the dimensions
+    Value *reftarget = info.target;
+    if (Alias2Target.find(reftarget) != Alias2Target.end())
+        reftarget = Alias2Target[reftarget];
+    std::vector<int> pos(num_dims, 0);
+    while (true)
+    {
+        partition_info tmp_part_bank;
+        tmp_part_bank.num_dims = num_dims;
+        tmp_part_bank.port_num = info.port_num;
+        tmp_part_bank.target = reftarget;
+        for (int d = 0; d < num_dims; d++)
+            tmp_part_bank.partition_id[d] = dimPartitions[d][pos[d]];
+        res_partitions.push_back(tmp_part_bank);
+
+        int d = 0;
+        while (d < num_dims && ++pos[d] == (int)dimPartitions[d].size())
+            pos[d++] = 0;
+        if (d == num_dims)
+            break;
+    }
+
+    // keep the partition of the first offset in the array at the front, like the enumeration
+    // does: take the first iteration of each loop (from the outermost one) where the offset can
+    // still be in the array
+    int64_t firstOffset = init, innerMinOffset = minOffset - init;
+    for (int L = loopDep - 1; L >= 0; L--)
+    {
+        int64_t inc = info.inc_index[L];
+        innerMinOffset -= std::min<int64_t>(0, (int64_t)(info.trip_count[L] - 1) * inc);
+        int64_t exceeded = firstOffset + innerMinOffset - (total - 1);
+        if (inc < 0 && exceeded > 0)
+            firstOffset += (exceeded + -inc - 1) / -inc * inc;
+    }
+    partition_info firstPartition = getAccessPartitionBasedOnAccessInfoAndInc(info, firstOffset);
+    for (int i = 0, e = res_partitions.size(); i < e; i++)
+        if (res_partitions[i] == firstPartition)
+        {
+            std::rotate(res_partitions.begin(), res_partitions.begin() + i,
+                        res_partitions.begin() + i + 1);
+            break;
+        }
+
+    if (DEBUG)
+    {
+        for (auto &partition : res_partitions)
+            *ArrayLog << partition << ", ";
+        *ArrayLog << "(in closed form)\n";
+    }
+    partitions = res_partitions;
+    incByOne = res_incByOne;
+    decByOne = res_decByOne;
+    return true;
+}
+
+// get the partitions reachable by a predictable access and whether its offsets increase/decrease
+// by one, by emulating the loops to enumerate the offsets
+void HI_WithDirectiveTimingResourceEvaluation::getPartitionsByEnumeration(
+    HI_AccessInfo &info, std::vector<partition_info> &partitions, bool &incByOne, bool &decByOne)
+{
+    int num_partitions = 1;
+    for (int i = 0; i < info.num_dims; i++)
+        num_partitions *= info.partition_size[i];
+
+    incByOne = 1;
+    decByOne = 1;
+    auto offsets = generatePotentialOffset(info);
+    for (int i = 0; i < offsets.size(); i++)
+    {
+        int tmp_offset = offsets[i];
+        if (i > 0)
+        {
+            if (offsets[i] - offsets[i - 1] != 1)
+                incByOne = 0;
+            if (offsets[i] - offsets[i - 1] != -1)
+                decByOne = 0;
+        }
+
+        if (num_partitions != partitions.size())
+        {
+            // ArrayLog->flush();
+            // some time the remainder loop after unrolling will lead to fake out-of-range
+            // access, ignore it.
+            partition_info newPartitionForCheck =
+                getAccessPartitionBasedOnAccessInfoAndInc(info, tmp_offset);
+            if (DEBUG)
+                *ArrayLog << tmp_offset << "-" << newPartitionForCheck << ", ";
+            // int cur_dim_index = (tmp_offset / tmp_res.sub_element_num[partition_dimension]
+            // % tmp_res.sub_element_num[partition_dimension+1]); if
+            // (!tryRecordPartition(partitions, newPartitionForCheck))
+            //     break;
+            tryRecordPartition(partitions, newPartitionForCheck);
+        }
+    }
+}
+
+// check whether the partitions of the access in closed form are the same as the enumerated ones,
+// i.e. the same set of partitions with the same one at the front, and the same incByOne/decByOne.
+// true is returned if they are the same or the closed form does not fit the access.
+bool HI_WithDirectiveTimingResourceEvaluation::checkPartitionsInClosedForm(HI_AccessInfo &info)
+{
+    std::vector<partition_info> closedPartitions, enumPartitions;
+    bool closedIncByOne = 1, closedDecByOne = 1, enumIncByOne = 1, enumDecByOne = 1;
+    if (!getPartitionsInClosedForm(info, closedPartitions, closedIncByOne, closedDecByOne))
+        return true;
+    getPartitionsByEnumeration(info, enumPartitions, enumIncByOne, enumDecByOne);
+
+    bool same = closedIncByOne == enumIncByOne && closedDecByOne == enumDecByOne &&
+                closedPartitions.size() == enumPartitions.size();
+    if (same && !closedPartitions.empty())
+        same = closedPartitions[0] == enumPartitions[0];
+    for (int i = 0; same && i < closedPartitions.size(); i++)
+        same = std::find(enumPartitions.begin(), enumPartitions.end(), closedPartitions[i]) !=
+               enumPartitions.end();
+
+    if (!same && DEBUG)
+    {
+        *ArrayLog << "\nmismatch of the partitions in closed form (incByOne=" << closedIncByOne
+                  << " decByOne=" << closedDecByOne << "): ";
+        for (auto &partition : closedPartitions)
+            *ArrayLog << partition << ", ";
+        *ArrayLog << "\n    and the enumerated ones (incByOne=" << enumIncByOne
+                  << " decByOne=" << enumDecByOne << "): ";
+        for (auto &partition : enumPartitions)
+            *ArrayLog << partition << ", ";
+        *ArrayLog << "\n";
+        ArrayLog->flush();
+    }
+    return same;
+}
+
 // get all the partitions for the access target of the access instruction
 std::vector<HI_WithDirectiveTimingResourceEvaluation::partition_info>
 HI_WithDirectiveTimingResourceEvaluation::getAllPartitionFor(Instruction *access)
@@ -2635,6 +2965,17 @@ HI_WithDirectiveTimingResourceEvaluation::getAllPartitionFor(Instruction *access
     return res;
 }
 
+// get the partitions which the access may visit, i.e. the predicted partitions, or all the
+// partitions if the access pattern is unpredictable
+std::vector<HI_WithDirectiveTimingResourceEvaluation::partition_info>
+HI_WithDirectiveTimingResourceEvaluation::getTargetPartitionsForAccess(Instruction *access)
+{
+    HI_AccessInfo cur_access_info = getAccessInfoForAccessInst(access);
+    if (cur_access_info.unpredictable)
+        return getAllPartitionFor(access);
+    return getPartitionFor(access);
+}
+
 // get all the partitions for the access target of the access instruction
 void HI_WithDirectiveTimingResourceEvaluation::getAllPartitionBasedOnInfo(
     HI_AccessInfo &info, int curDim, std::vector<int> &tmp_partID, std::vector<partition_info> &res)
@@ -1,5 +1,8 @@
+#include "HI_HLSLibrary.h"
 #include "HI_InstructionFiles.h"
 #include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include <cmath>
+#include <cstdlib>
 #include <fstream>
 #include <string>
 #include <sys/stat.h>
@@ -114,6 +117,20 @@ void HI_WithDirectiveTimingResourceEvaluation::Parse_Config_toInfo(
             parseLocalArray(iss, desginconfig);
             break;
 
+        case hash_compile_time("loop_pipeline_scheduler"):
+            consumeEqual(iss);
+            iss >> tmpStr_forParsing;
+            desginconfig.moduloScheduling = (tmpStr_forParsing == "modulo");
+            break;
+
+        case hash_compile_time("resource_limit"):
+            parseResourceLimit(iss, desginconfig);
+            break;
+
+        case hash_compile_time("clock_domain"):
+            parseClockDomain(iss, desginconfig);
+            break;
+
         default:
             break;
         }
@@ -383,6 +400,89 @@ void HI_WithDirectiveTimingResourceEvaluation::parseLoopPipeline(std::stringstre
     desginconfig.insertLoopPipeline(loopLabel, factor);
 }
 
+// parse the argument for resource limitation, only the DSP limit is used by the evaluation
+void HI_WithDirectiveTimingResourceEvaluation::parseResourceLimit(std::stringstream &iss,
+                                                                  HI_DesignConfigInfo &desginconfig)
+{
+    while (!iss.eof())
+    {
+        std::string arg_name;
+        std::string tmp_val;
+        iss >> arg_name; //  get the name of parameter
+        if (arg_name == "")
+            continue;
+        consumeEqual(iss);
+        iss >> tmp_val;
+        if (arg_name != "DSP")
+            continue;
+        int limit;
+        if (llvm::StringRef(tmp_val).getAsInteger(10, limit) || limit < 0)
+        {
+            llvm::errs() << "wrong value: DSP=" << tmp_val << "\n";
+            print_error("The DSP limit should be a non-negative integer, e.g. resource_limit "
+                        "DSP=64.");
+            continue;
+        }
+        desginconfig.DSPLimit = limit;
+    }
+}
+
+// parse the argument for the clock domain of a function, e.g. clock_domain function=f period=5
+void HI_WithDirectiveTimingResourceEvaluation::parseClockDomain(std::stringstream &iss,
+                                                                HI_DesignConfigInfo &desginconfig)
+{
+    std::string functionName(""), period_str("");
+    while (!iss.eof())
+    {
+        std::string arg_name;
+        std::string tmp_val;
+        iss >> arg_name; //  get the name of parameter
+        switch (hash_(arg_name.c_str()))
+        {
+        case hash_compile_time("function"):
+            consumeEqual(iss);
+            iss >> tmp_val;
+            functionName = (tmp_val);
+            break;
+
+        case hash_compile_time("period"):
+            consumeEqual(iss);
+            iss >> tmp_val;
+            period_str = (tmp_val);
+            break;
+
+        default:
+            llvm::errs() << "wrong argument: " << arg_name << "\n";
+            print_error("Wrong argument for clock domain setting.");
+            break;
+        }
+    }
+    if (functionName == "" || period_str == "")
+    {
+        print_error("The clock domain setting should be like: clock_domain function=f period=5.");
+        return;
+    }
+
+    // the instructions are only characterized at the clock periods of the library
+    double period;
+    if (llvm::StringRef(period_str).getAsDouble(period))
+    {
+        llvm::errs() << "wrong value: period=" << period_str << "\n";
+        print_error("The period of the clock domain of [" + functionName + "] is not a number.");
+        return;
+    }
+    bool characterized = false;
+    for (int i = 0; i < clockNum; i++)
+        characterized |= std::fabs(period - clockPeriod[i]) < 0.0001;
+    if (!characterized)
+    {
+        print_error("The period " + period_str + " of the clock domain of [" + functionName +
+                    "] is not in the HLS library, the domain is ignored.");
+        return;
+    }
+    desginconfig.insertClockDomain(functionName, period_str);
+}
+
 // Pass for simple evluation of the latency of the top function, without considering HLS directives
 void HI_WithDirectiveTimingResourceEvaluation::Parse_Config(const HI_DesignConfigInfo &configInfo)
 {
@@ -494,79 +594,51 @@ void HI_WithDirectiveTimingResourceEvaluation::Parse_Config(const HI_DesignConfi
 // load the HLS database of timing and resource
 void HI_WithDirectiveTimingResourceEvaluation::Load_Instruction_Info()
 {
-    int i;
-    for (i = 0; i < instructionInfoNum; i++)
-    {
+    std::vector<std::string> opcodes;
+    for (int i = 0; i < instructionInfoNum; i++)
         if (instructionHasMappingFile[i])
-        {
-            Info_type_list tmp_list;
-            std::string info_file_name(HLS_lib_path.c_str());
-            info_file_name += instructionNames[i];
-            info_file_name += "/";
-            info_file_name += instructionNames[i];
-            // info_file_name+="_data";
-            std::ifstream info_file(info_file_name.c_str());
-
-            if (!exists_test(info_file_name))
-            {
-                llvm::errs() << "The HLS info file [" + info_file_name + "] does not exist.\n";
-                assert(false && "check the HLS information library path.\n");
-            }
-            std::string tmp_s;
-            while (getline(info_file, tmp_s))
-            {
-                tmp_s = removeExtraSpace(tmp_s);
-                std::stringstream iss(tmp_s);
-                std::string data_ele[11];
-                for (int j = 0; j < 11; j++)
-                {
-                    iss >> data_ele[j];
-                    iss.ignore(1, ' ');
-                }
-                if (instructionNames[i] != "mac")
-                {
-                    if (data_ele[0] != data_ele[1] || data_ele[1] != data_ele[2])
-                        continue; // ignore those unused information
-                }
-                else
-                {
-                    if (data_ele[0] != data_ele[1])
-                        continue; // ignore those unused information
-                }
+            opcodes.push_back(instructionNames[i]);
 
-                inst_timing_resource_info tmp_info;
-
-                int oprand_bitwidth = std::stoi(data_ele[0]);
-                int res_bitwid = std::stoi(data_ele[2]);
-                std::string _clock_period_str = data_ele[3];
-                tmp_info.DSP = std::stoi(data_ele[4]);
-                tmp_info.FF = std::stoi(data_ele[5]);
-                tmp_info.LUT = std::stoi(data_ele[6]);
-                tmp_info.Lat = std::stoi(data_ele[7]);
-                tmp_info.delay = std::stod(data_ele[8]);
-                tmp_info.II = std::stoi(data_ele[9]);
-                tmp_info.core_name = data_ele[10];
-                tmp_list[oprand_bitwidth][res_bitwid][_clock_period_str] = tmp_info;
-                // str(oprandA)+" "+str(oprandB)+" "+str(oprandC)+" "+str(period)+" "
-                // +str(DSP48E_N)+" "+str(FF_N)+" "+str(LUT_N)+" "+str(lat_tmp)+" "
-                // +str(delay_tmp)+" "+str(II_tmp)+" "+str(Core_tmp)
-            }
-            BiOp_Info_name2list_map[instructionNames[i]] = tmp_list;
-        }
+    // the binary HLS library is mapped if it is up-to-date, otherwise the text files are parsed
+    std::vector<std::string> clocks(clockStrs, clockStrs + clockNum);
+    HLSLibTable_contain = HI_loadHLSLibTable(HLS_lib_path, opcodes, clocks);
+    if (!HLSLibTable_contain)
+    {
+        // nothing can be evaluated without the library, so stop here instead of crashing later
+        print_error("The HLS information library cannot be loaded from [" + HLS_lib_path +
+                    "], check the HLS_lib_path in the configuration file.");
+        exit(1);
+    }
+    HLSLibTable = HLSLibTable_contain.get();
+}
+
+// resolve the IDs of the opcodes of the LLVM instructions in the HLS library once, so the
+// evaluation of the instructions looks up the library without comparing any string
+void HI_WithDirectiveTimingResourceEvaluation::resolveHLSLibOpcodeIDs()
+{
+    instOpcode2LibID.assign(Instruction::OtherOpsEnd, -1);
+    doubleInstOpcode2LibID.assign(Instruction::OtherOpsEnd, -1);
+    for (unsigned instOpcode = 1; instOpcode < Instruction::OtherOpsEnd; instOpcode++)
+    {
+        std::string opcode_str(Instruction::getOpcodeName(instOpcode));
+        instOpcode2LibID[instOpcode] = HLSLibTable->getOpcodeID(opcode_str);
+        // the floating-point operations on double values, e.g. fadd -> dadd
+        if (opcode_str[0] == 'f')
+            opcode_str[0] = 'd';
+        doubleInstOpcode2LibID[instOpcode] = HLSLibTable->getOpcodeID(opcode_str);
     }
+    taddLibID = HLSLibTable->getOpcodeID("tadd");
 }
 
 // Organize the information into timingBase after getting the information of a specific instruction,
-// based on its opcode, operand_bitwidth, result_bitwidth and clock period.
+// based on its opcode ID, operand_bitwidth, result_bitwidth and clock ID.
 HI_WithDirectiveTimingResourceEvaluation::timingBase
-HI_WithDirectiveTimingResourceEvaluation::get_inst_TimingInfo_result(std::string opcode,
+HI_WithDirectiveTimingResourceEvaluation::get_inst_TimingInfo_result(int opcodeID,
                                                                      int operand_bitwid,
-                                                                     int res_bitwidth,
-                                                                     std::string period)
+                                                                     int res_bitwidth, int clockID)
 {
     timingBase result(0, 0, 1, clock_period);
-    inst_timing_resource_info info =
-        get_inst_info(opcode, operand_bitwid, res_bitwidth, clock_period_str);
+    const HI_HLSLibRecord &info = getInstRecord(opcodeID, operand_bitwid, res_bitwidth, clockID);
     result.latency = info.Lat;
     result.timing = info.delay;
     result.II = info.II;
@@ -575,16 +647,15 @@ HI_WithDirectiveTimingResourceEvaluation::get_inst_TimingInfo_result(std::string
 }
 
 // Organize the information into resourceBase after getting the information of a specific
-// instruction, based on its opcode, operand_bitwidth, result_bitwidth and clock period.
+// instruction, based on its opcode ID, operand_bitwidth, result_bitwidth and clock ID.
 HI_WithDirectiveTimingResourceEvaluation::resourceBase
-HI_WithDirectiveTimingResourceEvaluation::get_inst_ResourceInfo_result(std::string opcode,
+HI_WithDirectiveTimingResourceEvaluation::get_inst_ResourceInfo_result(int opcodeID,
                                                                        int operand_bitwid,
                                                                        int res_bitwidth,
-                                                                       std::string period)
+                                                                       int clockID)
 {
     resourceBase result(0, 0, 0, clock_period);
-    inst_timing_resource_info info =
-        get_inst_info(opcode, operand_bitwid, res_bitwidth, clock_period_str);
+    const HI_HLSLibRecord &info = getInstRecord(opcodeID, operand_bitwid, res_bitwidth, clockID);
     result.DSP = info.DSP;
     result.FF = info.FF;
     result.LUT = info.LUT;
@@ -597,163 +668,52 @@ inst_timing_resource_info
 HI_WithDirectiveTimingResourceEvaluation::get_inst_info(std::string opcode, int operand_bitwid,
                                                         int res_bitwidth, std::string period)
 {
-    if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, period))
-        return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period];
-    if ((operand_bitwid % 2) && operand_bitwid > 0)
-    {
-        inst_timing_resource_info info_A =
-            get_inst_info(opcode, operand_bitwid + 1, res_bitwidth + 1, period);
-        inst_timing_resource_info info_B =
-            get_inst_info(opcode, operand_bitwid - 1, res_bitwidth - 1, period);
-    }
-
-    if ((operand_bitwid % 2) && operand_bitwid > 0)
-    {
-        inst_timing_resource_info info_A =
-            get_inst_info(opcode, operand_bitwid + 1, res_bitwidth + 1, period);
-        inst_timing_resource_info info_B =
-            get_inst_info(opcode, operand_bitwid - 1, res_bitwidth - 1, period);
-        inst_timing_resource_info tmp_info;
-
-        tmp_info.DSP = (info_A.DSP + info_B.DSP + 1) / 2;
-        tmp_info.FF = (info_A.FF + info_B.FF + 1) / 2;
-        tmp_info.LUT = (info_A.LUT + info_B.LUT) / 2;
-        tmp_info.Lat = (info_A.Lat + info_B.Lat) / 2;
-        tmp_info.delay = (info_A.delay + info_B.delay) / 2;
-        tmp_info.II = (info_A.II + info_B.II + 1) / 2;
-        tmp_info.core_name = info_A.core_name;
-        BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] = tmp_info;
-    }
-    else if (checkFreqProblem(opcode, operand_bitwid, res_bitwidth, period))
-    {
-        BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] =
-            checkInfo_HigherFreq(opcode, operand_bitwid, res_bitwidth, period);
-    }
-    else
-    {
-        llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- "
-                     << res_bitwidth << " -- " << period << " \n";
-        assert(false && "should not reach here.");
-    }
-
-    return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period];
-
-    llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- " << res_bitwidth
-                 << " -- " << period << " \n";
-    assert(false && "no such information in the database\n");
-}
-
-// check whether a specific information is in the database
-bool HI_WithDirectiveTimingResourceEvaluation::checkInfoAvailability(std::string opcode,
-                                                                     int operand_bitwid,
-                                                                     int res_bitwidth,
-                                                                     std::string period)
-{
-    if (BiOp_Info_name2list_map.find(opcode) != BiOp_Info_name2list_map.end())
-    {
-        if (BiOp_Info_name2list_map[opcode].find(operand_bitwid) !=
-            BiOp_Info_name2list_map[opcode].end())
-        {
-            if (BiOp_Info_name2list_map[opcode][operand_bitwid].find(res_bitwidth) !=
-                BiOp_Info_name2list_map[opcode][operand_bitwid].end())
-            {
-                if (BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth].find(period) !=
-                    BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth].end())
-                {
-                    return true;
-                }
-                else
-                {
-                    // llvm::errs() << "not in
-                    // BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth]\n";
-                }
-            }
-            else
-            {
-                // llvm::errs() << "not in BiOp_Info_name2list_map[opcode][operand_bitwid]\n";
-            }
-        }
-        else
-        {
-            // llvm::errs() << "not in BiOp_Info_name2list_map[opcode]\n";
-        }
-    }
-    else
-    {
-        // llvm::errs() << "not in BiOp_Info_name2list_map\n";
-    }
-
-    return false;
+    const HI_HLSLibRecord &record =
+        getInstRecord(HLSLibTable->getOpcodeID(opcode), operand_bitwid, res_bitwidth,
+                      HLSLibTable->getClockID(period));
+    inst_timing_resource_info tmp_info;
+    tmp_info.DSP = record.DSP;
+    tmp_info.FF = record.FF;
+    tmp_info.LUT = record.LUT;
+    tmp_info.Lat = record.Lat;
+    tmp_info.delay = record.delay;
+    tmp_info.II = record.II;
+    tmp_info.core_name = record.core_name;
+    return tmp_info;
 }
 
-// check whether we can infer the information by increasing the clock frequency
-bool HI_WithDirectiveTimingResourceEvaluation::checkFreqProblem(std::string opcode,
-                                                                int operand_bitwid,
-                                                                int res_bitwidth,
-                                                                std::string period)
+// get the record of a specific instruction, based on its opcode ID, operand_bitwidth,
+// result_bitwidth and clock ID. The missing bitwidths/clock periods are inferred when the
+// table is built, so the lookup never modifies anything. An entry missing from the library is
+// reported and evaluated as an empty record (no latency and no resource).
+const HI_HLSLibRecord &HI_WithDirectiveTimingResourceEvaluation::getInstRecord(int opcodeID,
+                                                                              int operand_bitwid,
+                                                                              int res_bitwidth,
+                                                                              int clockID)
 {
-    if (BiOp_Info_name2list_map.find(opcode) != BiOp_Info_name2list_map.end())
+    const HI_HLSLibRecord *info =
+        HLSLibTable->lookup(opcodeID, operand_bitwid, res_bitwidth, clockID);
+    if (!info)
     {
-        if (BiOp_Info_name2list_map[opcode].find(operand_bitwid) !=
-            BiOp_Info_name2list_map[opcode].end())
-        {
-            if (BiOp_Info_name2list_map[opcode][operand_bitwid].find(res_bitwidth) !=
-                BiOp_Info_name2list_map[opcode][operand_bitwid].end())
-            {
-                return true;
-            }
-            else
-            {
-                // llvm::errs() << "not in BiOp_Info_name2list_map[opcode][operand_bitwid]\n";
-            }
-        }
-        else
-        {
-            // llvm::errs() << "not in BiOp_Info_name2list_map[opcode]\n";
-        }
-    }
-    else
-    {
-        // llvm::errs() << "not in BiOp_Info_name2list_map\n";
+        static const HI_HLSLibRecord emptyRecord = {};
+        llvm::errs() << "inquirying : "
+                     << (opcodeID >= 0 ? HLSLibTable->getOpcodeStr(opcodeID) : "<unknown opcode>")
+                     << " -- " << operand_bitwid << " -- " << res_bitwidth << " -- "
+                     << (clockID >= 0 ? HLSLibTable->getClockStr(clockID) : "<unknown clock>")
+                     << " \n";
+        print_error("No such information in the HLS information library, it is evaluated as "
+                    "an empty record.");
+        return emptyRecord;
     }
-
-    return false;
+    return *info;
 }
 
-// if the information is not found in database, we may infer the information by increasing the clock
-// frequency
-inst_timing_resource_info HI_WithDirectiveTimingResourceEvaluation::checkInfo_HigherFreq(
-    std::string opcode, int operand_bitwid, int res_bitwidth, std::string period)
+// check whether a specific information is characterized in the database
+bool HI_WithDirectiveTimingResourceEvaluation::checkInfoAvailability(int opcodeID,
+                                                                     int operand_bitwid,
+                                                                     int res_bitwidth, int clockID)
 {
-    int i;
-
-    // locate the target clock in clock sequence
-    for (i = clockNum - 1; i >= 0; i--)
-        if (std::stof(clockStrs[i]) == std::stof(period))
-        {
-            if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, clockStrs[i]))
-            {
-                BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][period] =
-                    BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-                return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-            }
-            break;
-        }
-    i--;
-    if (i < 0)
-        llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- "
-                     << res_bitwidth << " -- " << period << " \n";
-    assert(i >= 0 && "The clock should be found.\n");
-
-    // iterate to find available information in database
-    for (; i >= 0; i--)
-    {
-        if (checkInfoAvailability(opcode, operand_bitwid, res_bitwidth, clockStrs[i]))
-            return BiOp_Info_name2list_map[opcode][operand_bitwid][res_bitwidth][clockStrs[i]];
-    }
-    llvm::errs() << "inquirying : " << opcode << " -- " << operand_bitwid << " -- " << res_bitwidth
-                 << " -- " << period << " \n";
-    assert(false && "no such information in the database\n");
+    return HLSLibTable->isCharacterized(opcodeID, operand_bitwid, res_bitwidth, clockID);
 }
 
 // parse the argument for array partitioning
@@ -1107,6 +1067,11 @@ raw_ostream &operator<<(raw_ostream &stream, const HI_DesignConfigInfo &tb)
                << partition_seq.first
                << "] complete partition at dim=" << partition_seq.second.second << "\n";
     }
+    if (tb.moduloScheduling)
+        stream << "    Pipelined loops are scheduled by the modulo scheduler\n";
+    for (auto domain_pair : tb.clockDomainConfigs)
+        stream << "    Function: [" << domain_pair.first
+               << "] in clock domain of period=" << domain_pair.second << "\n";
     stream << "\n\n";
 
     // loop_pipeline label=Loop_kernel_2mm_6 II=1
@@ -1137,6 +1102,11 @@ raw_ostream &operator<<(raw_ostream &stream, const HI_DesignConfigInfo &tb)
                << " scope=" << partition_seq.first << " dim=" << partition_seq.second.second.first
                << " factor=" << partition_seq.second.second.second << " block\n";
     }
+    if (tb.moduloScheduling)
+        stream << "loop_pipeline_scheduler = modulo\n";
+    for (auto domain_pair : tb.clockDomainConfigs)
+        stream << "clock_domain function=" << domain_pair.first
+               << " period=" << domain_pair.second << "\n";
 
     stream << "\n\n";
 
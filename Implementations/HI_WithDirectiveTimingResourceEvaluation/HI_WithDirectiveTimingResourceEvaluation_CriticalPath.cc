@@ -0,0 +1,171 @@
+#include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include "HI_print.h"
+#include "llvm/IR/CFG.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace llvm;
+
+/*
+    find the longest paths to the nodes in a function/loop body in O(V+E):
+    (1) regard each (sub-)loop as an integration, so the function/loop body becomes a DAG of
+        nodes, i.e. the blocks out of the (sub-)loops and the (sub-)loops
+        -- in a function, the nodes are the most outer loops, which are evaluated here
+        -- in a loop body, the nodes are the evaluated sub-loops (Block2EvaluatedLoop)
+    (2) visit the nodes by DFS from the entry, evaluate the latency and resource of each node at
+        its first visit, and record the post-order of the nodes
+    (3) traverse the nodes in the reverse post-order (a topological order), the critical path to
+        the end of a node is the longest critical path of its predecessors plus its latency.
+        The edges to the nodes visited earlier in the order (the back edges to the loop header,
+        or of the cycles which are not loops) are ignored, just like the paths with cycles are
+        not enumerated.
+*/
+void HI_WithDirectiveTimingResourceEvaluation::getCriticalPathNodes(
+    Function *F, Loop *curLoop,
+    HI_WithDirectiveTimingResourceEvaluation::resourceBase &resourceAccumulator,
+    std::vector<CriticalPathNode> &nodes)
+{
+    nodes.clear();
+    std::map<BasicBlock *, int> Block2Node;
+    std::map<Loop *, int> Loop2Node;
+
+    // get the (sub-)loop which is regarded as an integration for the block, nullptr if none
+    auto getNodeLoop = [&](BasicBlock *B) -> Loop * {
+        if (!curLoop)
+            return isInLoop(B) ? getOuterLoopOfBlock(B) : nullptr;
+        if (Block2EvaluatedLoop.count(B) && Block2EvaluatedLoop[B] != curLoop)
+            return Block2EvaluatedLoop[B];
+        return nullptr;
+    };
+
+    // get the node of the block, the blocks in a (sub-)loop share the node of the loop
+    auto getNode = [&](BasicBlock *B) -> int {
+        if (Loop *tmp_Loop = getNodeLoop(B))
+        {
+            auto it = Loop2Node.find(tmp_Loop);
+            if (it != Loop2Node.end())
+                return it->second;
+            nodes.push_back(CriticalPathNode{tmp_Loop->getHeader(), tmp_Loop,
+                                             timingBase(0, 0, 1, clock_period),
+                                             timingBase(0, 0, 1, clock_period),
+                                             timingBase(0, 0, 1, clock_period),
+                                             {}});
+            return Loop2Node[tmp_Loop] = nodes.size() - 1;
+        }
+        auto it = Block2Node.find(B);
+        if (it != Block2Node.end())
+            return it->second;
+        nodes.push_back(CriticalPathNode{B, nullptr, timingBase(0, 0, 1, clock_period),
+                                         timingBase(0, 0, 1, clock_period),
+                                         timingBase(0, 0, 1, clock_period),
+                                         {}});
+        return Block2Node[B] = nodes.size() - 1;
+    };
+
+    auto inRegion = [&](BasicBlock *B) -> bool {
+        return curLoop ? curLoop->contains(B) : F == B->getParent();
+    };
+
+    // evaluate the node and find its successors
+    auto visitNode = [&](int nodeID) {
+        if (Loop *tmp_Loop = nodes[nodeID].L)
+        {
+            if (DEBUG)
+                *Evaluating_log << "---- traverser arrive Loop: " << tmp_Loop->getName() << " ";
+            if (!curLoop)
+            {
+                // treat the entire outer loop as a block node and get the latency
+                Function2OuterLoops[F].push_back(tmp_Loop);
+                nodes[nodeID].latency = analyzeOuterLoop(tmp_Loop);
+            }
+            else
+                nodes[nodeID].latency = LoopLatency[tmp_Loop->getHeader()];
+            assert(LoopResource.count(tmp_Loop->getHeader()));
+            resourceAccumulator = resourceAccumulator + LoopResource[tmp_Loop->getHeader()];
+
+            // find the successors of the loop by checking its exiting blocks' successors
+            SmallVector<BasicBlock *, 8> tmp_Loop_ExitingBlocks;
+            tmp_Loop->getExitingBlocks(tmp_Loop_ExitingBlocks);
+            for (auto ExitB : tmp_Loop_ExitingBlocks)
+                for (auto B : successors(ExitB))
+                    if (inRegion(B) && !tmp_Loop->contains(B))
+                    {
+                        int succID = getNode(B);
+                        nodes[nodeID].succs.push_back(succID);
+                    }
+        }
+        else
+        {
+            BasicBlock *curBlock = nodes[nodeID].B;
+            if (DEBUG)
+                *Evaluating_log << "---- traverser arrive Block: " << curBlock->getName() << " ";
+            nodes[nodeID].latency = BlockLatencyResourceEvaluation(curBlock);
+            assert(BlockResource.count(curBlock));
+            resourceAccumulator = resourceAccumulator + BlockResource[curBlock];
+
+            for (auto B : successors(curBlock))
+                if (inRegion(B))
+                {
+                    int succID = getNode(B);
+                    nodes[nodeID].succs.push_back(succID);
+                }
+        }
+        if (DEBUG)
+            *Evaluating_log << " latency =  " << nodes[nodeID].latency << "\n";
+    };
+
+    // (2) visit the nodes by DFS, the nodes are evaluated in the same order as the path-based
+    // traversal did, since the evaluation of blocks/loops may depend on the evaluated ones.
+    // An explicit stack is used so large (e.g. unrolled) bodies cannot overflow the call stack.
+    std::vector<int> postOrder;
+    std::vector<bool> visited;
+    std::vector<std::pair<int, unsigned>> DFSStack;
+    BasicBlock *entry = curLoop ? curLoop->getHeader() : &F->getEntryBlock();
+    int entryID = getNode(entry);
+    visited.resize(nodes.size(), false);
+    visited[entryID] = true;
+    visitNode(entryID);
+    DFSStack.push_back(std::make_pair(entryID, 0));
+    while (!DFSStack.empty())
+    {
+        int curID = DFSStack.back().first;
+        unsigned succPos = DFSStack.back().second;
+        if (succPos == nodes[curID].succs.size())
+        {
+            postOrder.push_back(curID);
+            DFSStack.pop_back();
+            continue;
+        }
+        DFSStack.back().second++;
+        int succID = nodes[curID].succs[succPos];
+        if (succID >= (int)visited.size())
+            visited.resize(nodes.size(), false);
+        if (visited[succID])
+            continue;
+        visited[succID] = true;
+        visitNode(succID);
+        DFSStack.push_back(std::make_pair(succID, 0));
+    }
+    assert(postOrder.size() == nodes.size() && "all the created nodes should be visited");
+
+    // (3) compute the critical paths in the reverse post-order
+    std::vector<int> orderPos(nodes.size(), -1);
+    for (int i = 0, e = postOrder.size(); i < e; i++)
+        orderPos[postOrder[e - 1 - i]] = i;
+    for (int i = postOrder.size() - 1; i >= 0; i--)
+    {
+        int curID = postOrder[i];
+        CriticalPathNode &curNode = nodes[curID];
+        curNode.end = curNode.begin + curNode.latency;
+        if (DEBUG)
+            *Evaluating_log << "---- critical path to the end of " << curNode.B->getName()
+                            << " is " << curNode.end << "\n";
+
+        for (auto succID : curNode.succs)
+            if (orderPos[succID] > orderPos[curID] && curNode.end > nodes[succID].begin)
+                nodes[succID].begin = curNode.end;
+    }
+}
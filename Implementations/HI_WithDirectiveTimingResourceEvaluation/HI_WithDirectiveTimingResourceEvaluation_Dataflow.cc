@@ -0,0 +1,567 @@
+#include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include "HI_print.h"
+#include "llvm/Support/MathExtras.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace llvm;
+
+/*
+    evaluate the function applied with dataflow as a network of processes, i.e. the calls of the
+    sub-functions, connected by channels of the arrays:
+    (1) get the processes and the channels from the producers to the consumers of the arrays. A
+        local array written by one process and then read by another one, both in the streaming
+        order, is a FIFO; other arrays bridging the stages are ping-pong buffers.
+    (2) schedule the first invocation of the processes, where the consumers of FIFOs overlap with
+        the producers, and the steady-state II is the largest interval of the processes, i.e. the
+        bottleneck process.
+    (3) evaluate the cost of the FIFOs and ping-pong buffers.
+    the function is evaluated sequentially if its body is not a single block of calls.
+*/
+void HI_WithDirectiveTimingResourceEvaluation::functionDataflowCheck(Function *F)
+{
+    std::string functionDemangleName = demangleFunctionName(F->getName());
+
+    if (F->getName().find(".") != std::string::npos)
+        return;
+
+    bool dataflowEnable = isFunctionDataflow(F);
+
+    if (!dataflowEnable)
+        return;
+
+    // there should NOT be any loop in the function (original loops should be extracted into
+    // sub-functions) and the calls should be in the same block
+    BasicBlock *blockforcallIs = nullptr;
+    for (auto &B : *F)
+    {
+        if (isInLoop(&B))
+        {
+            print_warning("DATAFLOW: loop in function: [" + functionDemangleName +
+                          "], the original loops should be extracted into sub-functions. The "
+                          "function is evaluated without dataflow.");
+            return;
+        }
+        for (auto &I : B)
+        {
+            if (auto callI = dyn_cast<CallInst>(&I))
+            {
+                if (!blockforcallIs)
+                    blockforcallIs = &B;
+                else if (&B != blockforcallIs)
+                {
+                    print_warning("DATAFLOW: call instructions in different branches in "
+                                  "function: [" +
+                                  functionDemangleName +
+                                  "]. The function is evaluated without dataflow.");
+                    return;
+                }
+            }
+        }
+    }
+    if (!blockforcallIs)
+        return;
+
+    if (DEBUG)
+        *Evaluating_log << " Function: [" << functionDemangleName
+                        << "] is applied with Dataflow, checking its II\n";
+
+    // (1) get the processes and the channels
+    std::vector<DataflowProcess> processes;
+    std::vector<DataflowChannel> channels;
+    getDataflowProcessesAndChannels(F, blockforcallIs, processes, channels);
+    if (processes.empty())
+        return;
+
+    // (2) schedule the processes. The block evaluation has ordered the calls accessing the same
+    // target, so the latency is reduced by the overlap of the processes in the dataflow.
+    int sequentialLatency = scheduleDataflowProcesses(processes, channels, /*dataflow*/ false);
+    int dataflowLatency = scheduleDataflowProcesses(processes, channels, /*dataflow*/ true);
+    int bottleneck = 0;
+    for (int i = 0, e = processes.size(); i < e; i++)
+        if (processes[i].interval > processes[bottleneck].interval)
+            bottleneck = i;
+    int II_dataflow = processes[bottleneck].interval;
+    // the intervals come from the evaluation of the sub-functions, which only warns about the
+    // functions it cannot handle, so an invalid II is reported instead of being propagated
+    if (II_dataflow < 1)
+    {
+        print_warning("DATAFLOW: invalid II=" + std::to_string(II_dataflow) + " of function: [" +
+                      functionDemangleName + "], it is evaluated with II=1.");
+        II_dataflow = 1;
+    }
+
+    if (dataflowLatency < sequentialLatency)
+        FunctionLatency[F].latency = std::max(
+            FunctionLatency[F].latency - (sequentialLatency - dataflowLatency), dataflowLatency);
+    FunctionLatency[F].II = II_dataflow;
+
+    std::string bottleneckName =
+        demangleFunctionName(processes[bottleneck].callI->getCalledFunction()->getName());
+    if (DEBUG)
+    {
+        for (auto &process : processes)
+            *Evaluating_log << "    process: [" << process.callI->getCalledFunction()->getName()
+                            << "] latency=" << process.latency
+                            << " interval=" << process.interval << " start=" << process.start
+                            << " finish=" << process.finish << "\n";
+        for (auto &channel : channels)
+            *Evaluating_log << "    channel: [" << channel.target->getName() << "] "
+                            << channel.producer << " -> " << channel.consumer
+                            << (channel.isFIFO ? " FIFO depth=" + std::to_string(channel.depth)
+                                               : std::string(" ping-pong"))
+                            << "\n";
+        *Evaluating_log << " Function: [" << functionDemangleName
+                        << "] is applied with Dataflow, checked its II=" << II_dataflow
+                        << " latency=" << FunctionLatency[F].latency
+                        << " (sequential processes: " << sequentialLatency
+                        << ", overlapped processes: " << dataflowLatency << ")\n";
+    }
+    std::string throughputStr = "";
+    if (clock_period > 0)
+        throughputStr = " (throughput=" + std::to_string(1000.0 / (II_dataflow * clock_period)) +
+                        " M invocations/s)";
+    else
+        print_warning("DATAFLOW: invalid clock period " + clock_period_str + " of function: [" +
+                      functionDemangleName + "], its throughput is not reported.");
+    print_info("Dataflow function: [" + functionDemangleName + "] steady-state II=" +
+               std::to_string(II_dataflow) + " cycles" + throughputStr +
+               ", bottleneck process: [" + bottleneckName + "]");
+    reportDataflowClockAssignment(F, processes, bottleneck);
+
+    // (3) buffer cost of BRAM
+    if (DEBUG)
+        *ArrayLog << " Function: [" << functionDemangleName
+                  << "] is applied with Dataflow, checking its BRAM cost\n";
+
+    std::vector<std::vector<Value *>> stage2arrays;
+    std::map<Value *, int> array2LastStage;
+
+    // extract array in the arguments of the function
+    std::vector<Value *> arrays_need_buffer_curStage;
+    for (auto it = F->arg_begin(), ie = F->arg_end(); it != ie; ++it)
+    {
+        if (it->getType()->isPointerTy())
+        {
+            PointerType *tmp_PtrType = dyn_cast<PointerType>(it->getType());
+            if (tmp_PtrType->getElementType()->isArrayTy() ||
+                tmp_PtrType->getElementType()->isIntegerTy() ||
+                tmp_PtrType->getElementType()->isFloatingPointTy() ||
+                tmp_PtrType->getElementType()->isDoubleTy())
+            {
+                if (isLocalArray(it))
+                    continue;
+                arrays_need_buffer_curStage.push_back(it);
+                array2LastStage[it] = 0;
+            }
+        }
+    }
+    stage2arrays.push_back(arrays_need_buffer_curStage);
+
+    // extract array in the interface of the sub-functions, stage i+1 is the i-th process
+    for (auto &process : processes)
+        stage2arrays.push_back(process.targets);
+
+    resourceBase totalBramCost(0, 0, 0, 0, clock_period);
+
+    int stage_cnt = 0;
+    for (auto stage : stage2arrays)
+    {
+        for (auto tmp_target : stage)
+        {
+            if (isLocalArray(tmp_target))
+                continue;
+            if (array2LastStage.find(tmp_target) == array2LastStage.end())
+            {
+                array2LastStage[tmp_target] = stage_cnt;
+                continue;
+            }
+            if (array2LastStage[tmp_target] == stage_cnt)
+                continue;
+
+            int crossStagesNum = 0;
+            if (array2LastStage[tmp_target] == 0 &&
+                targetAccessPropertyInFunction[std::pair<Value *, Function *>(tmp_target, F)] ==
+                    WriteOnlyInFunction)
+            {
+                // this array is for output. Therefore, it should be buffered to the end of
+                // dataflow
+                crossStagesNum = stage2arrays.size() - stage_cnt;
+            }
+            else
+            {
+                // ignore the interface analysis
+                if (!stage_cnt)
+                    continue;
+
+                CallInst *callI_curStage = processes[stage_cnt - 1].callI;
+
+                // if the array is write-only, it does not need the data from previous stages
+                if (targetAccessPropertyInFunction[std::pair<Value *, Function *>(
+                        tmp_target, callI_curStage->getCalledFunction())] != WriteOnlyInFunction)
+                    crossStagesNum = stage_cnt - array2LastStage[tmp_target];
+            }
+
+            // the array is streamed to the current stage by a FIFO
+            const DataflowChannel *FIFOChannel = nullptr;
+            for (auto &channel : channels)
+                if (channel.isFIFO && channel.target == tmp_target &&
+                    channel.consumer == stage_cnt - 1)
+                    FIFOChannel = &channel;
+
+            if (FIFOChannel)
+            {
+                resourceBase FIFOcost =
+                    getFIFOResource(getElementBitWidth(tmp_target), FIFOChannel->depth);
+                if (DEBUG)
+                    *ArrayLog << " Function: [" << functionDemangleName
+                              << "] is applied with Dataflow, array: [" << tmp_target->getName()
+                              << "] is streamed by a FIFO of depth [" << FIFOChannel->depth
+                              << "] which costs resource: [" << FIFOcost << "]\n";
+                totalBramCost = totalBramCost + FIFOcost;
+            }
+            else if (crossStagesNum)
+            {
+                resourceBase targetBRAMcost(0, 0, 0, 0, clock_period);
+                if (auto allocI = dyn_cast<AllocaInst>(tmp_target))
+                    targetBRAMcost = get_BRAM_Num_For(allocI);
+                else if (auto argV = dyn_cast<Argument>(tmp_target))
+                    targetBRAMcost = get_BRAM_Num_For(argV);
+                else
+                    assert(false && "the array should be generated from arguments or "
+                                    "allocation instruction.\n");
+                if (DEBUG)
+                {
+                    *ArrayLog << " Function: [" << functionDemangleName
+                              << "] is applied with Dataflow, array: [" << tmp_target->getName()
+                              << "] need ping-pong buffer BRAMs.\n";
+                    *ArrayLog << "      The buffer should bridge [" << crossStagesNum
+                              << "] stages\n";
+                    *ArrayLog << "      each buffer for the array will cost resourse: ["
+                              << targetBRAMcost << "] \n";
+                    *ArrayLog << "      all buffers for the array will cost resourse: ["
+                              << 2 * crossStagesNum * targetBRAMcost << "] \n";
+                }
+                totalBramCost = totalBramCost + 2 * crossStagesNum * targetBRAMcost;
+            }
+            array2LastStage[tmp_target] = stage_cnt;
+        }
+        stage_cnt++;
+    }
+
+    FunctionResource[F] = FunctionResource[F] + totalBramCost;
+}
+
+// get the processes (calls) in the block of the dataflow function and the channels between them
+void HI_WithDirectiveTimingResourceEvaluation::getDataflowProcessesAndChannels(
+    Function *F, BasicBlock *blockforcallIs, std::vector<DataflowProcess> &processes,
+    std::vector<DataflowChannel> &channels)
+{
+    for (auto &I : *blockforcallIs)
+    {
+        auto callI = dyn_cast<CallInst>(&I);
+        if (!callI || !callI->getCalledFunction())
+            continue;
+        Function *calledF = callI->getCalledFunction();
+        if (calledF->getName().find("llvm.") != std::string::npos ||
+            calledF->getName().find("HIPartitionMux") != std::string::npos ||
+            FunctionLatency.find(calledF) == FunctionLatency.end())
+            continue;
+
+        DataflowProcess process;
+        process.callI = callI;
+        // the sub-function might be in another clock domain, so its cycles are converted into the
+        // cycles of the clock domain of F
+        timingBase calledTiming = convertClockDomain(FunctionLatency[calledF], F);
+        process.latency = std::max(calledTiming.latency, 1);
+        // a sub-function can take the next input after an II if it is a dataflow function,
+        // otherwise after it finishes
+        process.interval = process.latency;
+        if (isFunctionDataflow(calledF) && FunctionLatency[calledF].II > 0)
+            process.interval = std::max(calledTiming.II, 1);
+        process.start = process.finish = 0;
+        if (Value2Target.find(callI) != Value2Target.end())
+            for (auto target : Value2Target[callI])
+                if (!isLocalArray(target))
+                    process.targets.push_back(target);
+        processes.push_back(process);
+    }
+
+    auto getProperty = [&](Value *target, Function *calledF) -> accessPropertyType {
+        auto it = targetAccessPropertyInFunction.find(std::make_pair(target, calledF));
+        return it == targetAccessPropertyInFunction.end() ? ReadWriteInFunction : it->second;
+    };
+
+    // the consumer reads the data from the last process writing the target
+    std::map<Value *, int> target2LastProducer;
+    std::map<Value *, int> target2AccessNum;
+    for (int i = 0, e = processes.size(); i < e; i++)
+    {
+        Function *calledF = processes[i].callI->getCalledFunction();
+        for (auto target : processes[i].targets)
+        {
+            target2AccessNum[target]++;
+            accessPropertyType property = getProperty(target, calledF);
+            if (property != WriteOnlyInFunction &&
+                target2LastProducer.find(target) != target2LastProducer.end())
+                channels.push_back(
+                    DataflowChannel{target, target2LastProducer[target], i, false, 0});
+            if (property != ReadOnlyInFunction)
+                target2LastProducer[target] = i;
+        }
+    }
+
+    // a FIFO requires a local array with one producer and one consumer, which write and read
+    // each element once in the same order
+    for (auto &channel : channels)
+    {
+        DataflowProcess &producer = processes[channel.producer];
+        DataflowProcess &consumer = processes[channel.consumer];
+        Function *producerF = producer.callI->getCalledFunction();
+        Function *consumerF = consumer.callI->getCalledFunction();
+        if (!isa<AllocaInst>(channel.target) || getFunctionOfValue(channel.target) != F ||
+            target2AccessNum[channel.target] != 2 ||
+            getProperty(channel.target, producerF) != WriteOnlyInFunction ||
+            getProperty(channel.target, consumerF) != ReadOnlyInFunction ||
+            !isStreamingAccess(producerF, channel.target, /*isWrite*/ true) ||
+            !isStreamingAccess(consumerF, channel.target, /*isWrite*/ false))
+            continue;
+        channel.isFIFO = true;
+
+        // the producer writes all the tokens by its finish while the slower consumer has read
+        // (producer latency / consumer latency) of them, and the rest are buffered so the producer
+        // is not stalled
+        HI_ArrayInfo &arrayInfo = Target2ArrayInfo[channel.target];
+        int64_t tokenNum = (int64_t)arrayInfo.dim_size[arrayInfo.num_dims - 1] *
+                           arrayInfo.sub_element_num[arrayInfo.num_dims - 1];
+        int64_t backlog = 0;
+        if (consumer.latency > producer.latency)
+            backlog = (tokenNum * (consumer.latency - producer.latency) + consumer.latency - 1) /
+                      consumer.latency;
+        channel.depth = std::max<int64_t>(2, std::min(backlog, tokenNum));
+    }
+}
+
+// schedule the first invocation of each process and return the latency of the processes. In the
+// dataflow, the consumer of a FIFO starts once the producer writes its first token and finishes
+// after the producer writes the last one, while the consumer of a ping-pong buffer starts after
+// the producer finishes. Sequentially, a process starts after the earlier processes accessing its
+// targets finish.
+int HI_WithDirectiveTimingResourceEvaluation::scheduleDataflowProcesses(
+    std::vector<DataflowProcess> &processes, const std::vector<DataflowChannel> &channels,
+    bool dataflow)
+{
+    int latency = 0;
+    for (int i = 0, e = processes.size(); i < e; i++)
+    {
+        DataflowProcess &process = processes[i];
+        process.start = 0;
+        int finishBound = 0;
+        if (dataflow)
+        {
+            for (auto &channel : channels)
+            {
+                if (channel.consumer != i)
+                    continue;
+                DataflowProcess &producer = processes[channel.producer];
+                if (channel.isFIFO)
+                {
+                    process.start = std::max(process.start, producer.start + 1);
+                    finishBound = std::max(finishBound, producer.finish + 1);
+                }
+                else
+                    process.start = std::max(process.start, producer.finish);
+            }
+        }
+        else
+        {
+            for (int j = 0; j < i; j++)
+                for (auto target : process.targets)
+                    if (std::find(processes[j].targets.begin(), processes[j].targets.end(),
+                                  target) != processes[j].targets.end())
+                        process.start = std::max(process.start, processes[j].finish);
+        }
+        process.finish = std::max(process.start + process.latency, finishBound);
+        latency = std::max(latency, process.finish);
+    }
+    return latency;
+}
+
+// check whether the only access to the target in the function is a load (or store) visiting each
+// element once in the increasing order of the offset, i.e. offset 0, 1, 2 ...
+bool HI_WithDirectiveTimingResourceEvaluation::isStreamingAccess(Function *F, Value *target,
+                                                                 bool isWrite)
+{
+    Instruction *accessI = nullptr;
+    for (auto &B : *F)
+    {
+        for (auto &I : B)
+        {
+            if (auto callI = dyn_cast<CallInst>(&I))
+            {
+                Function *calledF = callI->getCalledFunction();
+                if (!calledF || calledF->getName().find("llvm.") != std::string::npos ||
+                    calledF->getName().find("HIPartitionMux") != std::string::npos)
+                    continue;
+                for (auto tmp_target : getTargetsFromInst(callI))
+                    if (tmp_target == target)
+                        return false;
+            }
+            else if (isa<LoadInst>(&I) || isa<StoreInst>(&I))
+            {
+                if (getTargetFromInst(&I) != target)
+                    continue;
+                if (isa<StoreInst>(&I) != isWrite || accessI)
+                    return false;
+                accessI = &I;
+            }
+        }
+    }
+    if (!accessI)
+        return false;
+
+    HI_AccessInfo info = getAccessInfoForAccessInst(accessI);
+    if (info.unpredictable || info.initial_offset != 0)
+        return false;
+
+    // each loop should move the offset over the elements visited by the loops inside it
+    int64_t visitedNum = 1;
+    for (int L = 0; L < info.reverse_loop_dep; L++)
+    {
+        if (info.trip_count[L] <= 0)
+            return false;
+        if (info.trip_count[L] == 1)
+            continue;
+        if (info.inc_index[L] != visitedNum)
+            return false;
+        visitedNum *= info.trip_count[L];
+    }
+    return visitedNum ==
+           (int64_t)info.dim_size[info.num_dims - 1] * info.sub_element_num[info.num_dims - 1];
+}
+
+// get the bitwidth of the elements of the target array
+int HI_WithDirectiveTimingResourceEvaluation::getElementBitWidth(Value *target)
+{
+    Type *tmp_type = Target2ArrayInfo[target].elementType;
+    int BW = 0;
+    if (tmp_type->isIntegerTy())
+        BW = tmp_type->getIntegerBitWidth();
+    else if (tmp_type->isFloatTy())
+        BW = 32;
+    else if (tmp_type->isDoubleTy())
+        BW = 64;
+    assert(BW != 0 && "we should get BW for the basic element type.\n");
+    return BW;
+}
+
+// get the resource of a FIFO: a shallow FIFO is a shift register in LUTs (32 entries per LUT)
+// while a deep one is in BRAMs. The read/write pointers and the full/empty flags are the control.
+HI_WithDirectiveTimingResourceEvaluation::resourceBase
+HI_WithDirectiveTimingResourceEvaluation::getFIFOResource(int width, int depth)
+{
+    int pointerWidth = std::max(1u, Log2_32_Ceil(depth));
+    resourceBase res(0, 0, 2 * pointerWidth + 2, 2 * pointerWidth + 4, clock_period);
+    if (width * depth <= 1024)
+    {
+        res.LUT += width * ((depth + 31) / 32);
+        res.FF += width;
+    }
+    else
+        res = res + get_BRAM_Num_For(width, depth);
+    return res;
+}
+
+/*
+    report the clock assignment of the processes for the throughput of the dataflow function. The
+    steady-state II is bounded by the interval (in ns) of the bottleneck process, so any other
+    process can run at the slowest library clock keeping its interval within the bound, which
+    saves the registers for the pipelining without losing throughput. The cycles of a process are
+    assumed unchanged at the slower clock, which is conservative since a longer period chains more
+    operations in a cycle. The bottleneck is the only process worth a faster clock, and the period
+    balancing it with the next slowest process is reported for the exploration.
+*/
+void HI_WithDirectiveTimingResourceEvaluation::reportDataflowClockAssignment(
+    Function *F, const std::vector<DataflowProcess> &processes, int bottleneck)
+{
+    std::string functionDemangleName = demangleFunctionName(F->getName());
+
+    // the interval of each process in its own clock domain
+    std::vector<int> intervals;
+    std::vector<double> periods;
+    double II_ns = 0;
+    for (auto &process : processes)
+    {
+        Function *calledF = process.callI->getCalledFunction();
+        int interval = std::max(FunctionLatency[calledF].latency, 1);
+        if (isFunctionDataflow(calledF) && FunctionLatency[calledF].II > 0)
+            interval = FunctionLatency[calledF].II;
+        intervals.push_back(interval);
+        periods.push_back(std::stod(getFunctionClockStr(calledF)));
+        II_ns = std::max(II_ns, interval * periods.back());
+    }
+
+    // the interval of the next slowest process, which bounds the gain of speeding the bottleneck
+    double nextII_ns = 0;
+    int nextBottleneck = -1;
+    for (int i = 0, e = processes.size(); i < e; i++)
+    {
+        if (i != bottleneck && intervals[i] * periods[i] > nextII_ns)
+        {
+            nextII_ns = intervals[i] * periods[i];
+            nextBottleneck = i;
+        }
+    }
+
+    print_info("Dataflow function: [" + functionDemangleName +
+               "] throughput-optimal clock assignment (II=" + std::to_string(II_ns) + " ns):");
+    for (int i = 0, e = processes.size(); i < e; i++)
+    {
+        std::string processName =
+            demangleFunctionName(processes[i].callI->getCalledFunction()->getName());
+        std::string printOut = "    process: [" + processName + "] interval=" +
+                               std::to_string(intervals[i]) + " cycles at period " +
+                               std::to_string(periods[i]) + " ns";
+        if (i == bottleneck)
+        {
+            // the longest library period bringing the bottleneck down to the next slowest
+            // process, otherwise the shortest one
+            int balancedClock = -1, shortestClock = -1;
+            for (int c = 0; c < clockNum; c++)
+            {
+                if (clockPeriod[c] >= periods[i])
+                    continue;
+                if (intervals[i] * clockPeriod[c] <= nextII_ns &&
+                    (balancedClock < 0 || clockPeriod[c] > clockPeriod[balancedClock]))
+                    balancedClock = c;
+                if (shortestClock < 0 || clockPeriod[c] < clockPeriod[shortestClock])
+                    shortestClock = c;
+            }
+            if (balancedClock < 0)
+                balancedClock = shortestClock;
+            printOut += " is the bottleneck";
+            if (balancedClock >= 0 && nextBottleneck >= 0)
+                printOut += ", try \"clock_domain function=" + processName + " period=" +
+                            clockStrs[balancedClock] + "\" to balance it with process: [" +
+                            demangleFunctionName(
+                                processes[nextBottleneck].callI->getCalledFunction()->getName()) +
+                            "]";
+        }
+        else
+        {
+            // the slowest library period keeping the interval of the process within the II
+            int slowestClock = -1;
+            for (int c = 0; c < clockNum; c++)
+                if (clockPeriod[c] > periods[i] && intervals[i] * clockPeriod[c] <= II_ns &&
+                    (slowestClock < 0 || clockPeriod[c] > clockPeriod[slowestClock]))
+                    slowestClock = c;
+            if (slowestClock >= 0)
+                printOut += " -> try \"clock_domain function=" + processName + " period=" +
+                            clockStrs[slowestClock] + "\"";
+        }
+        print_info(printOut);
+    }
+}
@@ -0,0 +1,246 @@
+#include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include "HI_print.h"
+#include "llvm/ADT/Hashing.h"
+#include "llvm/IR/Instructions.h"
+#include "llvm/IR/Metadata.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace llvm;
+
+/*
+    share the evaluation between the identical functions. HI_FunctionInstantiation clones a
+    sub-function for each of its call sites, so a kernel calling a helper many times gets many
+    instances of it, which are scheduled and bound in the same way. A function is identical to an
+    evaluated one if:
+    (1) they are instances of the same function, since the directives (e.g. the clock domain and
+        the loop pragmas) are specified with the function name;
+    (2) their blocks have the same operations with the same operands, where the sub-functions
+        called are compared by their representatives;
+    (3) the target arrays accessed by them are implemented in the same way, i.e. the same shape,
+        partitions and ports, and the accesses to different arrays in one function are to
+        different arrays in the other one.
+    The latency and resource of the function are taken from the evaluated one. The resource is
+    still counted for each call of the function by its caller, and the states related to its own
+    accesses (e.g. the partitions they visit) are recorded for it. The evaluated functions are
+    bucketed by their structure hashes, so a function is only compared with the ones in its bucket.
+*/
+
+// get the hash of the structure of the function, i.e. the operations in its blocks and the
+// sub-functions it calls (represented by their representatives)
+size_t HI_WithDirectiveTimingResourceEvaluation::getFunctionStructureHash(Function *F)
+{
+    hash_code hash =
+        hash_combine(demangleFunctionName(F->getName()), F->getFunctionType(), F->size());
+    for (auto &B : *F)
+    {
+        hash = hash_combine(hash, B.size());
+        for (auto &I : B)
+        {
+            hash = hash_combine(hash, I.getOpcode(), I.getType(), I.getNumOperands());
+            if (auto callI = dyn_cast<CallInst>(&I))
+                if (callI->getCalledFunction())
+                    hash =
+                        hash_combine(hash, getRepresentativeFunction(callI->getCalledFunction()));
+        }
+    }
+    return hash;
+}
+
+// get the representative of the function, which it shares the evaluation with, or itself
+Function *HI_WithDirectiveTimingResourceEvaluation::getRepresentativeFunction(Function *F)
+{
+    auto it = Function2Representative.find(F);
+    if (it == Function2Representative.end())
+        return F;
+    return it->second;
+}
+
+// check whether F is identical to the evaluated function rep, including the partitions of the
+// arrays accessed via their arguments, and map the targets accessed by rep to the ones of F
+bool HI_WithDirectiveTimingResourceEvaluation::isFunctionIdenticalTo(
+    Function *F, Function *rep, std::map<Value *, Value *> &target2Target)
+{
+    if (demangleFunctionName(F->getName()) != demangleFunctionName(rep->getName()) ||
+        getFunctionClockStr(F) != getFunctionClockStr(rep) ||
+        F->getFunctionType() != rep->getFunctionType() || F->size() != rep->size())
+        return false;
+
+    // (1) map the arguments, blocks and instructions of rep to the ones of F by their positions
+    DenseMap<Value *, Value *> rep2F;
+    for (auto repArg = rep->arg_begin(), arg = F->arg_begin(); arg != F->arg_end(); ++repArg, ++arg)
+        rep2F[&*repArg] = &*arg;
+    for (auto repB = rep->begin(), B = F->begin(); B != F->end(); ++repB, ++B)
+    {
+        if (repB->size() != B->size())
+            return false;
+        rep2F[&*repB] = &*B;
+        for (auto repI = repB->begin(), I = B->begin(); I != B->end(); ++repI, ++I)
+            rep2F[&*repI] = &*I;
+    }
+
+    // (2) compare the operations and their operands
+    auto isSameOperand = [&](Value *repV, Value *V) -> bool {
+        auto it = rep2F.find(repV);
+        if (it != rep2F.end())
+            return it->second == V;
+        if (auto repCalledF = dyn_cast<Function>(repV))
+        {
+            auto calledF = dyn_cast<Function>(V);
+            return calledF &&
+                   getRepresentativeFunction(calledF) == getRepresentativeFunction(repCalledF);
+        }
+        // the debug information does not affect the evaluation
+        if (isa<MetadataAsValue>(repV) && isa<MetadataAsValue>(V))
+            return true;
+        return repV == V;
+    };
+    for (auto &repB : *rep)
+    {
+        for (auto &repI : repB)
+        {
+            Instruction *I = cast<Instruction>(rep2F[&repI]);
+            if (!I->isSameOperationAs(&repI))
+                return false;
+            for (int i = 0, e = repI.getNumOperands(); i < e; i++)
+                if (!isSameOperand(repI.getOperand(i), I->getOperand(i)))
+                    return false;
+            if (auto repPHI = dyn_cast<PHINode>(&repI))
+                for (int i = 0, e = repPHI->getNumIncomingValues(); i < e; i++)
+                    if (rep2F[repPHI->getIncomingBlock(i)] != cast<PHINode>(I)->getIncomingBlock(i))
+                        return false;
+        }
+    }
+
+    // (3) map the targets accessed by rep to the ones accessed by F one-to-one, and the mapped
+    // targets should be implemented in the same way
+    auto isSameArray = [&](Value *repTarget, Value *target) -> bool {
+        if (Target2ArrayInfo.find(repTarget) == Target2ArrayInfo.end() ||
+            Target2ArrayInfo.find(target) == Target2ArrayInfo.end())
+            return repTarget == target;
+        HI_ArrayInfo &repInfo = Target2ArrayInfo[repTarget];
+        HI_ArrayInfo &info = Target2ArrayInfo[target];
+        if (repInfo.num_dims != info.num_dims || repInfo.isArgument != info.isArgument ||
+            repInfo.completePartition != info.completePartition ||
+            repInfo.elementType != info.elementType || repInfo.port_num != info.port_num)
+            return false;
+        for (int i = 0; i < repInfo.num_dims; i++)
+            if (repInfo.dim_size[i] != info.dim_size[i] ||
+                repInfo.sub_element_num[i] != info.sub_element_num[i] ||
+                repInfo.partition_size[i] != info.partition_size[i] ||
+                repInfo.cyclic[i] != info.cyclic[i])
+                return false;
+        return true;
+    };
+    std::map<Value *, Value *> target2RepTarget;
+    auto mapTarget = [&](Value *repTarget, Value *target) -> bool {
+        if (target2Target.find(repTarget) != target2Target.end() ||
+            target2RepTarget.find(target) != target2RepTarget.end())
+            return target2Target[repTarget] == target && target2RepTarget[target] == repTarget;
+        if (!isSameArray(repTarget, target))
+            return false;
+        target2Target[repTarget] = target;
+        target2RepTarget[target] = repTarget;
+        return true;
+    };
+    target2Target.clear();
+    for (auto &repB : *rep)
+    {
+        for (auto &repI : repB)
+        {
+            Instruction *I = cast<Instruction>(rep2F[&repI]);
+            auto repAccess_it = Access2TargetMap.find(&repI);
+            auto access_it = Access2TargetMap.find(I);
+            if ((repAccess_it == Access2TargetMap.end()) != (access_it == Access2TargetMap.end()))
+                return false;
+            if (repAccess_it == Access2TargetMap.end())
+                continue;
+            std::set<Value *> repTargets(repAccess_it->second.begin(), repAccess_it->second.end());
+            std::set<Value *> targets(access_it->second.begin(), access_it->second.end());
+            if (repTargets.size() != targets.size())
+                return false;
+            if (repTargets.size() == 1)
+            {
+                if (!mapTarget(*repTargets.begin(), *targets.begin()))
+                    return false;
+            }
+            else
+            {
+                // the targets of an access via PHINode/Select cannot be paired, so they should be
+                // the same ones
+                if (repTargets != targets)
+                    return false;
+                for (auto target : repTargets)
+                    if (!mapTarget(target, target))
+                        return false;
+            }
+        }
+    }
+
+    // the partitions accessed by rep should be mapped to the ones of F
+    for (auto &partition_cnt : Function2PartitionCnt[rep])
+        if (target2Target.find(partition_cnt.first.target) == target2Target.end())
+            return false;
+    return true;
+}
+
+// find an evaluated function identical to F, which F can share the evaluation with
+Function *HI_WithDirectiveTimingResourceEvaluation::findIdenticalEvaluatedFunction(
+    Function *F, std::map<Value *, Value *> &target2Target)
+{
+    auto it = StructureHash2EvaluatedFunctions.find(getFunctionStructureHash(F));
+    if (it == StructureHash2EvaluatedFunctions.end())
+        return nullptr;
+    for (auto rep : it->second)
+        if (isFunctionIdenticalTo(F, rep, target2Target))
+            return rep;
+    return nullptr;
+}
+
+// evaluate F by the evaluation of the identical function rep, while the states related to the
+// accesses in F (e.g. the partitions they access) are recorded for F itself
+void HI_WithDirectiveTimingResourceEvaluation::shareFunctionEvaluation(
+    Function *F, Function *rep, std::map<Value *, Value *> &target2Target)
+{
+    if (DEBUG)
+        *Evaluating_log << "Function " << F->getName()
+                        << " shares the evaluation of the identical function " << rep->getName()
+                        << "\n";
+
+    Function2Representative[F] = rep;
+    FunctionLatency[F] = FunctionLatency[rep];
+    FunctionResource[F] = FunctionResource[rep];
+
+    // the accesses in F visit the partitions of the targets of F
+    for (auto &B : *F)
+    {
+        for (auto &I : B)
+        {
+            if (!isa<LoadInst>(&I) && !isa<StoreInst>(&I))
+                continue;
+            std::vector<partition_info> target_partitions = getTargetPartitionsForAccess(&I);
+            checkPartitionBenefit(target_partitions, &I);
+            Inst2Partitions[&I] = target_partitions;
+        }
+    }
+    for (auto &partition_cnt : Function2PartitionCnt[rep])
+    {
+        partition_info target_partition = partition_cnt.first;
+        target_partition.target = target2Target[target_partition.target];
+        std::pair<int, int> &cnt = partition2cnt[target_partition];
+        cnt.first += partition_cnt.second.first;
+        cnt.second += partition_cnt.second.second;
+    }
+
+    // analyze the access property of the array targets in the function
+    accessPropertyAnalysis_Function(F);
+
+    FuncName2Latency[F->getName()] = FunctionLatency[F];
+    FuncName2Resource[F->getName()] = FunctionResource[F];
+    FunctionEvaluated.insert(F);
+    for (auto tmp_Loop : LI->getLoopsInPreorder())
+        FuncName2LoopIRNames[F->getName()].push_back(tmp_Loop->getHeader()->getName());
+}
@@ -34,28 +34,32 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
     }
     else if (FPToUIInst *FTU = dyn_cast<FPToUIInst>(I))
     {
-        result = get_inst_TimingInfo_result("fptoui", FTU->getType()->getIntegerBitWidth(),
-                                            FTU->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::FPToUI),
+                                            FTU->getType()->getIntegerBitWidth(),
+                                            FTU->getType()->getIntegerBitWidth(), clock_period_ID);
         return result;
     }
     else if (FPToSIInst *FTS = dyn_cast<FPToSIInst>(I))
     {
-        result = get_inst_TimingInfo_result("fptosi", FTS->getType()->getIntegerBitWidth(),
-                                            FTS->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::FPToSI),
+                                            FTS->getType()->getIntegerBitWidth(),
+                                            FTS->getType()->getIntegerBitWidth(), clock_period_ID);
         return result;
     }
     else if (UIToFPInst *UTF = dyn_cast<UIToFPInst>(I))
     {
         Value *op1 = UTF->getOperand(0);
-        result = get_inst_TimingInfo_result("uitofp", op1->getType()->getIntegerBitWidth(),
-                                            op1->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::UIToFP),
+                                            op1->getType()->getIntegerBitWidth(),
+                                            op1->getType()->getIntegerBitWidth(), clock_period_ID);
         return result;
     }
     else if (SIToFPInst *STF = dyn_cast<SIToFPInst>(I))
     {
         Value *op1 = STF->getOperand(0);
-        result = get_inst_TimingInfo_result("sitofp", op1->getType()->getIntegerBitWidth(),
-                                            op1->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::SIToFP),
+                                            op1->getType()->getIntegerBitWidth(),
+                                            op1->getType()->getIntegerBitWidth(), clock_period_ID);
         return result;
     }
     else if (ZExtInst *ZEXTI = dyn_cast<ZExtInst>(
@@ -84,9 +88,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
         if (Constant *tmpop = dyn_cast<Constant>(op1))
             return result;
         {
-            result =
-                get_inst_TimingInfo_result("shl", op1->getType()->getIntegerBitWidth(),
-                                           SHLI->getType()->getIntegerBitWidth(), clock_period_str);
+            result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Shl),
+                                                op1->getType()->getIntegerBitWidth(),
+                                                SHLI->getType()->getIntegerBitWidth(),
+                                                clock_period_ID);
             return result;
         }
     }
@@ -98,9 +103,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
             return result;
         else
         {
-            result = get_inst_TimingInfo_result("lshr", op1->getType()->getIntegerBitWidth(),
+            result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::LShr),
+                                                op1->getType()->getIntegerBitWidth(),
                                                 LSHRI->getType()->getIntegerBitWidth(),
-                                                clock_period_str);
+                                                clock_period_ID);
             ;
             return result;
         }
@@ -113,9 +119,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
             return result;
         else
         {
-            result = get_inst_TimingInfo_result("ashr", op1->getType()->getIntegerBitWidth(),
+            result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::AShr),
+                                                op1->getType()->getIntegerBitWidth(),
                                                 ASHRI->getType()->getIntegerBitWidth(),
-                                                clock_period_str);
+                                                clock_period_ID);
             ;
             return result;
         }
@@ -124,11 +131,8 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
     {
         // for binary operator, we need to consider whether it is a operator for integer or
         // floating-point value
-        std::string opcodeInput;
         int oprandBitWidth;
         int resBitWidth;
-        std::string opcode_str(BinO->getOpcodeName());
-        std::transform(opcode_str.begin(), opcode_str.end(), opcode_str.begin(), ::tolower);
         Value *op1 = BinO->getOperand(1);
         if (BinO->getType()->isIntegerTy())
         {
@@ -139,11 +143,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
         {
             oprandBitWidth = -1;
             resBitWidth = -1;
-            // for floating operator, we need to consider whether it is a operator for float value
-            // or double value
-            if (BinO->getType()->isDoubleTy() && opcode_str[0] == 'f')
-                opcode_str[0] = 'd';
         }
+        // for floating operator, we need to consider whether it is a operator for float value
+        // or double value
+        int opcodeID = getLibOpcodeID(BinO->getOpcode(), BinO->getType()->isDoubleTy());
 
         // check Add for IntToPtr
         if (BinO->getOpcode() == Instruction::Add)
@@ -160,7 +163,7 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
         }
 
         result =
-            get_inst_TimingInfo_result(opcode_str, oprandBitWidth, resBitWidth, clock_period_str);
+            get_inst_TimingInfo_result(opcodeID, oprandBitWidth, resBitWidth, clock_period_ID);
         ;
         return result;
     }
@@ -172,27 +175,31 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
         Value *op1 = ICI->getOperand(1);
         oprandBitWidth = op1->getType()->getIntegerBitWidth();
         resBitWidth = oprandBitWidth;
-        result = get_inst_TimingInfo_result("icmp", oprandBitWidth, resBitWidth, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::ICmp), oprandBitWidth,
+                                            resBitWidth, clock_period_ID);
         ;
         return result;
     }
     else if (FCmpInst *FI = dyn_cast<FCmpInst>(I))
     {
-        result = get_inst_TimingInfo_result("fcmp", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::FCmp), -1, -1,
+                                            clock_period_ID);
         ;
         return result;
     }
     ////////////////////////////// Memory Operations /////////////////////////
     else if (StoreInst *SI = dyn_cast<StoreInst>(I))
     {
-        result = get_inst_TimingInfo_result("store", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Store), -1, -1,
+                                            clock_period_ID);
         if (LoadStore_Thredhold != 2)
             result.strict_timing = true;
         return result;
     }
     else if (LoadInst *LI = dyn_cast<LoadInst>(I))
     {
-        result = get_inst_TimingInfo_result("load", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Load), -1, -1,
+                                            clock_period_ID);
         return result;
     }
     else if (AllocaInst *AI = dyn_cast<AllocaInst>(I))
@@ -261,10 +268,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
                             if (addrOffsetI)
                             {
                                 result = result + get_inst_TimingInfo_result(
-                                                      "urem",
+                                                      getLibOpcodeID(Instruction::URem),
                                                       addrOffsetI->getType()->getIntegerBitWidth(),
                                                       addrOffsetI->getType()->getIntegerBitWidth(),
-                                                      clock_period_str);
+                                                      clock_period_ID);
                                 ;
                                 if (DEBUG)
                                     *Evaluating_log
@@ -284,17 +291,20 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
         if (DEBUG)
             *Evaluating_log << " Going into subfunction: " << CI->getCalledFunction()->getName()
                             << "\n";
-        result = analyzeFunction(CI->getCalledFunction());
+        // the sub-function might be in another clock domain
+        result = convertClockDomain(analyzeFunction(CI->getCalledFunction()), CI->getFunction());
         return result;
     }
     else if (BranchInst *BI = dyn_cast<BranchInst>(I))
     {
-        result = get_inst_TimingInfo_result("br", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Br), -1, -1,
+                                            clock_period_ID);
         return result;
     }
     else if (ReturnInst *RI = dyn_cast<ReturnInst>(I))
     {
-        result = get_inst_TimingInfo_result("ret", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Ret), -1, -1,
+                                            clock_period_ID);
         return result;
     }
     else if (SelectInst *SeI = dyn_cast<SelectInst>(I))
@@ -304,7 +314,8 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionLatency(Instruction *I)
     }
     else if (GetElementPtrInst *GEP = dyn_cast<GetElementPtrInst>(I))
     {
-        result = get_inst_TimingInfo_result("getelementptr", -1, -1, clock_period_str);
+        result = get_inst_TimingInfo_result(getLibOpcodeID(Instruction::GetElementPtr), -1, -1,
+                                            clock_period_ID);
         return result;
     }
     else
@@ -362,8 +373,8 @@ bool HI_WithDirectiveTimingResourceEvaluation::isTernaryAddpossible(Instruction
     {
         if (PredI->getOpcode() == Instruction::Add || PredI->getOpcode() == Instruction::Sub)
         {
-            if (checkInfoAvailability("tadd", PredI->getType()->getIntegerBitWidth(),
-                                      PredI->getType()->getIntegerBitWidth(), clock_period_str))
+            if (checkInfoAvailability(taddLibID, PredI->getType()->getIntegerBitWidth(),
+                                      PredI->getType()->getIntegerBitWidth(), clock_period_ID))
             {
                 return true;
             }
@@ -380,8 +391,8 @@ HI_WithDirectiveTimingResourceEvaluation::getPartialTimingOverhead(Instruction *
     if (isTernaryAddpossible(PredI, I))
     {
         timingBase overallTiming =
-            get_inst_TimingInfo_result("tadd", PredI->getType()->getIntegerBitWidth(),
-                                       PredI->getType()->getIntegerBitWidth(), clock_period_str);
+            get_inst_TimingInfo_result(taddLibID, PredI->getType()->getIntegerBitWidth(),
+                                       PredI->getType()->getIntegerBitWidth(), clock_period_ID);
         timingBase basicTiming = getInstructionLatency(PredI);
         return timingBase(overallTiming.latency - basicTiming.latency,
                           overallTiming.timing - basicTiming.timing, basicTiming.II,
@@ -397,8 +408,8 @@ HI_WithDirectiveTimingResourceEvaluation::getPartialResourceOverhead(Instruction
     if (isTernaryAddpossible(PredI, I))
     {
         resourceBase overallResource =
-            get_inst_ResourceInfo_result("tadd", PredI->getType()->getIntegerBitWidth(),
-                                         PredI->getType()->getIntegerBitWidth(), clock_period_str);
+            get_inst_ResourceInfo_result(taddLibID, PredI->getType()->getIntegerBitWidth(),
+                                         PredI->getType()->getIntegerBitWidth(), clock_period_ID);
         resourceBase basicResource = getInstructionResource(PredI);
         return resourceBase(
             overallResource.DSP - basicResource.DSP, overallResource.FF - basicResource.FF,
@@ -567,32 +578,36 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
     }
     else if (FPToUIInst *FTU = dyn_cast<FPToUIInst>(I))
     {
-        result =
-            get_inst_ResourceInfo_result("fptoui", FTU->getType()->getIntegerBitWidth(),
-                                         FTU->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::FPToUI),
+                                              FTU->getType()->getIntegerBitWidth(),
+                                              FTU->getType()->getIntegerBitWidth(),
+                                              clock_period_ID);
         return result;
     }
     else if (FPToSIInst *FTS = dyn_cast<FPToSIInst>(I))
     {
-        result =
-            get_inst_ResourceInfo_result("fptosi", FTS->getType()->getIntegerBitWidth(),
-                                         FTS->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::FPToSI),
+                                              FTS->getType()->getIntegerBitWidth(),
+                                              FTS->getType()->getIntegerBitWidth(),
+                                              clock_period_ID);
         return result;
     }
     else if (UIToFPInst *UTF = dyn_cast<UIToFPInst>(I))
     {
         Value *op1 = UTF->getOperand(0);
-        result =
-            get_inst_ResourceInfo_result("uitofp", op1->getType()->getIntegerBitWidth(),
-                                         op1->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::UIToFP),
+                                              op1->getType()->getIntegerBitWidth(),
+                                              op1->getType()->getIntegerBitWidth(),
+                                              clock_period_ID);
         return result;
     }
     else if (SIToFPInst *STF = dyn_cast<SIToFPInst>(I))
     {
         Value *op1 = STF->getOperand(0);
-        result =
-            get_inst_ResourceInfo_result("sitofp", op1->getType()->getIntegerBitWidth(),
-                                         op1->getType()->getIntegerBitWidth(), clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::SIToFP),
+                                              op1->getType()->getIntegerBitWidth(),
+                                              op1->getType()->getIntegerBitWidth(),
+                                              clock_period_ID);
         return result;
     }
     else if (ZExtInst *ZEXTI = dyn_cast<ZExtInst>(
@@ -621,9 +636,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
         if (Constant *tmpop = dyn_cast<Constant>(op1))
             return result;
         {
-            result = get_inst_ResourceInfo_result("shl", op1->getType()->getIntegerBitWidth(),
+            result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::Shl),
+                                                  op1->getType()->getIntegerBitWidth(),
                                                   SHLI->getType()->getIntegerBitWidth(),
-                                                  clock_period_str);
+                                                  clock_period_ID);
             return result;
         }
     }
@@ -635,9 +651,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
             return result;
         else
         {
-            result = get_inst_ResourceInfo_result("lshr", op1->getType()->getIntegerBitWidth(),
+            result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::LShr),
+                                                  op1->getType()->getIntegerBitWidth(),
                                                   LSHRI->getType()->getIntegerBitWidth(),
-                                                  clock_period_str);
+                                                  clock_period_ID);
             ;
             return result;
         }
@@ -650,9 +667,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
             return result;
         else
         {
-            result = get_inst_ResourceInfo_result("ashr", op1->getType()->getIntegerBitWidth(),
+            result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::AShr),
+                                                  op1->getType()->getIntegerBitWidth(),
                                                   ASHRI->getType()->getIntegerBitWidth(),
-                                                  clock_period_str);
+                                                  clock_period_ID);
             ;
             return result;
         }
@@ -661,11 +679,8 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
     {
         // for binary operator, we need to consider whether it is a operator for integer or
         // floating-point value
-        std::string opcodeInput;
         int oprandBitWidth;
         int resBitWidth;
-        std::string opcode_str(BinO->getOpcodeName());
-        std::transform(opcode_str.begin(), opcode_str.end(), opcode_str.begin(), ::tolower);
         Value *op1 = BinO->getOperand(1);
         if (BinO->getType()->isIntegerTy())
         {
@@ -676,11 +691,10 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
         {
             oprandBitWidth = -1;
             resBitWidth = -1;
-            // for floating operator, we need to consider whether it is a operator for float value
-            // or double value
-            if (BinO->getType()->isDoubleTy() && opcode_str[0] == 'f')
-                opcode_str[0] = 'd';
         }
+        // for floating operator, we need to consider whether it is a operator for float value
+        // or double value
+        int opcodeID = getLibOpcodeID(BinO->getOpcode(), BinO->getType()->isDoubleTy());
 
         // check Add for IntToPtr
         if (BinO->getOpcode() == Instruction::Add)
@@ -697,7 +711,7 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
         }
 
         result =
-            get_inst_ResourceInfo_result(opcode_str, oprandBitWidth, resBitWidth, clock_period_str);
+            get_inst_ResourceInfo_result(opcodeID, oprandBitWidth, resBitWidth, clock_period_ID);
         ;
         return result;
     }
@@ -709,26 +723,29 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
         Value *op1 = ICI->getOperand(1);
         oprandBitWidth = op1->getType()->getIntegerBitWidth();
         resBitWidth = oprandBitWidth;
-        result =
-            get_inst_ResourceInfo_result("icmp", oprandBitWidth, resBitWidth, clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::ICmp), oprandBitWidth,
+                                              resBitWidth, clock_period_ID);
         ;
         return result;
     }
     else if (FCmpInst *FI = dyn_cast<FCmpInst>(I))
     {
-        result = get_inst_ResourceInfo_result("fcmp", -1, -1, clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::FCmp), -1, -1,
+                                              clock_period_ID);
         ;
         return result;
     }
     ////////////////////////////// Memory Operations /////////////////////////
     else if (StoreInst *SI = dyn_cast<StoreInst>(I))
     {
-        result = get_inst_ResourceInfo_result("store", -1, -1, clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::Store), -1, -1,
+                                              clock_period_ID);
         return result;
     }
     else if (LoadInst *LI = dyn_cast<LoadInst>(I))
     {
-        result = get_inst_ResourceInfo_result("load", -1, -1, clock_period_str);
+        result = get_inst_ResourceInfo_result(getLibOpcodeID(Instruction::Load), -1, -1,
+                                              clock_period_ID);
         return result;
     }
     else if (AllocaInst *AI = dyn_cast<AllocaInst>(I))
@@ -753,6 +770,7 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
             *Evaluating_log << " Going into subfunction: " << CI->getCalledFunction()->getName()
                             << "\n";
         result = getFunctionResource(CI->getCalledFunction());
+        result.clock_period = clock_period; // the sub-function might be in another clock domain
 
         for (int i = 0; i < CI->getNumArgOperands(); i++)
         {
@@ -836,7 +854,7 @@ HI_WithDirectiveTimingResourceEvaluation::getInstructionResource(Instruction *I)
 // evaluate the number of FF needed by the instruction
 HI_WithDirectiveTimingResourceEvaluation::resourceBase
 HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
-    std::map<Instruction *, timingBase> &cur_InstructionCriticalPath, Instruction *I)
+    HI_BlockInstView<timingBase> &cur_InstructionCriticalPath, Instruction *I)
 {
     resourceBase res(0, 0, 0, clock_period);
     if (DEBUG)
@@ -884,8 +902,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
 
                         if (BlockContain(I->getParent(), l2_pred))
                         {
-                            if (cur_InstructionCriticalPath.find(l2_pred) !=
-                                cur_InstructionCriticalPath.end())
+                            if (cur_InstructionCriticalPath.count(l2_pred))
                                 if (cur_InstructionCriticalPath[l2_pred].latency ==
                                     (cur_InstructionCriticalPath[I] - getInstructionLatency(I))
                                         .latency) // WARNING: there are instructions with negative
@@ -949,7 +966,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
             if (DEBUG)
                 *FF_log << "---- checking the register for data\n";
 
-            if (cur_InstructionCriticalPath.find(I_Pred) != cur_InstructionCriticalPath.end())
+            if (cur_InstructionCriticalPath.count(I_Pred))
             {
                 if (checkLoadOpRegisterReusable(I_Pred, (cur_InstructionCriticalPath[I_Pred] -
                                                          getInstructionLatency(I_Pred))
@@ -971,8 +988,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
                     Value *ori_V = byPassUnregisterOp(zext_I);
                     if (auto ori_I = dyn_cast<Instruction>(ori_V))
                     {
-                        if (cur_InstructionCriticalPath.find(ori_I) !=
-                            cur_InstructionCriticalPath.end())
+                        if (cur_InstructionCriticalPath.count(ori_I))
                         {
                             if (checkLoadOpRegisterReusable(ori_I,
                                                             (cur_InstructionCriticalPath[ori_I] -
@@ -1005,8 +1021,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
                     Value *ori_V = byPassUnregisterOp(sext_I);
                     if (auto ori_I = dyn_cast<Instruction>(ori_V))
                     {
-                        if (cur_InstructionCriticalPath.find(ori_I) !=
-                            cur_InstructionCriticalPath.end())
+                        if (cur_InstructionCriticalPath.count(ori_I))
                         {
                             if (checkLoadOpRegisterReusable(ori_I,
                                                             (cur_InstructionCriticalPath[ori_I] -
@@ -1035,7 +1050,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
                     }
                 }
 
-                if (cur_InstructionCriticalPath.find(I_Pred) != cur_InstructionCriticalPath.end())
+                if (cur_InstructionCriticalPath.count(I_Pred))
                     if (cur_InstructionCriticalPath[I_Pred].latency ==
                         (cur_InstructionCriticalPath[I] - getInstructionLatency(I))
                             .latency) // WARNING: there are instructions with negative latency in
@@ -1095,8 +1110,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
 
                         if (BlockContain(I->getParent(), l2_pred))
                         {
-                            if (cur_InstructionCriticalPath.find(l2_pred) !=
-                                cur_InstructionCriticalPath.end())
+                            if (cur_InstructionCriticalPath.count(l2_pred))
                             {
                                 if (cur_InstructionCriticalPath[l2_pred].latency ==
                                     (cur_InstructionCriticalPath[I] - getInstructionLatency(I))
@@ -1191,7 +1205,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
             }
 
             // try to reuse the load registers if they are released from previous accesses
-            if (cur_InstructionCriticalPath.find(I_Pred) != cur_InstructionCriticalPath.end())
+            if (cur_InstructionCriticalPath.count(I_Pred))
             {
                 if (checkLoadOpRegisterReusable(I_Pred, (cur_InstructionCriticalPath[I_Pred] -
                                                          getInstructionLatency(I_Pred))
@@ -1207,7 +1221,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
             {
                 // may be the operand is operated later, especially for phi insturction in loop
                 // for this situation, we may still need registers for the operands
-                if (cur_InstructionCriticalPath.find(I_Pred) != cur_InstructionCriticalPath.end())
+                if (cur_InstructionCriticalPath.count(I_Pred))
                     if (cur_InstructionCriticalPath[I_Pred].latency ==
                         (cur_InstructionCriticalPath[I] - getInstructionLatency(I))
                             .latency) // WARNING: there are instructions with negative latency in
@@ -1231,8 +1245,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
 
                     if (auto ori_I = dyn_cast<Instruction>(ori_V))
                     {
-                        if (cur_InstructionCriticalPath.find(ori_I) !=
-                            cur_InstructionCriticalPath.end())
+                        if (cur_InstructionCriticalPath.count(ori_I))
                         {
                             if (checkLoadOpRegisterReusable(ori_I,
                                                             (cur_InstructionCriticalPath[ori_I] -
@@ -1266,8 +1279,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
                     Value *ori_V = byPassUnregisterOp(sext_I);
                     if (auto ori_I = dyn_cast<Instruction>(ori_V))
                     {
-                        if (cur_InstructionCriticalPath.find(ori_I) !=
-                            cur_InstructionCriticalPath.end())
+                        if (cur_InstructionCriticalPath.count(ori_I))
                         {
                             if (checkLoadOpRegisterReusable(ori_I,
                                                             (cur_InstructionCriticalPath[ori_I] -
@@ -1352,7 +1364,7 @@ HI_WithDirectiveTimingResourceEvaluation::FF_Evaluate(
 // evaluate the number of LUT needed by the PHI instruction
 HI_WithDirectiveTimingResourceEvaluation::resourceBase
 HI_WithDirectiveTimingResourceEvaluation::IndexVar_LUT(
-    std::map<Instruction *, timingBase> &cur_InstructionCriticalPath, Instruction *I)
+    HI_BlockInstView<timingBase> &cur_InstructionCriticalPath, Instruction *I)
 {
     resourceBase res(0, 0, 0, clock_period);
 
@@ -1366,8 +1378,7 @@ HI_WithDirectiveTimingResourceEvaluation::IndexVar_LUT(
                 if (BlockContain(I->getParent(), I_Pred))
                 {
                     // may be the operand is operated later, especially for phi insturction in loop
-                    if (cur_InstructionCriticalPath.find(I_Pred) ==
-                        cur_InstructionCriticalPath.end())
+                    if (!cur_InstructionCriticalPath.count(I_Pred))
                     {
                         res.LUT = 9; // for invar PHI with two input
                     }
@@ -1541,7 +1552,7 @@ bool HI_WithDirectiveTimingResourceEvaluation::checkLoadOpRegisterReusable(Instr
             }
 
             // the result register has been reused, bypass it
-            if (I_RegReused.find(tmp_load_I) != I_RegReused.end())
+            if (I_RegReused.count(tmp_load_I))
             {
                 if (DEBUG)
                     *FF_log << "---- the register is reused, bypass it.\n";
@@ -1561,7 +1572,7 @@ bool HI_WithDirectiveTimingResourceEvaluation::checkLoadOpRegisterReusable(Instr
             // find a load instruction which has the same target array
             if (Access2TargetMap[tmp_load_I][0] == Access2TargetMap[Load_I][0])
             {
-                if (RegRelease_Schedule.find(tmp_load_I) == RegRelease_Schedule.end())
+                if (!RegRelease_Schedule.count(tmp_load_I))
                 {
                     if (DEBUG)
                         *FF_log << "---- no lifetime information for the instruction, bypass it.\n";
@@ -1603,7 +1614,7 @@ void HI_WithDirectiveTimingResourceEvaluation::updateResultRelease(Instruction *
                                                                    Instruction *I_Pred,
                                                                    int time_point)
 {
-    if (RegRelease_Schedule.find(I_Pred) == RegRelease_Schedule.end())
+    if (!RegRelease_Schedule.count(I_Pred))
     {
         RegRelease_Schedule[I_Pred] = std::pair<BasicBlock *, int>(I->getParent(), time_point);
     }
@@ -1637,8 +1648,8 @@ HI_WithDirectiveTimingResourceEvaluation::checkFPOperatorCost(std::string opcode
     oprandBitWidth = -1;
     resBitWidth = -1;
 
-    result =
-        get_inst_ResourceInfo_result(opcode_str, oprandBitWidth, resBitWidth, clock_period_str);
+    result = get_inst_ResourceInfo_result(HLSLibTable->getOpcodeID(opcode_str), oprandBitWidth,
+                                          resBitWidth, clock_period_ID);
     ;
     return result;
 }
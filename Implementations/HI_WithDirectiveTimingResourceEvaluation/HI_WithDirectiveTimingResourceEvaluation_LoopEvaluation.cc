@@ -1,5 +1,6 @@
 #include "HI_WithDirectiveTimingResourceEvaluation.h"
 #include "HI_print.h"
+#include "llvm/Analysis/LoopIterator.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Module.h"
 #include "llvm/IRReader/IRReader.h"
@@ -101,7 +102,7 @@ Loop *HI_WithDirectiveTimingResourceEvaluation::getInnerUnevaluatedLoop(Loop *ou
             *Evaluating_log << "--------- checking sub-loop: " << tmp_Loop->getName()
                             << " address:" << tmp_Loop->getHeader()
                             << " -> dep = " << tmp_Loop->getLoopDepth() << " ";
-        if (LoopEvaluated.find(tmp_Loop->getHeader()) != LoopEvaluated.end())
+        if (LoopEvaluated.count(tmp_Loop->getHeader()))
         {
             if (DEBUG)
                 *Evaluating_log << " which is evaluated.\n";
@@ -119,7 +120,7 @@ Loop *HI_WithDirectiveTimingResourceEvaluation::getInnerUnevaluatedLoop(Loop *ou
         if (tmp_inner_Sub_Loop)
         {
             if (tmp_inner_Sub_Loop->getLoopDepth() > dep &&
-                LoopEvaluated.find(tmp_inner_Sub_Loop->getHeader()) == LoopEvaluated.end())
+                !LoopEvaluated.count(tmp_inner_Sub_Loop->getHeader()))
             {
                 dep = tmp_inner_Sub_Loop->getLoopDepth();
                 tmp_inner_Loop =
@@ -133,7 +134,7 @@ Loop *HI_WithDirectiveTimingResourceEvaluation::getInnerUnevaluatedLoop(Loop *ou
         else
         {
             if (tmp_Loop->getLoopDepth() > dep &&
-                LoopEvaluated.find(tmp_Loop->getHeader()) == LoopEvaluated.end())
+                !LoopEvaluated.count(tmp_Loop->getHeader()))
             {
                 dep = tmp_Loop->getLoopDepth();
                 tmp_inner_Loop = tmp_Loop; //  no the sub-sub-...-loop could be the most inner loop
@@ -152,7 +153,7 @@ Loop *HI_WithDirectiveTimingResourceEvaluation::getInnerUnevaluatedLoop(Loop *ou
             *Evaluating_log << "--------- checking loop itself: " << tmp_Loop->getName()
                             << " address:" << tmp_Loop->getHeader()
                             << " -> dep = " << tmp_Loop->getLoopDepth() << " ";
-        if (LoopEvaluated.find(tmp_Loop->getHeader()) != LoopEvaluated.end())
+        if (LoopEvaluated.count(tmp_Loop->getHeader()))
             if (DEBUG)
                 *Evaluating_log << " which is evaluated.\n";
             else if (DEBUG)
@@ -160,7 +161,7 @@ Loop *HI_WithDirectiveTimingResourceEvaluation::getInnerUnevaluatedLoop(Loop *ou
 
         // larger depth means more inner
         if (tmp_Loop->getLoopDepth() > dep &&
-            LoopEvaluated.find(tmp_Loop->getHeader()) == LoopEvaluated.end())
+            !LoopEvaluated.count(tmp_Loop->getHeader()))
         {
             dep = tmp_Loop->getLoopDepth();
             tmp_inner_Loop = tmp_Loop;
@@ -187,7 +188,7 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
     if (DEBUG)
         *Evaluating_log << "\n Evaluating Outer Loop Latency for Loop " << outerL->getName()
                         << ":\n";
-    if (LoopLatency.find(outerL->getHeader()) != LoopLatency.end())
+    if (LoopLatency.count(outerL->getHeader()))
     {
         if (DEBUG)
             *Evaluating_log << "Done evaluation outer Loop Latency for Loop " << outerL->getName()
@@ -198,7 +199,6 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
     Loop *cur_Loop;
     timingBase outerL_latency(-1, -1, 1, clock_period);
     timingBase tmp_total_latency(0, 0, 1, clock_period);
-    timingBase origin_latency(0, 0, 1, clock_period);
     // (1) iteratively handle the most inner loop
     cur_Loop = getInnerUnevaluatedLoop(outerL);
     while (cur_Loop != NULL)
@@ -238,16 +238,14 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
         if (DEBUG)
             *Evaluating_log << "\n";
 
-        // (2) traverse the block in loop by DFS to find the longest path
+        // (2) find the longest paths to the blocks/sub-loops in the loop
         timingBase max_critial_path_in_curLoop(0, 0, 1, clock_period);
         resourceBase resourceAccumulator(0, 0, 0, clock_period);
         tmp_BlockCriticalPath_inLoop.clear(); // record the block level critical path in the loop
         tmp_SubLoop_CriticalPath
             .clear(); // record the critical path to the end of sub-loops in the loop
 
-        BlockVisited.clear();
-        LoopLatencyResourceEvaluation_traversFromHeaderToExitingBlocks(
-            origin_latency, cur_Loop, tmp_LoopHeader, resourceAccumulator);
+        LoopLatencyResourceEvaluation_longestPath(cur_Loop, resourceAccumulator);
         BlockCriticalPath_inLoop[cur_Loop] = tmp_BlockCriticalPath_inLoop;
 
         for (auto tmp_it : tmp_BlockCriticalPath_inLoop)
@@ -272,6 +270,11 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
         // (3) get the total latency by TripCount * IterationLatency? (consider whether the loop is
         // pipelined)
         int II_for_loop = checkIIForLoop(cur_Loop, tmp_BlockCriticalPath_inLoop);
+
+        // the modulo scheduler may move the operations, so an iteration takes the pipeline depth
+        if (II_for_loop > 0 && configInfo.moduloScheduling &&
+            Loop2PipelineDepth.count(cur_Loop->getHeader()))
+            max_critial_path_in_curLoop.latency = Loop2PipelineDepth[cur_Loop->getHeader()];
         if (II_for_loop <= -1 || II_for_loop >= max_critial_path_in_curLoop.latency)
         {
             if (II_for_loop >= max_critial_path_in_curLoop.latency)
@@ -292,11 +295,11 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
             if (cur_Loop->getSubLoops().size() > 0 &&
                 isPerfectPipelinedNest(cur_Loop, innerHeader, total_nesttripcount))
             {
-                if (Loop2IterationLatency.find(innerHeader) == Loop2IterationLatency.end())
+                if (!Loop2IterationLatency.count(innerHeader))
                 {
                     llvm::errs() << configInfo << "\n";
                 }
-                assert(Loop2IterationLatency.find(innerHeader) != Loop2IterationLatency.end());
+                assert(Loop2IterationLatency.count(innerHeader));
                 if (DEBUG)
                     *Evaluating_log << "This is a perfectly nested loop containing a pipelined "
                                        "subloop, we should flatten it.\n";
@@ -409,8 +412,7 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
 
         // (4) mark the blocks in loop with the loop latency, so later processing can regard this
         // loop as an integration
-        BlockVisited.clear();
-        MarkBlock_traversFromHeaderToExitingBlocks(tmp_total_latency, cur_Loop, tmp_LoopHeader);
+        MarkBlock_inLoop(cur_Loop);
 
         std::string label = IRLoop2LoopLabel[tmp_loop_name];
 
@@ -449,178 +451,36 @@ HI_WithDirectiveTimingResourceEvaluation::analyzeOuterLoop(Loop *outerL)
 }
 
 /*
-    traverse the block in loop by DFS to find the longest path:
-    (1) Mark the block visited, as a step of typical DFS
-    (2) Check whether the search reaches a block in the sub-loops
-    (3a) -- If it is a block in sub-loops, regard the loop as intergration and update the critical
-   path if necessary (max(ori_CP, lastStateCP + LoopLatency)).
-         -- find the successors of the loop by checking its exiting blocks' successors and continue
-   the DFS (3b) -- If it is a block out of sub-loops, evaluate the block latency and update the
-   critical path if necessary (max(ori_CP, lastStateCP + BlockLatency)).
-         -- find the successors of the block and continue the DFS
-    (4) Release the block from visited flag, as a step of typical DFS
-
+    find the longest paths to the blocks/sub-loops in the loop body, where each evaluated sub-loop
+    is regarded as an integration (see getCriticalPathNodes)
 */
-void HI_WithDirectiveTimingResourceEvaluation::
-    LoopLatencyResourceEvaluation_traversFromHeaderToExitingBlocks(
-        HI_WithDirectiveTimingResourceEvaluation::timingBase tmp_critical_path, Loop *L,
-        BasicBlock *curBlock,
-        HI_WithDirectiveTimingResourceEvaluation::resourceBase &resourceAccumulator)
+void HI_WithDirectiveTimingResourceEvaluation::LoopLatencyResourceEvaluation_longestPath(
+    Loop *L, HI_WithDirectiveTimingResourceEvaluation::resourceBase &resourceAccumulator)
 {
-
-    // (1) Mark the block visited, as a step of typical DFS
-    BlockVisited.insert(curBlock);
-
-    if (DEBUG)
-        *Evaluating_log << "---- traverser arrive Block: " << curBlock->getName() << " ";
-
-    // (2) Check whether the search reaches a block in the sub-loops
-    if (Block2EvaluatedLoop.find(curBlock) != Block2EvaluatedLoop.end())
-    {
-        // (3a) -- If it is a block in sub-loops, regard the loop as intergration and update the
-        // critical path if necessary (max(ori_CP, lastStateCP + LoopLatency)).
-        Loop *tmp_SubLoop = Block2EvaluatedLoop[curBlock];
-        if (DEBUG)
-            *Evaluating_log << " which is evluated in Loop " << tmp_SubLoop->getName() << " ";
-        if (DEBUG)
-            *Evaluating_log << " LoopLatency =  " << LoopLatency[tmp_SubLoop->getHeader()] << " ";
-        timingBase try_critical_path =
-            tmp_critical_path +
-            LoopLatency[tmp_SubLoop->getHeader()]; // first, get the critical path to the end of
-                                                   // sub-loop
-        if (DEBUG)
-            *Evaluating_log << " NewCP =  " << try_critical_path << " ";
-        bool checkFlag = false;
-
-        if (tmp_SubLoop_CriticalPath.find(tmp_SubLoop) == tmp_SubLoop_CriticalPath.end())
-        {
-            assert(LoopResource.find(tmp_SubLoop->getHeader()) != LoopResource.end());
-            resourceAccumulator = resourceAccumulator + LoopResource[tmp_SubLoop->getHeader()];
-            checkFlag = true;
-        }
-        else if (try_critical_path > tmp_SubLoop_CriticalPath[tmp_SubLoop])
-            checkFlag = true;
-
-        if (checkFlag)
-        {
-            if (tmp_SubLoop_CriticalPath.find(tmp_SubLoop) != tmp_SubLoop_CriticalPath.end())
-            {
-                if (DEBUG)
-                    *Evaluating_log << " OriCP =  " << tmp_SubLoop_CriticalPath[tmp_SubLoop]
-                                    << "\n";
-            }
-            else
-            {
-                if (DEBUG)
-                    *Evaluating_log << " No OriCP"
-                                    << "\n";
-            }
-            tmp_SubLoop_CriticalPath[tmp_SubLoop] = try_critical_path;
-
-            //  (3a)  -- find the successors of the loop by checking its exiting blocks' successors
-            //  and continue the DFS
-            SmallVector<BasicBlock *, 8> tmp_SubLoop_ExitingBlocks;
-            tmp_SubLoop->getExitingBlocks(tmp_SubLoop_ExitingBlocks);
-            for (auto ExitB : tmp_SubLoop_ExitingBlocks)
-            {
-                for (auto B : successors(ExitB))
-                {
-                    if (L->contains(B) && BlockVisited.find(B) == BlockVisited.end() &&
-                        !tmp_SubLoop->contains(B))
-                    {
-                        if (DEBUG)
-                            *Evaluating_log
-                                << "---- loop continue to traverser to Block: " << B->getName()
-                                << " from " << curBlock->getName() << " ";
-                        LoopLatencyResourceEvaluation_traversFromHeaderToExitingBlocks(
-                            try_critical_path, L, B, resourceAccumulator);
-                    }
-                }
-            }
-        }
-    }
-    else
+    std::vector<CriticalPathNode> nodes;
+    getCriticalPathNodes(L->getHeader()->getParent(), L, resourceAccumulator, nodes);
+    for (auto &node : nodes)
     {
-        //     (3b) -- If it is a block out of sub-loops, evaluate the block latency and update the
-        //     critical path if necessary (max(ori_CP, lastStateCP + BlockLatency)).
-        if (DEBUG)
-            *Evaluating_log << " which is  not evaluated in Loop "
-                            << " ";
-        timingBase latency_CurBlock =
-            BlockLatencyResourceEvaluation(curBlock); // first, get the latency of the current block
-        timingBase try_critical_path = tmp_critical_path + latency_CurBlock;
-        if (DEBUG)
-            *Evaluating_log << "---- latencyBlock =  " << latency_CurBlock
-                            << "    tmp_critical_path_in_loop=" << tmp_critical_path << "  ";
-        if (DEBUG)
-            *Evaluating_log << " NewCP =  " << try_critical_path << " ";
-        bool checkFlag = false;
-
-        if (tmp_BlockCriticalPath_inLoop.find(curBlock) == tmp_BlockCriticalPath_inLoop.end())
-        {
-            assert(BlockResource.find(curBlock) != BlockResource.end());
-            resourceAccumulator = resourceAccumulator + BlockResource[curBlock];
-            checkFlag = true;
-        }
-        else if (try_critical_path > tmp_BlockCriticalPath_inLoop[curBlock])
-            checkFlag = true;
-
-        if (checkFlag) // update the block-level critical path
+        if (node.L)
+            tmp_SubLoop_CriticalPath[node.L] = node.end;
+        else
         {
-            if (tmp_BlockCriticalPath_inLoop.find(curBlock) != tmp_BlockCriticalPath_inLoop.end())
-            {
-                if (DEBUG)
-                    *Evaluating_log << " OriCP =  " << tmp_BlockCriticalPath_inLoop[curBlock]
-                                    << "\n";
-            }
-            else
-            {
-                if (DEBUG)
-                    *Evaluating_log << " No OriCP"
-                                    << "\n";
-            }
-
-            tmp_BlockCriticalPath_inLoop[curBlock] = try_critical_path;
-            BlockBegin_inLoop[curBlock] =
-                tmp_critical_path; // only one level of sub-loop in a outermost loop will be
-                                   // pipelined so don't worry about duplicated use of this map
-
-            // (3b)  -- find the successors of the block and continue the DFS
-            for (auto B : successors(curBlock))
-            {
-                if (L->contains(B) && BlockVisited.find(B) == BlockVisited.end())
-                {
-                    if (DEBUG)
-                        *Evaluating_log
-                            << "---- loop continue to traverser to Block: " << B->getName()
-                            << " from " << curBlock->getName() << " ";
-                    LoopLatencyResourceEvaluation_traversFromHeaderToExitingBlocks(
-                        try_critical_path, L, B, resourceAccumulator);
-                }
-            }
+            tmp_BlockCriticalPath_inLoop[node.B] = node.end;
+            // only one level of sub-loop in a outermost loop will be pipelined so don't worry
+            // about duplicated use of this map
+            BlockBegin_inLoop[node.B] = node.begin;
         }
     }
-    // (4) Release the block from visited flag, as a step of typical DFS
-    BlockVisited.erase(curBlock);
 }
 
 /*
-    Simply mark all the blocks in the loop with the totoal_latency by DFS-traverse
+    Simply mark all the blocks in the loop, so later processing can regard this loop as an
+    integration
 */
-void HI_WithDirectiveTimingResourceEvaluation::MarkBlock_traversFromHeaderToExitingBlocks(
-    HI_WithDirectiveTimingResourceEvaluation::timingBase total_latency, Loop *L,
-    BasicBlock *curBlock)
+void HI_WithDirectiveTimingResourceEvaluation::MarkBlock_inLoop(Loop *L)
 {
-    BlockVisited.insert(curBlock);
-    Block2EvaluatedLoop[curBlock] = L;
-
-    for (auto B : successors(curBlock))
-    {
-        if (L->contains(B) && BlockVisited.find(B) == BlockVisited.end())
-        {
-            MarkBlock_traversFromHeaderToExitingBlocks(total_latency, L, B);
-        }
-    }
+    for (auto B : L->blocks())
+        Block2EvaluatedLoop[B] = L;
 }
 
 // get the II factor for loop pipelining, if there is directives of pipeline for this loop
@@ -669,31 +529,27 @@ int HI_WithDirectiveTimingResourceEvaluation::checkIIForLoop(
         }
     }
 
+    // the resource-constrained MII and the minimum II valid for the scheduled accesses, both are
+    // derived from the modulo reservation tables of the accessed partitions
     int II_BRAM = checkAccessIIForLoop(curLoop);
-    int II_BRAM_enum = checkAccessIIForLoop_enumerateCheck(curLoop);
+    int II_BRAM_scheduled = checkAccessIIForLoop_scheduled(curLoop);
 
-    if (II_BRAM != II_BRAM_enum)
+    if (II_BRAM_scheduled < 0)
     {
-        print_warning("Loop II of " + std::string(curLoop->getName()) +
-                      " has conflict prediction: ideal=" + std::to_string(II_BRAM) +
-                      " enum=" + std::to_string(II_BRAM_enum));
-        if (II_BRAM_enum < 0)
+        if (LoopLabel2II.find(label) == LoopLabel2II.end())
+            print_warning("Don't worry for the negative scheduled II=" +
+                          std::to_string(II_BRAM_scheduled) + " because " + label +
+                          " is not pipelined.\n");
+        else if (!configInfo.moduloScheduling)
         {
-            if (LoopLabel2II.find(label) == LoopLabel2II.end())
-                print_warning("Don't worry for the negative enum=" + std::to_string(II_BRAM_enum) +
-                              " because " + label + " is not pipelined.\n");
-            else
-            {
-                assert(false && "This loop is unable to be pipelined");
-            }
+            assert(false && "This loop is unable to be pipelined");
         }
     }
 
-    // II_BRAM_enum is more reliable but very conservative
-    // so we believe that VivadoHLS can optimize
-    // II_BRAM_enum by reducing it by 1
-    if (II_BRAM_enum - 1 >= II_BRAM)
-        II_BRAM = II_BRAM_enum - 1;
+    // II_BRAM_scheduled is more reliable but very conservative, since the accesses are scheduled
+    // ASAP, so we believe that VivadoHLS can optimize II_BRAM_scheduled by reducing it by 1
+    if (II_BRAM_scheduled - 1 >= II_BRAM)
+        II_BRAM = II_BRAM_scheduled - 1;
 
     int II_dependence = checkDependenceIIForLoop(curLoop);
 
@@ -731,6 +587,27 @@ int HI_WithDirectiveTimingResourceEvaluation::checkIIForLoop(
         *Evaluating_log << "--------- Loop pipeline Dependence-related II is " << II_dependence
                         << "\n";
 
+    // the modulo scheduler moves the operations to meet the ports, the DSPs and the recurrences,
+    // so its II replaces the heuristic ones. The IIs below the loop-carried dependences can never
+    // be scheduled, so they are not tried.
+    bool moduloScheduleFailed = false;
+    if (configInfo.moduloScheduling)
+    {
+        int start_II = std::max(min_II, II_dependence);
+        int II_scheduled = moduloScheduleLoop(curLoop, start_II);
+        if (II_scheduled > 0)
+        {
+            if (II_scheduled > min_II)
+                print_warning(std::string(curLoop->getName()) +
+                              " cannot be modulo scheduled with the expected II, min_II is "
+                              "updated to " +
+                              std::to_string(II_scheduled));
+            return II_scheduled;
+        }
+        // fall back to the II checked with the modulo reservation tables of the partitions
+        moduloScheduleFailed = true;
+    }
+
     if (II_BRAM > min_II)
     {
         min_II = II_BRAM;
@@ -762,6 +639,11 @@ int HI_WithDirectiveTimingResourceEvaluation::checkIIForLoop(
     {
         LoopLabel2SmallestII[label] = II_dependence;
     }
+
+    if (moduloScheduleFailed)
+        print_warning("Failed to modulo schedule the loop [" + label +
+                      "], its II is estimated as " + std::to_string(min_II) +
+                      " by the modulo reservation tables of the accessed partitions.");
     // TODO:
     // check the II related to loop carried dependece
     // II = ceiling ((C_store - C_load + 1) / dep_distance)
@@ -771,10 +653,12 @@ int HI_WithDirectiveTimingResourceEvaluation::checkIIForLoop(
     return min_II;
 }
 
-// the BRAM-related II for the loop
+// the BRAM-related MII for the loop, the modulo reservation tables of the accessed partitions are
+// built here for the later II checks. The MII only counts the accesses in the blocks directly in
+// the loop, while the tables also record the accesses in its sub-loops for the scheduled check.
 int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop(Loop *curLoop)
 {
-    int min_II = 1;
+    accessMRTsForIITest.clear();
     std::map<std::pair<Value *, partition_info>, int> existingAccessCntForLoop;
     for (auto tmp_B : curLoop->getBlocks())
     {
@@ -786,83 +670,67 @@ int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop(Loop *curLoop
         }
         for (auto it_value_partition_2_cnt : accessCounterForBlock[tmp_B])
         {
-            Value *target = it_value_partition_2_cnt.first.first;
             partition_info partID = it_value_partition_2_cnt.first.second;
             assert(partID.port_num > 0 && "the port number for the partition should be set.");
-            if (existingAccessCntForLoop.find(it_value_partition_2_cnt.first) ==
-                existingAccessCntForLoop.end())
-            {
-                existingAccessCntForLoop[it_value_partition_2_cnt.first] =
-                    it_value_partition_2_cnt.second;
-            }
-            else
-            {
-                existingAccessCntForLoop[it_value_partition_2_cnt.first] +=
-                    it_value_partition_2_cnt.second;
-            }
-            int accessTotalCntInLoop = existingAccessCntForLoop[it_value_partition_2_cnt.first];
-            if ((accessTotalCntInLoop + partID.port_num - 1) / partID.port_num > min_II)
-            {
-                if (DEBUG)
-                    *Evaluating_log
-                        << "--------- min II is updated to "
-                        << (accessTotalCntInLoop + partID.port_num - 1) / partID.port_num
-                        << " because\n";
-                if (DEBUG)
-                    *Evaluating_log << "--------- access to the partition#" << partID << " of "
-                                    << *target << " exceed the bandwidth\n";
-
-                min_II = (accessTotalCntInLoop + partID.port_num - 1) / partID.port_num;
-            }
+            if (accessMRTsForIITest.find(it_value_partition_2_cnt.first) ==
+                accessMRTsForIITest.end())
+                accessMRTsForIITest[it_value_partition_2_cnt.first] =
+                    HI_ModuloReservationTable(partID.port_num);
+            existingAccessCntForLoop[it_value_partition_2_cnt.first] +=
+                it_value_partition_2_cnt.second;
         }
     }
-    return min_II;
-}
-
-// check the BRAM-related II for the loop by enumerating II and checking port constraint for each
-// cycle for each partition
-int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop_enumerateCheck(Loop *curLoop)
-{
-    if (DEBUG)
-        *ArrayLog
-            << "\n\n============================\n \n checkAccessIIForLoop_enumerateCheck for Loop:"
-            << curLoop->getName() << " \n ============================\n \n";
 
-    // initialize an empty seq for later tests for different partitions of different targets
-    int latLoop = Loop2CP[curLoop->getHeader()];
-    int lenSeq = latLoop + 5; // maybe to leave some space could be better
-
-    std::vector<int> test_accessSeq(lenSeq);
-
-    accessPartitionsForIITest.clear();
-    for (auto tmp_B : curLoop->getBlocks())
+    // record the accesses by their cycles from the beginning of the iteration
+    for (auto &val_partition_MRT : accessMRTsForIITest)
     {
-        if (curLoop != LI->getLoopFor(tmp_B))
-            continue;
-        if (accessCounterForBlock.find(tmp_B) == accessCounterForBlock.end())
+        for (auto block_cycle_pair : targetPartition2BlockCycleAccessCnt[val_partition_MRT.first])
         {
-            continue;
+            if (!curLoop->contains(block_cycle_pair.first))
+                continue;
+            val_partition_MRT.second.addUsage(BlockBegin_inLoop[block_cycle_pair.first].latency +
+                                              block_cycle_pair.second);
         }
-        for (auto it_value_partition_2_cnt : accessCounterForBlock[tmp_B])
+    }
+
+    int min_II = 1;
+    for (auto &val_partition_cnt : existingAccessCntForLoop)
+    {
+        Value *target = val_partition_cnt.first.first;
+        partition_info partID = val_partition_cnt.first.second;
+        int resMII = (val_partition_cnt.second + partID.port_num - 1) / partID.port_num;
+        if (resMII > min_II)
         {
-            if (accessPartitionsForIITest.find(it_value_partition_2_cnt.first) ==
-                accessPartitionsForIITest.end())
-                accessPartitionsForIITest.insert(it_value_partition_2_cnt.first);
+            if (DEBUG)
+                *Evaluating_log << "--------- min II is updated to " << resMII << " because\n";
+            if (DEBUG)
+                *Evaluating_log << "--------- access to the partition#" << partID << " of "
+                                << *target << " exceed the bandwidth\n";
+            min_II = resMII;
         }
     }
+    return min_II;
+}
 
+// check the BRAM-related II for the loop with the modulo reservation tables of the partitions.
+// With an II, the accesses of the overlapped iterations at a cycle are the accesses of one
+// iteration at the cycles equal to it modulo II, so an II is checked in O(accesses).
+int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop_scheduled(Loop *curLoop)
+{
     if (DEBUG)
-        *ArrayLog << "\n\n============================\n \n printing out accesses in Loop:"
-                  << curLoop->getName() << " \n ============================\n \n";
+        *ArrayLog << "\n\n============================\n \n checkAccessIIForLoop_scheduled "
+                  << "for Loop:" << curLoop->getName() << " \n ============================\n \n";
 
-    if (DEBUG)
-        for (auto val_partition_pair : accessPartitionsForIITest) // check whether all partitions
-                                                                  // are met the constraints of port
+    int latLoop = Loop2CP[curLoop->getHeader()];
+    int low_II = 1;
+    for (auto &val_partition_MRT : accessMRTsForIITest)
+    {
+        if (DEBUG)
         {
-            *ArrayLog << "   access with partition#" << val_partition_pair.second
-                      << " of target:" << val_partition_pair.first->getName() << "\n";
-
-            for (auto block_cycle_pair : targetPartition2BlockCycleAccessCnt[val_partition_pair])
+            *ArrayLog << "   access with partition#" << val_partition_MRT.first.second
+                      << " of target:" << val_partition_MRT.first.first->getName() << "\n";
+            for (auto block_cycle_pair :
+                 targetPartition2BlockCycleAccessCnt[val_partition_MRT.first])
             {
                 *ArrayLog << block_cycle_pair.first->getParent()->getName() << "-"
                           << block_cycle_pair.first->getName() << ":" << block_cycle_pair.second
@@ -871,79 +739,32 @@ int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop_enumerateChec
             *ArrayLog << "\n";
         }
 
-    bool failFlag = false;
-    for (int test_II = 1; test_II <= latLoop; test_II++)
-    {
-        failFlag = false;
-        if (DEBUG)
-            *ArrayLog << "testing II=" << test_II << "\n";
-        for (auto val_partition_pair : accessPartitionsForIITest) // check whether all partitions
-                                                                  // are met the constraints of port
+        if (val_partition_MRT.second.hasIterationConflict())
         {
-            if (DEBUG)
-                *ArrayLog << "   testing with partition#" << val_partition_pair.second
-                          << " of target:" << val_partition_pair.first->getName() << "\n";
-
-            for (int i = 0; i < lenSeq; i++)
-                test_accessSeq[i] = 0;
+            *ArrayLog << "   failed in one iteration-----------> This Loop shoud not "
+                         "be unrolled according to the configuration?";
+            return -1;
+        }
+        low_II = std::max(low_II, val_partition_MRT.second.getResMII());
+    }
 
-            for (int test_iter = 0; test_iter < latLoop; test_iter += test_II)
+    // the II below the resource-constrained MII must fail, so the check starts from it. The
+    // accesses are in [0, latLoop], so the iterations do not overlap with II = latLoop + 1.
+    for (int test_II = low_II; test_II <= latLoop + 1; test_II++)
+    {
+        bool failFlag = false;
+        for (auto &val_partition_MRT : accessMRTsForIITest)
+        {
+            if (!val_partition_MRT.second.checkII(test_II))
             {
-                for (auto block_cycle_pair :
-                     targetPartition2BlockCycleAccessCnt[val_partition_pair])
-                {
-                    if (!curLoop->contains(block_cycle_pair.first))
-                        continue;
-
-                    int slotoffset = BlockBegin_inLoop[block_cycle_pair.first].latency +
-                                     block_cycle_pair.second + test_iter;
-                    if (DEBUG)
-                        *ArrayLog << "----->" << block_cycle_pair.first->getParent()->getName()
-                                  << "-" << block_cycle_pair.first->getName() << ":"
-                                  << block_cycle_pair.second << " exactSlot:" << slotoffset << "\n";
-
-                    if (slotoffset <= latLoop)
-                    {
-                        test_accessSeq[slotoffset]++;
-
-                        if (test_accessSeq[slotoffset] > val_partition_pair.second.port_num)
-                        {
-                            failFlag = true;
-                            if (DEBUG)
-                                *ArrayLog << "   failed at: test_iter=" << test_iter << "\n";
-                            if (DEBUG)
-                            {
-                                *ArrayLog << "   failed pattern :";
-                                for (int i = 0; i < lenSeq; i++)
-                                    *ArrayLog << test_accessSeq[i] << " ";
-                                *ArrayLog << "\n";
-                            }
-
-                            if (test_iter == 0)
-                            {
-                                *ArrayLog << "   failed at iter=0-----------> This Loop shoud not "
-                                             "be unrolled according to the configuration?";
-                                return -1;
-                            }
-                            break;
-                        }
-                    }
-                }
-                if (failFlag)
-                    break;
-                else if (test_iter == 0)
-                {
-                    if (DEBUG)
-                        *ArrayLog << "   initial access pattern :";
-                    if (DEBUG)
-                        for (int i = 0; i < lenSeq; i++)
-                            *ArrayLog << test_accessSeq[i] << " ";
-                    if (DEBUG)
-                        *ArrayLog << "\n";
-                }
-            }
-            if (failFlag)
+                if (DEBUG)
+                    *ArrayLog << "   II=" << test_II << " failed with partition#"
+                              << val_partition_MRT.first.second
+                              << " of target:" << val_partition_MRT.first.first->getName()
+                              << "\n";
+                failFlag = true;
                 break;
+            }
         }
         if (!failFlag)
         {
@@ -951,8 +772,6 @@ int HI_WithDirectiveTimingResourceEvaluation::checkAccessIIForLoop_enumerateChec
                 *ArrayLog << "  II test passed with II=" << test_II << "\n";
             return test_II;
         }
-        if (DEBUG)
-            *ArrayLog << "\n\n\n";
     }
     return -1;
 }
@@ -1046,11 +865,10 @@ int HI_WithDirectiveTimingResourceEvaluation::checkDependenceIIForLoop(Loop *cur
                       << " <===>  STORE:" << *W_I << "\n";
         if (DEBUG)
             ArrayLog->flush();
-        int W_I_time_offset =
-            BlockBegin_inLoop[W_I->getParent()].latency + Inst_Schedule[W_I].second;
+        int W_I_time_offset = BlockBegin_inLoop[W_I->getParent()].latency + Inst_Schedule[W_I];
         int R_I_time_offset = findEarlietUseTimeInTheLoop(
             curLoop,
-            R_I); // BlockBegin_inLoop[R_I->getParent()].latency +  Inst_Schedule[R_I].second;
+            R_I); // BlockBegin_inLoop[R_I->getParent()].latency +  Inst_Schedule[R_I];
         if (DEBUG)
             *ArrayLog << "    W_I_time_offset:" << W_I_time_offset
                       << " <===>  R_I_time_offset:" << R_I_time_offset << "\n";
@@ -1090,15 +908,15 @@ int HI_WithDirectiveTimingResourceEvaluation::checkDependenceIIForLoop(Loop *cur
                             *ArrayLog << "      PHI Feedback dependence between " << *PHI_I
                                       << "  and " << *tmp_I << "\n";
                         int W_I_time_offset = BlockBegin_inLoop[tmp_I->getParent()].latency +
-                                              Inst_Schedule[tmp_I].second;
+                                              Inst_Schedule[tmp_I];
                         int R_I_time_offset = findEarlietUseTimeInTheLoop(
                             curLoop, PHI_I); // BlockBegin_inLoop[PHI_I->getParent()].latency +
-                                             // Inst_Schedule[PHI_I].second;
+                                             // Inst_Schedule[PHI_I];
 
                         if (DEBUG)
                             *ArrayLog << "      W_I_time_offset=" << W_I_time_offset << "("
                                       << BlockBegin_inLoop[tmp_I->getParent()].latency << "+"
-                                      << Inst_Schedule[tmp_I].second
+                                      << Inst_Schedule[tmp_I]
                                       << ") R_I_time_offset=" << R_I_time_offset << "\n";
 
                         int interval = W_I_time_offset - R_I_time_offset;
@@ -1114,19 +932,115 @@ int HI_WithDirectiveTimingResourceEvaluation::checkDependenceIIForLoop(Loop *cur
         }
     }
 
+    // the pairwise bounds above ignore the chains of dependences, e.g. a value passing through
+    // several PHIs/accesses before it feeds back, which are covered by the recurrences
+    int II_recurrence = checkRecurrenceIIForLoop(curLoop);
+    if (II_recurrence > min_II)
+    {
+        min_II = II_recurrence;
+        if (DEBUG)
+            *ArrayLog << "\n      min_II updated to min_II=" << min_II
+                      << " due to the recurrences in the loop\n";
+    }
+
     if (DEBUG)
         *ArrayLog << "\n========================\n\ncheckDependenceIIForLoop: "
                   << curLoop->getName() << "(" << label << ") II_dep=" << min_II << "\n";
     return min_II;
 }
 
+/*
+    build the dependence graph of the loop for the recurrence and modulo scheduling analysis
+    (1) the nodes are the scheduled instructions in the loop (not in its sub-loops), in the program
+        order (the reverse post-order of the blocks)
+    (2) an edge u->v means v cannot begin before u finishes, so its delay is the latency of u,
+        and its distance is the number of iterations crossed
+        -- the SSA uses in an iteration are edges with distance 0
+        -- the header PHIs take the values from the latches with distance 1
+        -- the loop-carried memory dependences take the distances in InstInst2DependenceDistance
+    the latency of an instruction is the critical path to its end minus its beginning cycle
+*/
+void HI_WithDirectiveTimingResourceEvaluation::getLoopDependenceGraph(
+    Loop *curLoop, std::vector<Instruction *> &ops, std::vector<int> &opLatency,
+    std::vector<LoopDependenceEdge> &edges)
+{
+    ops.clear();
+    opLatency.clear();
+    edges.clear();
+    std::map<Instruction *, int> Inst2Op;
+    LoopBlocksRPO RPOT(curLoop);
+    RPOT.perform(LI);
+    for (auto tmp_B : RPOT)
+    {
+        if (curLoop != LI->getLoopFor(tmp_B))
+            continue;
+        for (auto &I : *tmp_B)
+        {
+            if (!InstructionCriticalPath_inBlock.count(&I) || !Inst_Schedule.count(&I))
+                continue;
+            int latency = InstructionCriticalPath_inBlock[&I].latency - Inst_Schedule[&I];
+            Inst2Op[&I] = ops.size();
+            ops.push_back(&I);
+            opLatency.push_back(latency > 0 ? latency : 0);
+        }
+    }
+
+    for (int op = 0, opNum = ops.size(); op < opNum; op++)
+    {
+        Instruction *I = ops[op];
+        bool isHeaderPHI = isa<PHINode>(I) && I->getParent() == curLoop->getHeader();
+        for (int i = 0, e = I->getNumOperands(); i < e; i++)
+        {
+            auto def_it = Inst2Op.find(dyn_cast<Instruction>(I->getOperand(i)));
+            if (def_it == Inst2Op.end())
+                continue;
+            int distance = 0;
+            if (isHeaderPHI && curLoop->contains(cast<PHINode>(I)->getIncomingBlock(i)))
+                distance = 1;
+            edges.push_back(
+                LoopDependenceEdge{def_it->second, op, opLatency[def_it->second], distance});
+        }
+    }
+    for (auto InstInst2DependenceDistance_pair : InstInst2DependenceDistance)
+    {
+        auto W_it = Inst2Op.find(InstInst2DependenceDistance_pair.first.first);
+        auto R_it = Inst2Op.find(InstInst2DependenceDistance_pair.first.second);
+        if (W_it == Inst2Op.end() || R_it == Inst2Op.end() ||
+            InstInst2DependenceDistance_pair.second <= 0)
+            continue;
+        edges.push_back(LoopDependenceEdge{W_it->second, R_it->second, opLatency[W_it->second],
+                                           InstInst2DependenceDistance_pair.second});
+    }
+}
+
+// the recurrence-constrained II of the loop, i.e. the maximum cycle ratio of its dependence graph,
+// where a cycle with total delay D and total distance N requires II >= D / N. It should be called
+// after InstInst2DependenceDistance is updated for the loop.
+int HI_WithDirectiveTimingResourceEvaluation::checkRecurrenceIIForLoop(Loop *curLoop)
+{
+    std::vector<Instruction *> ops;
+    std::vector<int> opLatency;
+    std::vector<LoopDependenceEdge> edges;
+    getLoopDependenceGraph(curLoop, ops, opLatency, edges);
+
+    HI_RecurrenceGraph recurrenceGraph(ops.size());
+    for (auto &edge : edges)
+        recurrenceGraph.addEdge(edge.from, edge.to, edge.delay, edge.distance);
+
+    double maxCycleRatio = recurrenceGraph.getMaxCycleRatio();
+    if (DEBUG)
+        *ArrayLog << "\n      recurrence graph of " << curLoop->getName() << ": " << ops.size()
+                  << " nodes, maximum cycle ratio=" << maxCycleRatio << "\n";
+    return recurrenceGraph.getRecMII();
+}
+
 // get the time slot of the instruction in the loop
 int HI_WithDirectiveTimingResourceEvaluation::getTimeslotForInstInLoop(
     Loop *curLoop, Instruction *I, std::map<BasicBlock *, timingBase> &tmp_BlockCriticalPath_inLoop)
 {
     int res = 1;
     int block_offset = BlockBegin_inLoop[I->getParent()].latency;
-    int I_offset = Inst_Schedule[I].second;
+    int I_offset = Inst_Schedule[I];
     Inst2TimeSlotInLoop[I] = block_offset + I_offset;
     return block_offset + I_offset;
 }
@@ -1134,7 +1048,7 @@ int HI_WithDirectiveTimingResourceEvaluation::getTimeslotForInstInLoop(
 // get the time slot of the instruction in the loop
 int HI_WithDirectiveTimingResourceEvaluation::getTimeslotForInstInLoop(Instruction *I)
 {
-    assert(Inst2TimeSlotInLoop.find(I) != Inst2TimeSlotInLoop.end());
+    assert(Inst2TimeSlotInLoop.count(I));
     return Inst2TimeSlotInLoop[I];
 }
 
@@ -1209,11 +1123,11 @@ void HI_WithDirectiveTimingResourceEvaluation::checkLoopCarriedDependent(Instruc
     const SCEV *tmp_S0 = SE->getSCEV(pointer_I0->getOperand(0));
     const SCEV *tmp_S1 = SE->getSCEV(pointer_I1->getOperand(0));
 
-    Optional<APInt> res = computeConstantDifference(tmp_S0, tmp_S1);
+    Optional<int64_t> res = getAddressDifference(I0, I1, tmp_S0, tmp_S1);
 
     if (res != None)
     {
-        int offset_dis = res.getValue().getSExtValue();
+        int offset_dis = res.getValue();
         if (DEBUG)
             *ArrayLog << " offset_dis=" << offset_dis << "\n";
 
@@ -1276,13 +1190,31 @@ void HI_WithDirectiveTimingResourceEvaluation::checkLoopCarriedDependent(Instruc
 
 bool HI_WithDirectiveTimingResourceEvaluation::hasSameTargets(Instruction *I0, Instruction *I1)
 {
+    std::set<Value *> &targets1 = Value2Target[I1];
     for (auto target0 : Value2Target[I0])
-        for (auto target1 : Value2Target[I1])
-            if (target0 == target1)
-                return true;
+        if (targets1.find(target0) != targets1.end())
+            return true;
     return false;
 }
 
+// the constant distance between the addresses (S0/S1) of the two accesses, which is memoized in
+// AliasCache, since the pairs of accesses in a loop are checked again for its outer loops
+Optional<int64_t> HI_WithDirectiveTimingResourceEvaluation::getAddressDifference(Instruction *I0,
+                                                                                 Instruction *I1,
+                                                                                 const SCEV *S0,
+                                                                                 const SCEV *S1)
+{
+    Optional<int64_t> res;
+    if (AliasCache.lookup(I0, I1, res))
+        return res;
+
+    Optional<APInt> diff = computeConstantDifference(S0, S1);
+    if (diff != None)
+        res = diff.getValue().getSExtValue();
+    AliasCache.insert(I0, I1, res);
+    return res;
+}
+
 // find the earliest user of the load instruction (maybe for reschedule)
 int HI_WithDirectiveTimingResourceEvaluation::findEarlietUseTimeInTheLoop(Loop *curLoop,
                                                                           Instruction *ori_R_I)
@@ -1297,7 +1229,9 @@ int HI_WithDirectiveTimingResourceEvaluation::findEarlietUseTimeInTheLoop(Loop *
             R_I = callI; // if there is mux for the load, check the users of the mux instead
             timingBase tmpMuxDelay = getInstructionLatency(R_I);
             if (((tmpMuxDelay.timing +
-                  get_inst_TimingInfo_result("store", -1, -1, clock_period_str).timing) /
+                  get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Store), -1, -1,
+                                             clock_period_ID)
+                      .timing) /
                  clock_period) > 0.5) // when the mux delay is too high to fit in the current
             { // cycle, we should leave one more cycle before the earliest user
                 muxDelayIsHigh = true;
@@ -1313,7 +1247,7 @@ int HI_WithDirectiveTimingResourceEvaluation::findEarlietUseTimeInTheLoop(Loop *
         R_I = ori_R_I;
     }
 
-    int R_I_time_offset = BlockBegin_inLoop[R_I->getParent()].latency + Inst_Schedule[R_I].second;
+    int R_I_time_offset = BlockBegin_inLoop[R_I->getParent()].latency + Inst_Schedule[R_I];
     int earliest_time_slot = 100000000;
     // here, we assume that the load can be rescheduled as late as possible
     // therefore, we need to find when its ealiest user use the data
@@ -1344,12 +1278,14 @@ int HI_WithDirectiveTimingResourceEvaluation::findEarlietUseTimeInTheLoop(Loop *
                     tmp_user_I->getOpcode() == Instruction::SDiv)
                     cycle_inadvance = 2;
 
-                if (InstructionCriticalPath_inBlock[tmp_user_I->getParent()][tmp_user_I].timing -
+                if (InstructionCriticalPath_inBlock[tmp_user_I].timing -
                         getInstructionLatency(tmp_user_I).timing <=
                     0.001)
                 {
                     if (getInstructionLatency(tmp_user_I).timing +
-                            get_inst_TimingInfo_result("store", -1, -1, clock_period_str).timing >
+                            get_inst_TimingInfo_result(getLibOpcodeID(Instruction::Store), -1,
+                                                       -1, clock_period_ID)
+                                .timing >
                         0.5 * clock_period)
                     {
                         // this situation, the scheduling of the block is relatively tight,
@@ -1380,7 +1316,7 @@ int HI_WithDirectiveTimingResourceEvaluation::findEarlietUseTimeInTheLoop(Loop *
                 }
 
                 int tmp_tmp_slot = BlockBegin_inLoop[tmp_user_I->getParent()].latency +
-                                   Inst_Schedule[tmp_user_I].second - cycle_inadvance;
+                                   Inst_Schedule[tmp_user_I] - cycle_inadvance;
 
                 if (tmp_tmp_slot < earliest_time_slot && R_I_time_offset <= tmp_tmp_slot)
                 {
@@ -1641,7 +1577,7 @@ bool HI_WithDirectiveTimingResourceEvaluation::isPerfectPipelinedNest(Loop *L,
         // std::string tmp_loop_name = Header->getParent()->getName();
         // tmp_loop_name += "-";
         // tmp_loop_name += Header->getName();
-        if (Loop2AchievedII.find(Header) != Loop2AchievedII.end())
+        if (Loop2AchievedII.count(Header))
         {
             // is pipelined
             innerHeader = Header;
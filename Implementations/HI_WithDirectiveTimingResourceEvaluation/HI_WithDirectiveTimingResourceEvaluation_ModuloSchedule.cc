@@ -0,0 +1,141 @@
+#include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include "HI_print.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+
+using namespace llvm;
+
+/*
+    schedule the pipelined loop with the iterative modulo scheduler (see HI_ModuloScheduler)
+    (1) the operations and their dependences are from the dependence graph of the loop
+        (getLoopDependenceGraph). Since the operations can be moved in the iteration, the accesses
+        to the same targets also keep their program order if one of them is a store.
+    (2) the resources are the partitions accessed in the loop with their port numbers (the same
+        ones as the modulo reservation tables built by checkAccessIIForLoop) and the DSPs, which
+        are limited only if "resource_limit DSP=N" is set in the configuration
+    (3) the IIs from max(minII, ResMII, RecMII) are tried until the operations can be scheduled
+    The latency of an operation is taken from the ASAP schedule, i.e. the chaining of the
+    operations in a cycle is not re-evaluated when an operation is moved.
+*/
+int HI_WithDirectiveTimingResourceEvaluation::moduloScheduleLoop(Loop *curLoop, int minII)
+{
+    BasicBlock *Header = curLoop->getHeader();
+    std::string tmp_loop_name = Header->getParent()->getName();
+    tmp_loop_name += "-";
+    tmp_loop_name += Header->getName();
+    assert(IRLoop2LoopLabel.find(tmp_loop_name) != IRLoop2LoopLabel.end());
+    std::string label = IRLoop2LoopLabel[tmp_loop_name];
+
+    std::vector<Instruction *> ops;
+    std::vector<int> opLatency;
+    std::vector<LoopDependenceEdge> edges;
+    getLoopDependenceGraph(curLoop, ops, opLatency, edges);
+
+    int opNum = ops.size();
+    HI_ModuloScheduler scheduler(opNum);
+    for (int op = 0; op < opNum; op++)
+        scheduler.setLatency(op, opLatency[op]);
+    for (auto &edge : edges)
+        scheduler.addEdge(edge.from, edge.to, edge.delay, edge.distance);
+
+    // the accesses to the same targets in an iteration keep their order, except two loads
+    std::vector<int> accessOps;
+    for (int op = 0; op < opNum; op++)
+        if (ops[op]->getOpcode() == Instruction::Load || ops[op]->getOpcode() == Instruction::Store)
+            accessOps.push_back(op);
+    for (int i = 0, e = accessOps.size(); i < e; i++)
+    {
+        Instruction *I0 = ops[accessOps[i]];
+        for (int j = i + 1; j < e; j++)
+        {
+            Instruction *I1 = ops[accessOps[j]];
+            if (I0->getOpcode() == Instruction::Load && I1->getOpcode() == Instruction::Load)
+                continue;
+            if (!hasSameTargets(I0, I1))
+                continue;
+            int delay = (I0->getOpcode() == Instruction::Store) ? opLatency[accessOps[i]] : 0;
+            scheduler.addEdge(accessOps[i], accessOps[j], delay, 0);
+        }
+    }
+
+    // the ports of the partitions
+    std::map<std::pair<Value *, partition_info>, int> partition2Resource;
+    for (auto &val_partition_MRT : accessMRTsForIITest)
+        partition2Resource[val_partition_MRT.first] =
+            scheduler.addResource(val_partition_MRT.second.getPortNum());
+    for (auto op : accessOps)
+    {
+        Instruction *I = ops[op];
+        if (Access2TargetMap.find(I) == Access2TargetMap.end() || Access2TargetMap[I].empty() ||
+            Inst2Partitions.find(I) == Inst2Partitions.end())
+            continue;
+        Value *target = Access2TargetMap[I][0];
+        if (Alias2Target.find(target) != Alias2Target.end())
+            target = Alias2Target[target];
+        for (auto &partID : Inst2Partitions[I])
+        {
+            auto resource_it =
+                partition2Resource.find(std::pair<Value *, partition_info>(target, partID));
+            if (resource_it != partition2Resource.end())
+                scheduler.addUsage(op, resource_it->second);
+        }
+    }
+
+    // the DSPs
+    int DSPResource = scheduler.addResource(configInfo.DSPLimit);
+    for (int op = 0; op < opNum; op++)
+    {
+        int DSPnum = getInstructionResource(ops[op]).DSP;
+        if (DSPnum > 0)
+            scheduler.addUsage(op, DSPResource, DSPnum);
+    }
+
+    int latLoop = Loop2CP[Header];
+    int II = scheduler.schedule(minII, std::max(minII, latLoop) + opNum + 1);
+    if (DEBUG)
+        *Evaluating_log << "--------- modulo scheduling for Loop " << curLoop->getName() << "("
+                        << label << "): ResMII=" << scheduler.getResMII()
+                        << " RecMII=" << scheduler.getRecMII() << " achieved II=" << II << "\n";
+    if (II < 0)
+        return -1;
+
+    int depth = scheduler.getDepth();
+    Loop2PipelineDepth[Header] = depth;
+
+    int stageNum = scheduler.getStageNum();
+    std::vector<resourceBase> stageResource(stageNum, resourceBase(0, 0, 0, clock_period));
+    for (int op = 0; op < opNum; op++)
+    {
+        int stage = scheduler.getStartTime(op) / II;
+        stageResource[stage] = stageResource[stage] + getInstructionResource(ops[op]);
+    }
+
+    // report the schedule: the achieved II, the pipeline depth and the usage of each stage
+    print_info("Modulo-scheduled loop: [" + label + "] II=" + std::to_string(II) +
+               " pipeline depth=" + std::to_string(depth) +
+               " stages=" + std::to_string(stageNum));
+    for (int stage = 0; stage < stageNum; stage++)
+    {
+        std::string stageStr;
+        raw_string_ostream stage_os(stageStr);
+        stage_os << "    stage#" << stage << ": " << stageResource[stage]
+                 << " DSP units=" << scheduler.getStageUsage(stage, DSPResource);
+        for (auto &val_partition_resource : partition2Resource)
+            stage_os << " [" << val_partition_resource.first.first->getName() << " partition#"
+                     << val_partition_resource.first.second
+                     << "]=" << scheduler.getStageUsage(stage, val_partition_resource.second);
+        print_info(stage_os.str());
+    }
+
+    if (DEBUG)
+    {
+        *Evaluating_log << "--------- pipeline depth=" << depth << " stages=" << stageNum << "\n";
+        for (int op = 0; op < opNum; op++)
+            *Evaluating_log << "            cycle#" << scheduler.getStartTime(op) << " (stage#"
+                            << scheduler.getStartTime(op) / II << "): " << *ops[op] << "\n";
+    }
+    return II;
+}
@@ -0,0 +1,320 @@
+#include "HI_InstructionIndex.h"
+#include "llvm/IR/BasicBlock.h"
+#include "llvm/IR/Function.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include <chrono>
+#include <iterator>
+#include <map>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <sys/resource.h>
+
+using namespace llvm;
+
+/*
+    compare the ways to keep the per-instruction state of the block evaluation in
+    HI_WithDirectiveTimingResourceEvaluation:
+    (1) std::map keyed by the instruction pointers (the original containers)
+    (2) HI_InstColumn accessed by the instruction pointers, i.e. a DenseMap lookup for the ID on
+        every access
+    (3) HI_InstColumn accessed by the IDs, walking the block and the operands by their IDs like
+        BlockLatencyResourceEvaluation
+    The synthetic module has chains of binary operators in its blocks, and each instruction reads
+    the critical paths of its operands in the block, updates its own critical path, latest operand
+    and schedule, which is the access pattern of the block evaluation.
+*/
+
+// the critical path of an instruction, like timingBase
+struct CriticalPath
+{
+    int latency;
+    double timing;
+};
+
+// build the functions with the blocks of chained binary operators
+static void buildSyntheticModule(Module &M, int funcNum, int blockNum, int instNum)
+{
+    LLVMContext &Context = M.getContext();
+    Type *Int32Ty = Type::getInt32Ty(Context);
+    FunctionType *FT = FunctionType::get(Int32Ty, {Int32Ty, Int32Ty}, false);
+    for (int f = 0; f < funcNum; f++)
+    {
+        Function *F =
+            Function::Create(FT, Function::ExternalLinkage, "kernel_" + std::to_string(f), &M);
+        Value *a = &*F->arg_begin(), *b = &*std::next(F->arg_begin());
+        BasicBlock *B = BasicBlock::Create(Context, "entry", F);
+        IRBuilder<> Builder(B);
+        for (int blk = 0; blk < blockNum; blk++)
+        {
+            Value *prev0 = a, *prev1 = b;
+            for (int i = 0; i < instNum; i++)
+            {
+                Value *cur = (i % 3 == 0)   ? Builder.CreateAdd(prev0, prev1)
+                             : (i % 3 == 1) ? Builder.CreateMul(prev0, b)
+                                            : Builder.CreateXor(prev1, prev0);
+                prev1 = prev0;
+                prev0 = cur;
+            }
+            BasicBlock *nextB = BasicBlock::Create(Context, "B" + std::to_string(blk), F);
+            Builder.CreateBr(nextB);
+            Builder.SetInsertPoint(nextB);
+            a = prev0;
+        }
+        Builder.CreateRet(a);
+    }
+}
+
+// (1) the state in std::map keyed by the pointers
+static long evaluateWithMaps(Module &M)
+{
+    std::map<Instruction *, CriticalPath> criticalPath;
+    std::map<Instruction *, Instruction *> latestOperand;
+    std::map<Instruction *, int> schedule;
+    long checksum = 0;
+    for (auto &F : M)
+        for (auto &B : F)
+        {
+            for (auto &rI : B)
+            {
+                Instruction *I = &rI;
+                criticalPath[I] = CriticalPath{1, 0.5};
+                for (auto &op : I->operands())
+                {
+                    auto I_Pred = dyn_cast<Instruction>(op.get());
+                    if (!I_Pred || I_Pred->getParent() != &B ||
+                        criticalPath.find(I_Pred) == criticalPath.end())
+                        continue;
+                    if (criticalPath[I_Pred].latency + 1 >= criticalPath[I].latency)
+                    {
+                        criticalPath[I] = CriticalPath{criticalPath[I_Pred].latency + 1, 0.5};
+                        latestOperand[I] = I_Pred;
+                    }
+                }
+                schedule[I] = criticalPath[I].latency - 1;
+                checksum += schedule[I];
+            }
+        }
+    return checksum;
+}
+
+// (2) the columns accessed by the pointers
+static long evaluateWithColumnsByPointer(const HI_InstructionIndex &index,
+                                         HI_InstColumn<CriticalPath> &criticalPath,
+                                         HI_InstColumn<Instruction *> &latestOperand,
+                                         HI_InstColumn<int> &schedule, Module &M)
+{
+    long checksum = 0;
+    for (auto &F : M)
+        for (auto &B : F)
+        {
+            HI_BlockInstView<CriticalPath> blockCriticalPath(criticalPath, index, &B);
+            for (auto &rI : B)
+            {
+                Instruction *I = &rI;
+                blockCriticalPath[I] = CriticalPath{1, 0.5};
+                for (auto &op : I->operands())
+                {
+                    auto I_Pred = dyn_cast<Instruction>(op.get());
+                    if (!I_Pred || !blockCriticalPath.count(I_Pred))
+                        continue;
+                    if (blockCriticalPath[I_Pred].latency + 1 >= blockCriticalPath[I].latency)
+                    {
+                        blockCriticalPath[I] =
+                            CriticalPath{blockCriticalPath[I_Pred].latency + 1, 0.5};
+                        latestOperand[I] = I_Pred;
+                    }
+                }
+                schedule[I] = blockCriticalPath[I].latency - 1;
+                checksum += schedule[I];
+            }
+        }
+    return checksum;
+}
+
+// (3) the columns accessed by the IDs
+static long evaluateWithColumnsByID(const HI_InstructionIndex &index,
+                                    HI_InstColumn<CriticalPath> &criticalPath,
+                                    HI_InstColumn<Instruction *> &latestOperand,
+                                    HI_InstColumn<int> &schedule, Module &M)
+{
+    long checksum = 0;
+    for (auto &F : M)
+        for (auto &B : F)
+        {
+            HI_BlockInstView<CriticalPath> blockCriticalPath(criticalPath, index, &B);
+            for (int ID = blockCriticalPath.getBeginID(), endID = blockCriticalPath.getEndID();
+                 ID < endID; ID++)
+            {
+                Instruction *I = index.getInst(ID);
+                blockCriticalPath[ID] = CriticalPath{1, 0.5};
+                for (unsigned op = 0, opNum = I->getNumOperands(); op < opNum; op++)
+                {
+                    int predID = index.getOperandID(ID, op);
+                    if (predID < 0 || !blockCriticalPath.count(predID))
+                        continue;
+                    if (blockCriticalPath[predID].latency + 1 >= blockCriticalPath[ID].latency)
+                    {
+                        blockCriticalPath[ID] =
+                            CriticalPath{blockCriticalPath[predID].latency + 1, 0.5};
+                        latestOperand[ID] = index.getInst(predID);
+                    }
+                }
+                schedule[ID] = blockCriticalPath[ID].latency - 1;
+                checksum += schedule[ID];
+            }
+        }
+    return checksum;
+}
+
+template <class Func> static double timeInMs(Func func, long &checksum)
+{
+    auto begin = std::chrono::steady_clock::now();
+    checksum = func();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - begin).count();
+}
+
+// the peak resident set size of the process in KB
+static long peakRSSInKB()
+{
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+}
+
+// run only one of the evaluations, so the growth of the peak RSS of the process is the memory of
+// its state. The numbering (from moduleRSS) is only needed by the columns.
+static int runOneEvaluation(Module &M, const HI_InstructionIndex &index, int roundNum,
+                            std::string evaluation, long moduleRSS)
+{
+    long baseRSS = peakRSSInKB();
+    double time = 0;
+    long checksum = 0;
+    if (evaluation == "map")
+    {
+        for (int round = 0; round < roundNum; round++)
+            time += timeInMs([&]() -> long { return evaluateWithMaps(M); }, checksum);
+    }
+    else if (evaluation == "pointer" || evaluation == "ID")
+    {
+        HI_InstColumn<CriticalPath> criticalPath(index);
+        HI_InstColumn<Instruction *> latestOperand(index);
+        HI_InstColumn<int> schedule(index);
+        for (int round = 0; round < roundNum; round++)
+        {
+            criticalPath.reset();
+            latestOperand.reset();
+            schedule.reset();
+            if (evaluation == "pointer")
+                time += timeInMs(
+                    [&]() -> long {
+                        return evaluateWithColumnsByPointer(index, criticalPath, latestOperand,
+                                                            schedule, M);
+                    },
+                    checksum);
+            else
+                time += timeInMs(
+                    [&]() -> long {
+                        return evaluateWithColumnsByID(index, criticalPath, latestOperand,
+                                                       schedule, M);
+                    },
+                    checksum);
+        }
+    }
+    else
+    {
+        errs() << "the evaluation should be map, pointer or ID\n";
+        return 1;
+    }
+
+    long peakRSS = peakRSSInKB();
+    printf("instructions: %d, rounds: %d, evaluation: %s, checksum: %ld\n", index.getInstNum(),
+           roundNum, evaluation.c_str(), checksum);
+    printf("time: %.2f ms  %.1f ns/instruction\n", time,
+           time * 1e6 / ((double)index.getInstNum() * roundNum));
+    printf("peak RSS: %ld KB, module: %ld KB, numbering: %ld KB, state: %ld KB  %.1f "
+           "bytes/instruction\n",
+           peakRSS, moduleRSS, baseRSS - moduleRSS, peakRSS - baseRSS,
+           (peakRSS - baseRSS) * 1024.0 / index.getInstNum());
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 1 && argc != 5 && argc != 6)
+    {
+        errs() << "usage: ./HI_InstColumn_Benchmark [<functions> <blocks> <instructions per block> "
+                  "<rounds> [map|pointer|ID]]\n";
+        return 1;
+    }
+    int funcNum = (argc >= 5) ? atoi(argv[1]) : 64;
+    int blockNum = (argc >= 5) ? atoi(argv[2]) : 64;
+    int instNum = (argc >= 5) ? atoi(argv[3]) : 64;
+    int roundNum = (argc >= 5) ? atoi(argv[4]) : 10;
+
+    LLVMContext Context;
+    Module M("HI_InstColumn_Benchmark", Context);
+    buildSyntheticModule(M, funcNum, blockNum, instNum);
+
+    long moduleRSS = peakRSSInKB();
+    HI_InstructionIndex index;
+    double buildTime = 0;
+    long checksum = 0;
+    buildTime = timeInMs([&]() -> long {
+        index.build(M);
+        return index.getInstNum();
+    }, checksum);
+    if (argc == 6)
+        return runOneEvaluation(M, index, roundNum, argv[5], moduleRSS);
+
+    HI_InstColumn<CriticalPath> criticalPath(index);
+    HI_InstColumn<Instruction *> latestOperand(index);
+    HI_InstColumn<int> schedule(index);
+
+    double mapTime = 0, pointerTime = 0, IDTime = 0;
+    long mapChecksum = 0, pointerChecksum = 0, IDChecksum = 0;
+    for (int round = 0; round < roundNum; round++)
+    {
+        mapTime += timeInMs([&]() -> long { return evaluateWithMaps(M); }, mapChecksum);
+
+        criticalPath.reset();
+        latestOperand.reset();
+        schedule.reset();
+        pointerTime += timeInMs(
+            [&]() -> long {
+                return evaluateWithColumnsByPointer(index, criticalPath, latestOperand, schedule,
+                                                    M);
+            },
+            pointerChecksum);
+
+        criticalPath.reset();
+        latestOperand.reset();
+        schedule.reset();
+        IDTime += timeInMs(
+            [&]() -> long {
+                return evaluateWithColumnsByID(index, criticalPath, latestOperand, schedule, M);
+            },
+            IDChecksum);
+    }
+    if (mapChecksum != pointerChecksum || mapChecksum != IDChecksum)
+    {
+        errs() << "the evaluations are different: " << mapChecksum << " " << pointerChecksum
+               << " " << IDChecksum << "\n";
+        return 1;
+    }
+
+    double instTotal = (double)index.getInstNum() * roundNum;
+    printf("instructions: %d, rounds: %d, numbering: %.2f ms\n", index.getInstNum(), roundNum,
+           buildTime);
+    printf("std::map by pointer:       %8.2f ms  %6.1f ns/instruction\n", mapTime,
+           mapTime * 1e6 / instTotal);
+    printf("HI_InstColumn by pointer:  %8.2f ms  %6.1f ns/instruction  (%.2fx)\n", pointerTime,
+           pointerTime * 1e6 / instTotal, mapTime / pointerTime);
+    printf("HI_InstColumn by ID:       %8.2f ms  %6.1f ns/instruction  (%.2fx)\n", IDTime,
+           IDTime * 1e6 / instTotal, mapTime / IDTime);
+    return 0;
+}
@@ -0,0 +1,148 @@
+#include "HI_HLSLibrary.h"
+#include "HI_WithDirectiveTimingResourceEvaluation.h"
+#include "llvm/IR/DerivedTypes.h"
+#include "llvm/IR/GlobalVariable.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/raw_ostream.h"
+#include <map>
+#include <random>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+
+using namespace llvm;
+
+/*
+    check the partitions of the predictable accesses computed in closed form by
+    HI_WithDirectiveTimingResourceEvaluation::getPartitionsInClosedForm against the ones
+    enumerated by emulating the loops (generatePotentialOffset), for randomized array shapes,
+    partitions, loop increments, trip counts and initial offsets. The accesses which the closed
+    form leaves to the enumeration (negative offsets, increments carrying between the dimensions,
+    indices out of the dimensions) are generated as well.
+*/
+
+typedef HI_WithDirectiveTimingResourceEvaluation::HI_ArrayInfo HI_ArrayInfo;
+typedef HI_WithDirectiveTimingResourceEvaluation::HI_AccessInfo HI_AccessInfo;
+typedef HI_WithDirectiveTimingResourceEvaluation::partition_info partition_info;
+
+// compare the partitions in closed form with the enumerated ones for randomized accesses to the
+// target: the shapes and partitions of the array, the increments and trip counts of the loops and
+// the initial offsets, including the negative offsets, the offsets out of the array and the
+// increments carrying between the dimensions, which the closed form leaves to the enumeration.
+// The number of the mismatches is returned.
+int testPartitionsInClosedForm(HI_WithDirectiveTimingResourceEvaluation &evaluator, Value *target,
+                               int testNum, unsigned seed)
+{
+    std::mt19937 rng(seed);
+    auto randInt = [&](int lo, int hi) -> int {
+        return std::uniform_int_distribution<int>(lo, hi)(rng);
+    };
+
+    int closedFormNum = 0, negativeOffsetNum = 0, otherFallbackNum = 0, mismatchNum = 0;
+    for (int t = 0; t < testNum; t++)
+    {
+        HI_ArrayInfo arrayInfo;
+        arrayInfo.target = target;
+        arrayInfo.elementType = nullptr;
+        arrayInfo.num_dims = randInt(1, 3);
+        arrayInfo.port_num = 1;
+        for (int d = 0; d < arrayInfo.num_dims; d++)
+        {
+            arrayInfo.dim_size[d] = randInt(1, 12);
+            arrayInfo.sub_element_num[d] =
+                d == 0 ? 1 : arrayInfo.sub_element_num[d - 1] * arrayInfo.dim_size[d - 1];
+            arrayInfo.partition_size[d] = randInt(1, std::min(8, arrayInfo.dim_size[d]));
+            arrayInfo.cyclic[d] = randInt(0, 1);
+        }
+        HI_AccessInfo info(arrayInfo);
+        int total = info.dim_size[info.num_dims - 1] * info.sub_element_num[info.num_dims - 1];
+
+        info.reverse_loop_dep = randInt(1, 3);
+        for (int L = 0; L < info.reverse_loop_dep; L++)
+        {
+            // mostly the strides of the dimensions, sometimes any stride to carry between them
+            int d = randInt(0, info.num_dims - 1);
+            if (randInt(0, 3))
+                info.inc_index[L] = randInt(-3, 3) * info.sub_element_num[d];
+            else
+                info.inc_index[L] = randInt(-2 * total, 2 * total);
+            info.trip_count[L] = randInt(0, 19) ? randInt(1, 8) : (randInt(0, 1) ? 0 : 32);
+        }
+        int offsetKind = randInt(0, 9);
+        if (offsetKind == 0)
+            info.initial_offset = randInt(-total, -1);
+        else if (offsetKind == 1)
+            info.initial_offset = randInt(total, 2 * total);
+        else
+            info.initial_offset = randInt(0, total - 1);
+
+        std::vector<partition_info> partitions;
+        bool incByOne = 1, decByOne = 1;
+        if (evaluator.getPartitionsInClosedForm(info, partitions, incByOne, decByOne))
+            closedFormNum++;
+        else if (info.initial_offset < 0)
+            negativeOffsetNum++;
+        else
+            otherFallbackNum++;
+
+        if (!evaluator.checkPartitionsInClosedForm(info))
+        {
+            mismatchNum++;
+            errs() << "mismatch: dims=[";
+            for (int d = 0; d < info.num_dims; d++)
+                errs() << " " << info.dim_size[d] << "/" << info.partition_size[d]
+                       << (info.cyclic[d] ? "c" : "b");
+            errs() << " ] offset=" << info.initial_offset << " loops=[";
+            for (int L = 0; L < info.reverse_loop_dep; L++)
+                errs() << " " << info.inc_index[L] << "x" << info.trip_count[L];
+            errs() << " ]\n";
+        }
+    }
+
+    errs() << "tests: " << testNum << ", in closed form: " << closedFormNum
+           << ", enumerated for negative offsets: " << negativeOffsetNum
+           << ", enumerated for carries or indices out of dimensions: " << otherFallbackNum
+           << ", mismatches: " << mismatchNum << "\n";
+    return mismatchNum;
+}
+
+int main(int argc, char **argv)
+{
+    if (argc != 1 && argc != 3)
+    {
+        errs() << "usage: ./HI_PartitionClosedForm_Test [<tests> <seed>]\n";
+        return 1;
+    }
+    int testNum = (argc == 3) ? atoi(argv[1]) : 200000;
+    unsigned seed = (argc == 3) ? atoi(argv[2]) : 1;
+
+    // the accesses only need a target, no IR is evaluated
+    LLVMContext Context;
+    Module M("HI_PartitionClosedForm_Test", Context);
+    Value *target =
+        new GlobalVariable(M, ArrayType::get(Type::getInt32Ty(Context), 16), false,
+                           GlobalValue::ExternalLinkage, nullptr, "A");
+
+    HI_DesignConfigInfo configInfo;
+    configInfo.setClock("10");
+    configInfo.HLS_lib_path = "unused";
+    HI_HLSLibTable HLSLibTable({}, {}, std::vector<HI_HLSLibRecord>());
+
+    std::map<std::string, std::string> IRLoop2LoopLabel;
+    std::map<std::string, int> IRLoop2OriginTripCount;
+    std::map<std::string, int> LoopLabel2II;
+    std::map<std::string, int> LoopLabel2UnrollFactor;
+    std::map<std::string, int> FuncParamLine2OutermostSize;
+    std::map<std::string, std::vector<int>> IRFunc2BeginLine;
+    auto evaluator = new HI_WithDirectiveTimingResourceEvaluation(
+        configInfo, "Evaluating_Log", "BRAM_info", "ArrayLog", "top", IRLoop2LoopLabel,
+        IRLoop2OriginTripCount, LoopLabel2II, LoopLabel2UnrollFactor, FuncParamLine2OutermostSize,
+        IRFunc2BeginLine, HLSLibTable);
+
+    // the mismatching accesses are reported to errs()
+    int mismatchNum = testPartitionsInClosedForm(*evaluator, target, testNum, seed);
+    delete evaluator;
+    return mismatchNum ? 1 : 0;
+}
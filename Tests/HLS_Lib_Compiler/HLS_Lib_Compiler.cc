@@ -0,0 +1,25 @@
+#include "HI_HLSLibrary.h"
+#include "HI_InstructionFiles.h"
+#include "HI_print.h"
+
+int main(int argc, const char **argv)
+{
+    if (argc < 2)
+    {
+        print_error("Usage: ./HLS_Lib_Compiler <HLS_lib_path>");
+        return 1;
+    }
+
+    // the library path is used as a prefix of the file names, like the one in the configuration
+    std::string HLS_lib_path(argv[1]);
+    if (HLS_lib_path.back() != '/')
+        HLS_lib_path += "/";
+
+    // compile the opcodes loaded by the evaluators
+    std::vector<std::string> opcodes;
+    for (int i = 0; i < instructionInfoNum; i++)
+        if (instructionHasMappingFile[i])
+            opcodes.push_back(instructionNames[i]);
+
+    return HI_compileHLSLibrary(HLS_lib_path, opcodes) ? 0 : 1;
+}
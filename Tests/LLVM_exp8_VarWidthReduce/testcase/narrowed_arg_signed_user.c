@@ -0,0 +1,21 @@
+// The argument of scale_and_offset is in [0, 255] at all the call sites, so t = a * 3 in [0, 765]
+// is narrowed to 10 bits, where its top bit is set for a >= 171. The subtraction is signed (its
+// range is [-1000, -235]) and needs 11 bits, so t should be zero-extended to it and the result
+// sign-extended back. With the extensions the other way round, 765 becomes -259 and the i11
+// result -1259 is zero-extended to 789, so top(255) returns 1837 instead of -1235.
+//
+//     ./LLVM_exp8_VarWidthReduce testcase/narrowed_arg_signed_user.c top
+//
+// In top_output.ll, scale_and_offset should extend the narrowed product with "zext i10" and its
+// result with "sext i11". narrowed_arg_signed_user_main.c runs top(255) on the output.
+
+__attribute__((noinline)) int scale_and_offset(int a)
+{
+    int t = a * 3;
+    return t - 1000;
+}
+
+int top(int x)
+{
+    return scale_and_offset(x & 255) + scale_and_offset((x >> 8) & 255);
+}
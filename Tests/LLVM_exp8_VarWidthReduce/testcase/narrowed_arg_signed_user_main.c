@@ -0,0 +1,15 @@
+// Runs top(255) of the output of narrowed_arg_signed_user.c, it should print -1235:
+//
+//     clang top_output.ll testcase/narrowed_arg_signed_user_main.c -o narrowed_arg_signed_user
+//     ./narrowed_arg_signed_user
+
+#include <stdio.h>
+
+int top(int x);
+
+int main()
+{
+    int result = top(255);
+    printf("top(255) = %d\n", result);
+    return result != -1235;
+}
@@ -0,0 +1,82 @@
+#! /bin/bash
+
+# Compare the latency/resource reports of two builds of Light_HLS_Top on the designs in App/, e.g.
+# the builds before and after a change of the evaluator which should not change any result:
+#
+#       ./CompareQoR.sh <old Light_HLS_Top> <new Light_HLS_Top> [design list]
+#
+# Each line of the design list (QoR_Designs.txt by default) is "<source> <top function> <config>",
+# with the paths relative to this directory. The summaries of the two builds are kept in
+# QoR_old/ and QoR_new/, and the script exits with 1 if any latency/DSP/FF/LUT/BRAM differs.
+# The evaluation time of each design (and the peak RSS of the process, if GNU time is installed as
+# /usr/bin/time) is kept in Perf_Summary of the two directories and listed side by side, so the
+# cost of the evaluator can be compared as well.
+
+curr_path="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+
+if [ $# -lt 2 ]
+then
+    echo "Usage: $0 <old Light_HLS_Top> <new Light_HLS_Top> [design list]"
+    exit 1
+fi
+
+old_bin="$( realpath $1 )"
+new_bin="$( realpath $2 )"
+design_list="$( realpath ${3:-$curr_path/QoR_Designs.txt} )"
+
+cd $curr_path
+
+# the HLS_lib_path in the configurations is relative to a directory at the depth of build/
+run_designs()
+{
+    bin=$1
+    out_dir=$2
+    rm -rf $out_dir
+    mkdir $out_dir
+    cd $out_dir
+    design_id=0
+    while read source top config
+    do
+        if [ "$source" == "" ] || [ "${source:0:1}" == "#" ]
+        then
+            continue
+        fi
+        echo "../$config" > config_list_$design_id
+        if [ -x /usr/bin/time ]
+        then
+            /usr/bin/time -f "%M" -o rss_$design_id \
+                $bin ../$source $top config_list_$design_id BATCH < /dev/null > log_$design_id 2>&1
+            peak_rss="$( tail -n 1 rss_$design_id )"
+        else
+            $bin ../$source $top config_list_$design_id BATCH < /dev/null > log_$design_id 2>&1
+            peak_rss="-"
+        fi
+        # the evaluation time (column 7) differs from run to run, so it is kept apart
+        if [ -f DSE_Summary ]
+        then
+            tail -n +2 DSE_Summary | cut -f 2-6 | sed "s|^|$source $top |" >> QoR_Summary
+            eval_time="$( tail -n +2 DSE_Summary | awk -F '\t' '{ t += $7 } END { print t }' )"
+            echo "$source $top $eval_time $peak_rss" >> Perf_Summary
+        else
+            echo "$source $top failed" >> QoR_Summary
+            echo "$source $top - -" >> Perf_Summary
+        fi
+        rm -f DSE_Summary
+        design_id=$((design_id + 1))
+    done < $design_list
+    cd $curr_path
+}
+
+run_designs $old_bin QoR_old
+run_designs $new_bin QoR_new
+
+echo "design, top function, old/new evaluation time (s), old/new peak RSS (KB):"
+paste -d " " QoR_old/Perf_Summary QoR_new/Perf_Summary | awk '{print $1, $2, $3 "/" $7, $4 "/" $8}'
+
+if diff QoR_old/QoR_Summary QoR_new/QoR_Summary
+then
+    echo "The QoR of all the $(wc -l < QoR_new/QoR_Summary) designs is unchanged."
+    exit 0
+fi
+echo "The QoR is changed."
+exit 1
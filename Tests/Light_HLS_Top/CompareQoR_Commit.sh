@@ -0,0 +1,99 @@
+#! /bin/bash
+
+# Check that a commit keeps the latency/resource reports of the designs in App/: Light_HLS_Top is
+# built at the commit and at its parent (in git worktrees) and the two builds are compared by
+# CompareQoR.sh.
+#
+#       ./CompareQoR_Commit.sh [<commit> [design list]]
+#
+# Without arguments, the checks listed in QoR_Checks.txt ("<commit> <design list>" per line) are
+# run one by one. The output of each check is recorded in QoR_Records/<commit>, ending with the
+# result of the comparison, and the script exits with 1 if any check fails.
+#
+# The builds need LLVM 9 (with clang and polly). Set LLVM_PREFIX to its installation if it is not
+# the default one, e.g. LLVM_PREFIX=/usr/lib/llvm-9 ./CompareQoR_Commit.sh. The script exits with 2
+# without building anything if the toolchain is not LLVM 9.
+
+curr_path="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+cd $curr_path
+
+work_dir=$curr_path/QoR_worktrees
+
+check_toolchain()
+{
+    if [ "$LLVM_PREFIX" != "" ]
+    then
+        export PATH=$LLVM_PREFIX/bin:$PATH
+        export CMAKE_PREFIX_PATH=$LLVM_PREFIX:$CMAKE_PREFIX_PATH
+    fi
+    version="$( llvm-config --version 2>/dev/null )"
+    if [ "${version%%.*}" != "9" ]
+    then
+        echo "LLVM 9 is required to build Light_HLS_Top, but llvm-config reports '${version:-none}'."
+        echo "Set LLVM_PREFIX to the installation of LLVM 9."
+        return 1
+    fi
+}
+
+build_at()
+{
+    rev=$1
+    tree=$2
+    git worktree add --detach $tree $rev > /dev/null || return 1
+    $tree/Tests/Light_HLS_Top/Build.sh > $tree/build_log 2>&1
+    [ -x $tree/Tests/Light_HLS_Top/build/Light_HLS_Top ]
+}
+
+remove_worktrees()
+{
+    rm -rf $work_dir
+    git worktree prune
+}
+
+check_commit()
+{
+    commit="$( git rev-parse --short $1 )" || return 1
+    design_list="$( realpath ${2:-$curr_path/QoR_Designs.txt} )"
+    record=$curr_path/QoR_Records/$commit
+
+    remove_worktrees
+    mkdir -p $work_dir
+    echo "commit $commit ($( git log -1 --format=%s $commit ))" > $record
+    echo "design list $design_list" >> $record
+    if ! build_at $commit^ $work_dir/old || ! build_at $commit $work_dir/new
+    then
+        echo "failed to build Light_HLS_Top:" >> $record
+        tail -n 20 $work_dir/*/build_log >> $record
+        cat $record
+        remove_worktrees
+        return 1
+    fi
+
+    $curr_path/CompareQoR.sh $work_dir/old/Tests/Light_HLS_Top/build/Light_HLS_Top \
+        $work_dir/new/Tests/Light_HLS_Top/build/Light_HLS_Top $design_list >> $record 2>&1
+    result=$?
+    cat $record
+
+    remove_worktrees
+    return $result
+}
+
+check_toolchain || exit 2
+mkdir -p QoR_Records
+
+if [ $# -ge 1 ]
+then
+    check_commit $1 $2
+    exit $?
+fi
+
+failed=0
+while read commit design_list
+do
+    if [ "$commit" == "" ] || [ "${commit:0:1}" == "#" ]
+    then
+        continue
+    fi
+    check_commit $commit $curr_path/$design_list < /dev/null || failed=1
+done < QoR_Checks.txt
+exit $failed
@@ -0,0 +1,77 @@
+#! /bin/bash
+
+# Compare the single-sweep HI_RemoveRedundantAccess with the reference mode restarting the walk
+# after each removal ("redundant_access_removal = restart") on the designs in App/:
+#
+#       ./CompareRedundantAccess.sh <Light_HLS_Top> [design list]
+#
+# Each design of the list (QoR_Designs.txt by default) is evaluated in both modes. The numbers of
+# removed loads/stores and the time of each run of the pass are listed side by side, and the
+# script exits with 1 if the numbers of any design differ.
+
+curr_path="$( cd "$( dirname "${BASH_SOURCE[0]}" )" >/dev/null 2>&1 && pwd )"
+
+if [ $# -lt 1 ]
+then
+    echo "Usage: $0 <Light_HLS_Top> [design list]"
+    exit 1
+fi
+
+bin="$( realpath $1 )"
+design_list="$( realpath ${2:-$curr_path/QoR_Designs.txt} )"
+
+cd $curr_path
+
+# the HLS_lib_path in the configurations is relative to a directory at the depth of build/
+run_designs()
+{
+    mode=$1
+    out_dir=RedundantAccess_$mode
+    rm -rf $out_dir
+    mkdir $out_dir
+    cd $out_dir
+    design_id=0
+    while read source top config
+    do
+        if [ "$source" == "" ] || [ "${source:0:1}" == "#" ]
+        then
+            continue
+        fi
+        cp ../$config config_$design_id
+        if [ "$mode" == "restart" ]
+        then
+            echo "redundant_access_removal = restart" >> config_$design_id
+        fi
+        echo "config_$design_id" > config_list_$design_id
+        $bin ../$source $top config_list_$design_id BATCH < /dev/null > log_$design_id 2>&1
+        # "done HI_RemoveRedundantAccess (<mode>): removed <N> loads and <M> stores in <T> s"
+        runs="$( grep "done HI_RemoveRedundantAccess" log_$design_id | sed "s/.*): removed //" )"
+        if [ "$runs" == "" ]
+        then
+            echo "$source $top failed" >> Removal_Summary
+            echo "$source $top -" >> Time_Summary
+        else
+            echo "$source $top $( echo "$runs" | awk '{printf "%s/%s ", $1, $4}' )" >> Removal_Summary
+            echo "$source $top $( echo "$runs" | awk '{printf "%s ", $7}' )" >> Time_Summary
+        fi
+        rm -f DSE_Summary
+        design_id=$((design_id + 1))
+    done < $design_list
+    cd $curr_path
+}
+
+run_designs single_sweep
+run_designs restart
+
+echo "design, top function, removed loads/stores of each run of the pass (single-sweep | restart):"
+paste -d "|" RedundantAccess_single_sweep/Removal_Summary RedundantAccess_restart/Removal_Summary
+echo "design, top function, time (s) of each run of the pass (single-sweep | restart):"
+paste -d "|" RedundantAccess_single_sweep/Time_Summary RedundantAccess_restart/Time_Summary
+
+if diff RedundantAccess_single_sweep/Removal_Summary RedundantAccess_restart/Removal_Summary > /dev/null
+then
+    echo "The removed loads/stores of all the designs are the same in the two modes."
+    exit 0
+fi
+echo "The removed loads/stores are different."
+exit 1
@@ -7,6 +7,7 @@ extern double LUT_limit;
 extern double BRAM_limit;
 extern int ClockNum_limit;
 extern bool all_sub_function_inline;
+extern bool redundant_access_restart;
 
 void Parse_Config(const char *config_file_name, std::map<std::string, int> &LoopLabel2UnrollFactor,
                   std::map<std::string, int> &LoopLabel2II)
@@ -66,6 +67,12 @@ void Parse_Config(const char *config_file_name, std::map<std::string, int> &Loop
             all_sub_function_inline = 1;
             break;
 
+        case hash_compile_time("redundant_access_removal"):
+            consumeEqual(iss);
+            iss >> tmpStr_forParsing;
+            redundant_access_restart = (tmpStr_forParsing == "restart");
+            break;
+
         default:
             break;
         }
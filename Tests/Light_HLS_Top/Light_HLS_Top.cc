@@ -17,19 +17,63 @@ double LUT_limit;
 double BRAM_limit;
 int ClockNum_limit;
 bool all_sub_function_inline;
+bool redundant_access_restart;
+
+// Parse_Config sets the global configuration variables above, so the parsing of the design
+// points evaluated by different workers should not overlap
+static std::mutex ConfigParseMutex;
 
 int main(int argc, const char **argv)
 {
     if (argc < 4)
     {
-        errs() << "Usage: " << argv[0] << " <C/C++ file> <Top_Function_Name> <Config_File_Path>\n";
+        errs() << "Usage: " << argv[0]
+               << " <C/C++ file> <Top_Function_Name> <Config_File_Path> [BATCH] [THREADS=<N>] "
+                  "[DEBUG]\n";
+        errs() << "       with BATCH, <Config_File_Path> is a file listing one configuration "
+                  "file per line\n";
+        errs() << "       if <Config_File_Path> is a directory, all the configuration files in it "
+                  "are evaluated\n";
+        errs() << "       with THREADS=<N>, the design points are evaluated by N parallel "
+                  "workers\n";
         return 1;
     }
-    std::error_code EC;
 
     std::string top_str = std::string(argv[2]);
-    std::string configFile_str = std::string(argv[3]);
-    bool debugFlag = (argc == 5 && std::string(argv[4]) == "DEBUG");
+    std::string configArg_str = std::string(argv[3]);
+    bool debugFlag = false;
+    bool batchFlag = false;
+    int threadNum = 1;
+    for (int i = 4; i < argc; i++)
+    {
+        std::string arg_str(argv[i]);
+        if (arg_str == "DEBUG")
+            debugFlag = true;
+        if (arg_str == "BATCH")
+            batchFlag = true;
+        if (arg_str.find("THREADS=") == 0)
+        {
+            std::string threadNum_str = arg_str.substr(8);
+            if (threadNum_str == "" ||
+                threadNum_str.find_first_not_of("0123456789") != std::string::npos ||
+                threadNum_str.size() > 4 || std::stoi(threadNum_str) < 1)
+            {
+                errs() << "Invalid argument [" << arg_str
+                       << "]: THREADS=<N> expects a positive integer, e.g. THREADS=16\n";
+                return 1;
+            }
+            threadNum = std::stoi(threadNum_str);
+        }
+    }
+
+    // get the list of design configurations to be evaluated in this process
+    std::vector<std::string> configFiles = collectDesignPointConfigs(configArg_str, batchFlag);
+    if (configFiles.empty())
+    {
+        print_error("No configuration file is found in [" + configArg_str + "].");
+        return 1;
+    }
+    std::string configFile_str = configFiles[0];
 
     /////////////////////////////////////////////////////////////////////////////////////
     // Clang part for Front-End Processing                                             //
@@ -42,360 +86,577 @@ int main(int argc, const char **argv)
     std::map<std::string, int> LoopLabel2UnrollFactor;
     std::map<std::string, int> LoopLabel2II;
 
+    // the front-end processing and the HLS library only depend on the first configuration,
+    // so they are done once and shared by all the design points
     all_sub_function_inline = 0;
     Parse_Config(configFile_str.c_str(), LoopLabel2UnrollFactor, LoopLabel2II);
-    clangPreProcess(argv, top_str, FuncParamLine2OutermostSize);
-
-    // Compile the source code into IR and Parse the input LLVM IR file into a module
-    std::string cmd_str = "clang -O1 -emit-llvm -S -g tmp_loopLabeled.cc -o top_notinline.bc 2>&1";
-    print_cmd(cmd_str.c_str());
-    bool result = sysexec(cmd_str.c_str());
-    assert(result); // ensure the cmd is executed successfully
-    cmd_str = "opt -always-inline top_notinline.bc -o top.bc 2>&1";
-    print_cmd(cmd_str.c_str());
-    result = sysexec(cmd_str.c_str());
-    assert(result); // ensure the cmd is executed successfully
-
-    // system(cmd_str.c_str());
+    bool frontEnd_sub_function_inline = all_sub_function_inline;
+    std::string frontEnd_HLS_lib_path = HLS_lib_path;
+    std::string labeledSourceCode;
+    std::vector<std::string> includePaths = pathAdvice();
+    clangPreProcess(argv, top_str, FuncParamLine2OutermostSize, includePaths, labeledSourceCode);
+    if (labeledSourceCode == "")
+    {
+        print_error("Failed to process the source code [" + std::string(argv[1]) + "].");
+        return 1;
+    }
 
-    SMDiagnostic Err;
+    // Compile the source code into IR in-process, the module goes to the passes directly.
+    // "tmp_loopLabeled.cc" is only the name of the in-memory file recorded in the debug info.
     LLVMContext Context;
     LLVMInitializeX86TargetInfo();
     LLVMInitializeX86Target();
     LLVMInitializeX86TargetMC();
-    std::unique_ptr<llvm::Module> Mod(parseIRFile("top.bc", Err, Context));
+    std::unique_ptr<llvm::Module> Mod =
+        clangCompileToModule("tmp_loopLabeled.cc", labeledSourceCode, includePaths, Context);
     if (!Mod)
-    {
-        Err.print(argv[0], errs());
         return 1;
-    }
 
-    std::map<std::string, Info_type_list> BiOp_Info_name2list_map;
-    DES_Load_Instruction_Info(configFile_str.c_str(), BiOp_Info_name2list_map);
+    std::unique_ptr<HI_HLSLibTable> HLSLibTable = DES_Load_Instruction_Info(configFile_str.c_str());
+    if (!HLSLibTable)
+        return 1;
 
-    for (auto pair : BiOp_Info_name2list_map)
+    // the design point must be compatible with the cached front-end module and HLS library
+    std::vector<DesignPointResult> pointResults(configFiles.size());
+    std::vector<int> validPoints;
+    for (int i = 0; i < configFiles.size(); i++)
     {
-        llvm::errs() << "instruction type: [" << pair.first << "] loaded\n";
+        pointResults[i].configFile = configFiles[i];
+        all_sub_function_inline = 0;
+        HLS_lib_path = "";
+        Parse_Config(configFiles[i].c_str(), LoopLabel2UnrollFactor, LoopLabel2II);
+        if (all_sub_function_inline != frontEnd_sub_function_inline ||
+            HLS_lib_path != frontEnd_HLS_lib_path)
+        {
+            print_error("Configuration [" + configFiles[i] +
+                        "] requires different front-end settings (all_sub_function_inline / "
+                        "HLS_lib_path) from [" +
+                        configFile_str + "] and is skipped.");
+            continue;
+        }
+        validPoints.push_back(i);
     }
 
     // you can set different configuration for different iteration
-    for (int i = 0; i < 1; i++)
+    if (threadNum <= 1 || validPoints.size() <= 1)
     {
-        std::string cntStr = std::to_string(i);
-        std::unique_ptr<llvm::Module> Mod_tmp = CloneModule(*Mod);
-
-        // Create a pass manager and fill it with the passes we want to run.
-        legacy::PassManager PM_pre, PM0, PM1, PM2, PM3, PM4, PM_eval;
-
-        LLVMTargetRef T;
-        ModulePassManager MPM;
-
-        char *Error;
-
-        if (LLVMGetTargetFromTriple((Mod_tmp->getTargetTriple()).c_str(), &T, &Error))
+        for (int i : validPoints)
         {
-            print_error(Error);
-        }
-        else
-        {
-            std::string targetname = LLVMGetTargetName(T);
-            targetname = "The target machine is: " + targetname;
-            print_info(targetname.c_str());
+            print_status("Evaluating design point #" + std::to_string(i) + ": " + configFiles[i]);
+            evaluateDesignPoint(*Mod, configFiles[i], top_str, i, FuncParamLine2OutermostSize,
+                                *HLSLibTable, debugFlag, pointResults[i]);
         }
+    }
+    else
+    {
+        // each worker owns its LLVMContext and takes the next design point until all the points
+        // are evaluated. The results are stored by point index, so the summary is deterministic.
+        threadNum = std::min(threadNum, (int)validPoints.size());
+
+        // keep the bitcode in memory, so the workers can parse it into their own LLVMContext
+        SmallVector<char, 0> ModBitcode;
+        raw_svector_ostream ModBitcodeStream(ModBitcode);
+        WriteBitcodeToFile(*Mod, ModBitcodeStream);
+        std::unique_ptr<MemoryBuffer> ModBuffer = MemoryBuffer::getMemBuffer(
+            StringRef(ModBitcode.data(), ModBitcode.size()), "top.bc", false);
+
+        print_status("Evaluating " + std::to_string(validPoints.size()) + " design points with " +
+                     std::to_string(threadNum) + " workers");
+        std::atomic<int> nextPoint(0);
+        std::vector<std::thread> workers;
+        for (int t = 0; t < threadNum; t++)
+            workers.push_back(std::thread(evaluateDesignPointsInWorker, std::cref(*ModBuffer),
+                                          std::cref(configFiles), std::cref(validPoints),
+                                          top_str, std::ref(nextPoint),
+                                          FuncParamLine2OutermostSize,
+                                          std::cref(*HLSLibTable), debugFlag,
+                                          std::ref(pointResults)));
+        for (auto &worker : workers)
+            worker.join();
+    }
 
-        std::map<std::string, std::string> IRLoop2LoopLabel;
-        std::map<std::string, int> LoopLabel2UnrollFactor;
-        std::map<std::string, int> LoopLabel2II;
-        std::map<std::string, int> IRLoop2OriginTripCount;
-        std::map<std::string, int> IRLoop2OriginTripCount_eval;
+    if (batchFlag || configFiles.size() > 1)
+        printDesignPointSummary(pointResults, "DSE_Summary");
 
-        Parse_Config(configFile_str.c_str(), LoopLabel2UnrollFactor, LoopLabel2II);
+    return 0;
+}
 
-        /////////////////////////////////////////////////////////////////////////////////////
-        // Front-end Passes running for optimizations, including                           //
-        // Loop Extraction                                                                 //
-        // Loop Simplification                                                             //
-        // Loop Stregnth Reducation                                                        //
-        // Duplicated Instruction Removal                                                  //
-        // Function Initiation                                                             //
-        // Instruction Optimization: Multiplication / Instruction Hoisting /               //
-        //                          Redundant Access Removal / Bitwidth Reduction/ etc..   //
-        /////////////////////////////////////////////////////////////////////////////////////
-
-        print_info("Enable LoopSimplify Pass");
-        auto loopsimplifypass_pre = createLoopSimplifyPass();
-        PM_pre.add(loopsimplifypass_pre);
-
-        auto indvarsimplifypass_pre = createIndVarSimplifyPass();
-        PM_pre.add(indvarsimplifypass_pre);
-        print_info("Enable IndVarSimplifyPass Pass");
-
-        auto CFGSimplification_pass22_pre = createCFGSimplificationPass();
-        PM_pre.add(CFGSimplification_pass22_pre);
-        print_info("Enable CFGSimplificationPass Pass");
-
-        auto loopextract = createLoopExtractorPass(); //"HI_LoopUnroll"
-        PM_pre.add(loopextract);
-        print_info("Enable LoopExtractor Pass");
-
-        std::map<std::string, std::vector<int>> IRFunc2BeginLine;
-        auto hi_ir2sourcecode =
-            new HI_IR2SourceCode("HI_IR2SourceCode", IRLoop2LoopLabel, IRFunc2BeginLine,
-                                 IRLoop2OriginTripCount, debugFlag);
-        PM_pre.add(hi_ir2sourcecode);
-        print_info("Enable HI_IR2SourceCode Pass");
-
-        auto hi_PragmaTargetExtraction =
-            new HI_PragmaTargetExtraction(top_str.c_str(), IRLoop2LoopLabel,
-                                          FuncParamLine2OutermostSize, IRFunc2BeginLine, debugFlag);
-        PM_pre.add(hi_PragmaTargetExtraction);
-        print_info("Enable HI_PragmaTargetExtraction Pass");
-
-        print_status("Start LLVM pre-processing");
-        PM_pre.run(*Mod_tmp);
-        print_status("Accomplished LLVM pre-processing");
-
-        if (debugFlag)
+// get the list of configuration files, the argument could be a configuration file,
+// a directory of configuration files or (in BATCH mode) a file listing configuration files
+std::vector<std::string> collectDesignPointConfigs(std::string configArg_str, bool batchFlag)
+{
+    std::vector<std::string> configFiles;
+    if (llvm::sys::fs::is_directory(configArg_str))
+    {
+        std::error_code EC;
+        for (llvm::sys::fs::directory_iterator it(configArg_str, EC), itEnd; it != itEnd && !EC;
+             it.increment(EC))
         {
-            llvm::raw_fd_ostream OS3("top_output_loopextract.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OS3);
-            OS3.flush();
+            if (llvm::sys::fs::is_regular_file(it->path()))
+                configFiles.push_back(it->path());
         }
+        // keep the order of design points deterministic
+        std::sort(configFiles.begin(), configFiles.end());
+    }
+    else if (batchFlag)
+    {
+        std::ifstream list_file(configArg_str);
+        std::string tmp_s;
+        while (getline(list_file, tmp_s))
+        {
+            tmp_s = removeExtraSpace(tmp_s);
+            if (tmp_s == "" || tmp_s[0] == '#')
+                continue;
+            configFiles.push_back(tmp_s);
+        }
+    }
+    else
+    {
+        configFiles.push_back(configArg_str);
+    }
+    return configFiles;
+}
 
-        Triple ModuleTriple(Mod_tmp->getTargetTriple());
-        TargetLibraryInfoImpl TLII(ModuleTriple);
-        PM0.add(new TargetLibraryInfoWrapperPass(TLII));
-
-        print_info("Enable LoopSimplify Pass");
-        auto loopsimplifypass = createLoopSimplifyPass();
-        PM0.add(loopsimplifypass);
-
-        auto indvarsimplifypass = createIndVarSimplifyPass();
-        PM0.add(indvarsimplifypass);
-        print_info("Enable IndVarSimplifyPass Pass");
-
-        PM0.add(createTargetTransformInfoWrapperPass(TargetIRAnalysis()));
-        print_info("Enable TargetIRAnalysis Pass");
-
-        auto hi_mulorderopt = new HI_MulOrderOpt("HI_MulOrderOpt");
-        PM0.add(hi_mulorderopt);
-        print_info("Enable HI_MulOrderOpt Pass");
-
-        auto CFGSimplification_pass22 = createCFGSimplificationPass();
-        PM0.add(CFGSimplification_pass22);
-        print_info("Enable CFGSimplificationPass Pass");
-
-        auto hi_separateconstoffsetfromgep =
-            new HI_SeparateConstOffsetFromGEP("HI_SeparateConstOffsetFromGEP", true, debugFlag);
-        PM0.add(hi_separateconstoffsetfromgep);
-        print_info("Enable HI_SeparateConstOffsetFromGEP Pass");
+// worker of the design point pool: parse the shared bitcode into a module in the worker's own
+// LLVMContext and evaluate the design points one by one, the shared HLS library is only read
+void evaluateDesignPointsInWorker(
+    const MemoryBuffer &ModBuffer, const std::vector<std::string> &configFiles,
+    const std::vector<int> &validPoints, std::string top_str, std::atomic<int> &nextPoint,
+    std::map<std::string, int> FuncParamLine2OutermostSize, const HI_HLSLibTable &HLSLibTable,
+    bool debugFlag, std::vector<DesignPointResult> &pointResults)
+{
+    SMDiagnostic Err;
+    LLVMContext Context;
+    std::unique_ptr<llvm::Module> Mod(parseIR(ModBuffer.getMemBufferRef(), Err, Context));
+    if (!Mod)
+    {
+        Err.print("Light_HLS_Top worker", errs());
+        return;
+    }
 
-        auto hi_loopunroll = new HI_LoopUnroll(IRLoop2LoopLabel, LoopLabel2UnrollFactor, 1, false,
-                                               None); //"HI_LoopUnroll"
-        PM0.add(hi_loopunroll);
-        print_info("Enable HI_LoopUnroll Pass");
+    int pointCnt;
+    while ((pointCnt = nextPoint++) < validPoints.size())
+    {
+        int i = validPoints[pointCnt];
+        print_status("Evaluating design point #" + std::to_string(i) + ": " + configFiles[i]);
+        evaluateDesignPoint(*Mod, configFiles[i], top_str, i, FuncParamLine2OutermostSize,
+                            HLSLibTable, debugFlag, pointResults[i]);
+    }
+}
 
-        auto hi_mul2shl = new HI_Mul2Shl("HI_Mul2Shl", debugFlag);
-        PM0.add(hi_mul2shl);
-        print_info("Enable HI_Mul2Shl Pass");
+// print out the latency/resource of all the evaluated design points in a table and dump it to
+// the summary file
+void printDesignPointSummary(std::vector<DesignPointResult> &pointResults,
+                             const char *summary_file_name)
+{
+    std::error_code EC;
+    raw_fd_ostream summary_file(summary_file_name, EC, llvm::sys::fs::F_None);
+    summary_file << "point\tlatency\tDSP\tFF\tLUT\tBRAM\teval_time(s)\tconfig\n";
+    print_status("Summary of " + std::to_string(pointResults.size()) + " design point(s):");
+    for (int i = 0; i < pointResults.size(); i++)
+    {
+        DesignPointResult &res = pointResults[i];
+        std::string line;
+        if (res.topFunctionFound)
+            line = std::to_string(i) + "\t" + std::to_string(res.latency) + "\t" +
+                   std::to_string(res.DSP) + "\t" + std::to_string(res.FF) + "\t" +
+                   std::to_string(res.LUT) + "\t" + std::to_string(res.BRAM) + "\t" +
+                   std::to_string(res.evaluationTime) + "\t" + res.configFile;
+        else
+            line = std::to_string(i) + "\t-\t-\t-\t-\t-\t-\t" + res.configFile;
+        summary_file << line << "\n";
+        print_info(line);
+    }
+    summary_file.flush();
+}
 
-        auto loopstrengthreducepass = createLoopStrengthReducePass();
-        PM0.add(loopstrengthreducepass);
-        print_info("Enable LoopStrengthReducePass Pass");
+// evaluate one design point: clone the cached module, run the optimization passes with the
+// directives in the configuration file and evaluate the timing and resource of the top function
+bool evaluateDesignPoint(llvm::Module &Mod, std::string configFile_str, std::string top_str,
+                         int pointID, std::map<std::string, int> &FuncParamLine2OutermostSize,
+                         const HI_HLSLibTable &HLSLibTable, bool debugFlag,
+                         DesignPointResult &pointResult)
+{
+    std::error_code EC;
+    std::string cntStr = std::to_string(pointID);
+    // the design points could be evaluated by parallel workers, so all the logs and bitcode files
+    // written for a design point are suffixed with its index to avoid overwriting each other
+    std::string fileSuffix = "_" + cntStr;
+    std::unique_ptr<llvm::Module> Mod_tmp = CloneModule(Mod);
 
-        auto hi_aggressivelsr_mul = new HI_AggressiveLSR_MUL("AggressiveLSR", debugFlag);
-        PM0.add(hi_aggressivelsr_mul);
-        print_info("Enable HI_AggressiveLSR_MUL Pass");
+    struct timeval tv_begin, tv_end;
+    gettimeofday(&tv_begin, NULL);
 
-        PM0.run(*Mod_tmp);
+    // Create a pass manager and fill it with the passes we want to run.
+    legacy::PassManager PM_pre, PM0, PM1, PM2, PM3, PM4, PM_eval;
 
-        if (debugFlag)
-        {
-            llvm::raw_fd_ostream OSPM0("top_output_PM0.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OSPM0);
-            OSPM0.flush();
-        }
+    LLVMTargetRef T;
+    ModulePassManager MPM;
 
-        // don't remove chained operations
-        auto hi_hlsduplicateinstrm = new HI_HLSDuplicateInstRm("HLSrmInsts", debugFlag);
-        PM1.add(hi_hlsduplicateinstrm);
-        print_info("Enable HI_HLSDuplicateInstRm Pass");
+    char *Error;
 
-        auto CFGSimplification_pass_PM1 = createCFGSimplificationPass();
-        PM1.add(CFGSimplification_pass_PM1);
-        print_info("Enable CFGSimplificationPass Pass");
+    if (LLVMGetTargetFromTriple((Mod_tmp->getTargetTriple()).c_str(), &T, &Error))
+    {
+        print_error(Error);
+    }
+    else
+    {
+        std::string targetname = LLVMGetTargetName(T);
+        targetname = "The target machine is: " + targetname;
+        print_info(targetname.c_str());
+    }
 
-        auto hi_functioninstantiation =
-            new HI_FunctionInstantiation("HI_FunctionInstantiation", top_str);
-        PM1.add(hi_functioninstantiation);
-        print_info("Enable HI_FunctionInstantiation Pass");
+    std::map<std::string, std::string> IRLoop2LoopLabel;
+    std::map<std::string, int> LoopLabel2UnrollFactor;
+    std::map<std::string, int> LoopLabel2II;
+    std::map<std::string, int> IRLoop2OriginTripCount;
+    std::map<std::string, int> IRLoop2OriginTripCount_eval;
 
-        auto hi_replaceselectaccess =
-            new HI_ReplaceSelectAccess("HI_ReplaceSelectAccess", debugFlag);
-        PM1.add(hi_replaceselectaccess);
-        print_info("Enable HI_ReplaceSelectAccess Pass");
+    // HI_RemoveRedundantAccess restarts the walk after each removal only if the design point
+    // requests the reference mode, "redundant_access_removal = restart"
+    bool redundantAccessSingleSweep = true;
+    {
+        std::lock_guard<std::mutex> lock(ConfigParseMutex);
+        redundant_access_restart = 0;
+        Parse_Config(configFile_str.c_str(), LoopLabel2UnrollFactor, LoopLabel2II);
+        redundantAccessSingleSweep = !redundant_access_restart;
+    }
 
-        auto lowerswitch_pass = createLowerSwitchPass();
-        PM1.add(lowerswitch_pass);
-        print_info("Enable LowerSwitchPass Pass");
+    /////////////////////////////////////////////////////////////////////////////////////
+    // Front-end Passes running for optimizations, including                           //
+    // Loop Extraction                                                                 //
+    // Loop Simplification                                                             //
+    // Loop Stregnth Reducation                                                        //
+    // Duplicated Instruction Removal                                                  //
+    // Function Initiation                                                             //
+    // Instruction Optimization: Multiplication / Instruction Hoisting /               //
+    //                          Redundant Access Removal / Bitwidth Reduction/ etc..   //
+    /////////////////////////////////////////////////////////////////////////////////////
 
-        auto ADCE_pass = createAggressiveDCEPass();
-        PM1.add(ADCE_pass);
-        print_info("Enable AggressiveDCEPass Pass");
+    print_info("Enable LoopSimplify Pass");
+    auto loopsimplifypass_pre = createLoopSimplifyPass();
+    PM_pre.add(loopsimplifypass_pre);
+
+    auto indvarsimplifypass_pre = createIndVarSimplifyPass();
+    PM_pre.add(indvarsimplifypass_pre);
+    print_info("Enable IndVarSimplifyPass Pass");
+
+    auto CFGSimplification_pass22_pre = createCFGSimplificationPass();
+    PM_pre.add(CFGSimplification_pass22_pre);
+    print_info("Enable CFGSimplificationPass Pass");
+
+    auto loopextract = createLoopExtractorPass(); //"HI_LoopUnroll"
+    PM_pre.add(loopextract);
+    print_info("Enable LoopExtractor Pass");
+
+    std::map<std::string, std::vector<int>> IRFunc2BeginLine;
+    std::string logName_ir2sourcecode = "HI_IR2SourceCode" + fileSuffix;
+    auto hi_ir2sourcecode =
+        new HI_IR2SourceCode(logName_ir2sourcecode.c_str(), IRLoop2LoopLabel, IRFunc2BeginLine,
+                             IRLoop2OriginTripCount, debugFlag);
+    PM_pre.add(hi_ir2sourcecode);
+    print_info("Enable HI_IR2SourceCode Pass");
+
+    std::string logName_loopTarget = "HI_PragmaTargetExtraction_loopTarget_log" + fileSuffix;
+    std::string logName_arrayTarget = "HI_PragmaTargetExtraction_arrayTarget_Log" + fileSuffix;
+    auto hi_PragmaTargetExtraction = new HI_PragmaTargetExtraction(
+        top_str.c_str(), IRLoop2LoopLabel, FuncParamLine2OutermostSize, IRFunc2BeginLine,
+        debugFlag, logName_loopTarget.c_str(), logName_arrayTarget.c_str());
+    PM_pre.add(hi_PragmaTargetExtraction);
+    print_info("Enable HI_PragmaTargetExtraction Pass");
+
+    print_status("Start LLVM pre-processing");
+    PM_pre.run(*Mod_tmp);
+    print_status("Accomplished LLVM pre-processing");
+
+    if (debugFlag)
+    {
+        llvm::raw_fd_ostream OS3("top_output_loopextract" + fileSuffix + ".bc", EC,
+                                 llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OS3);
+        OS3.flush();
+    }
 
-        auto CFGSimplification_pass1 = createCFGSimplificationPass();
-        PM1.add(CFGSimplification_pass1);
-        print_info("Enable CFGSimplificationPass Pass");
+    Triple ModuleTriple(Mod_tmp->getTargetTriple());
+    TargetLibraryInfoImpl TLII(ModuleTriple);
+    PM0.add(new TargetLibraryInfoWrapperPass(TLII));
+
+    print_info("Enable LoopSimplify Pass");
+    auto loopsimplifypass = createLoopSimplifyPass();
+    PM0.add(loopsimplifypass);
+
+    auto indvarsimplifypass = createIndVarSimplifyPass();
+    PM0.add(indvarsimplifypass);
+    print_info("Enable IndVarSimplifyPass Pass");
+
+    PM0.add(createTargetTransformInfoWrapperPass(TargetIRAnalysis()));
+    print_info("Enable TargetIRAnalysis Pass");
+
+    std::string logName_mulorderopt = "HI_MulOrderOpt" + fileSuffix;
+    auto hi_mulorderopt = new HI_MulOrderOpt(logName_mulorderopt.c_str());
+    PM0.add(hi_mulorderopt);
+    print_info("Enable HI_MulOrderOpt Pass");
+
+    auto CFGSimplification_pass22 = createCFGSimplificationPass();
+    PM0.add(CFGSimplification_pass22);
+    print_info("Enable CFGSimplificationPass Pass");
+
+    std::string logName_separateconstoffsetfromgep = "HI_SeparateConstOffsetFromGEP" + fileSuffix;
+    auto hi_separateconstoffsetfromgep = new HI_SeparateConstOffsetFromGEP(
+        logName_separateconstoffsetfromgep.c_str(), true, debugFlag);
+    PM0.add(hi_separateconstoffsetfromgep);
+    print_info("Enable HI_SeparateConstOffsetFromGEP Pass");
+
+    std::string logName_loopunroll = "LoopUnrollLog" + fileSuffix;
+    auto hi_loopunroll = new HI_LoopUnroll(logName_loopunroll.c_str(), IRLoop2LoopLabel,
+                                           LoopLabel2UnrollFactor, 1, false,
+                                           None); //"HI_LoopUnroll"
+    PM0.add(hi_loopunroll);
+    print_info("Enable HI_LoopUnroll Pass");
+
+    std::string logName_mul2shl = "HI_Mul2Shl" + fileSuffix;
+    auto hi_mul2shl = new HI_Mul2Shl(logName_mul2shl.c_str(), debugFlag);
+    PM0.add(hi_mul2shl);
+    print_info("Enable HI_Mul2Shl Pass");
+
+    auto loopstrengthreducepass = createLoopStrengthReducePass();
+    PM0.add(loopstrengthreducepass);
+    print_info("Enable LoopStrengthReducePass Pass");
+
+    std::string logName_aggressivelsr_mul = "AggressiveLSR" + fileSuffix;
+    auto hi_aggressivelsr_mul =
+        new HI_AggressiveLSR_MUL(logName_aggressivelsr_mul.c_str(), debugFlag);
+    PM0.add(hi_aggressivelsr_mul);
+    print_info("Enable HI_AggressiveLSR_MUL Pass");
+
+    PM0.run(*Mod_tmp);
+
+    if (debugFlag)
+    {
+        llvm::raw_fd_ostream OSPM0("top_output_PM0" + fileSuffix + ".bc", EC,
+                                   llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OSPM0);
+        OSPM0.flush();
+    }
 
-        PM1.run(*Mod_tmp);
+    // don't remove chained operations
+    std::string logName_hlsduplicateinstrm = "HLSrmInsts" + fileSuffix;
+    auto hi_hlsduplicateinstrm =
+        new HI_HLSDuplicateInstRm(logName_hlsduplicateinstrm.c_str(), debugFlag);
+    PM1.add(hi_hlsduplicateinstrm);
+    print_info("Enable HI_HLSDuplicateInstRm Pass");
 
-        if (debugFlag)
-        {
-            llvm::raw_fd_ostream OS111("top_output_PM1.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OS111);
-            OS111.flush();
-        }
+    auto CFGSimplification_pass_PM1 = createCFGSimplificationPass();
+    PM1.add(CFGSimplification_pass_PM1);
+    print_info("Enable CFGSimplificationPass Pass");
 
-        std::string logName_varwidthreduce = "VarWidth__forCheck_" + cntStr;
-        auto hi_varwidthreduce1 = new HI_VarWidthReduce(logName_varwidthreduce.c_str(), debugFlag);
-        PM2.add(hi_varwidthreduce1);
-        print_info("Enable HI_VarWidthReduce Pass");
+    std::string logName_functioninstantiation = "HI_FunctionInstantiation" + fileSuffix;
+    auto hi_functioninstantiation =
+        new HI_FunctionInstantiation(logName_functioninstantiation.c_str(), top_str);
+    PM1.add(hi_functioninstantiation);
+    print_info("Enable HI_FunctionInstantiation Pass");
 
-        // don't remove chained operations
-        auto hi_hlsduplicateinstrm1 = new HI_HLSDuplicateInstRm("HLSrmInsts1", (debugFlag));
-        PM2.add(hi_hlsduplicateinstrm1);
-        print_info("Enable HI_HLSDuplicateInstRm Pass");
+    std::string logName_replaceselectaccess = "HI_ReplaceSelectAccess" + fileSuffix;
+    auto hi_replaceselectaccess =
+        new HI_ReplaceSelectAccess(logName_replaceselectaccess.c_str(), debugFlag);
+    PM1.add(hi_replaceselectaccess);
+    print_info("Enable HI_ReplaceSelectAccess Pass");
 
-        auto CFGSimplification_pass2 = createCFGSimplificationPass();
-        PM2.add(CFGSimplification_pass2);
-        print_info("Enable CFGSimplificationPass Pass");
+    auto lowerswitch_pass = createLowerSwitchPass();
+    PM1.add(lowerswitch_pass);
+    print_info("Enable LowerSwitchPass Pass");
 
-        auto hi_removeredundantaccessPM2 =
-            new HI_RemoveRedundantAccess("HI_RemoveRedundantAccessPM2", top_str, (debugFlag));
-        PM2.add(hi_removeredundantaccessPM2);
-        print_info("Enable HI_RemoveRedundantAccess Pass");
+    auto ADCE_pass = createAggressiveDCEPass();
+    PM1.add(ADCE_pass);
+    print_info("Enable AggressiveDCEPass Pass");
 
-        auto hi_intstructionmovebackward1 =
-            new HI_IntstructionMoveBackward("HI_IntstructionMoveBackward1", (debugFlag));
-        PM2.add(hi_intstructionmovebackward1);
-        print_info("Enable HI_IntstructionMoveBackward Pass");
+    auto CFGSimplification_pass1 = createCFGSimplificationPass();
+    PM1.add(CFGSimplification_pass1);
+    print_info("Enable CFGSimplificationPass Pass");
 
-        auto hi_removeredundantaccessPM2_2 =
-            new HI_RemoveRedundantAccess("HI_RemoveRedundantAccessPM2_2", top_str, (debugFlag));
-        PM2.add(hi_removeredundantaccessPM2_2);
-        print_info("Enable HI_RemoveRedundantAccess Pass");
+    PM1.run(*Mod_tmp);
 
-        auto HI_LoadALAPPM2 = new HI_LoadALAP("HI_LoadALAP", debugFlag);
-        PM2.add(HI_LoadALAPPM2);
-        print_info("Enable HI_LoadALAP Pass");
+    if (debugFlag)
+    {
+        llvm::raw_fd_ostream OS111("top_output_PM1" + fileSuffix + ".bc", EC,
+                                   llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OS111);
+        OS111.flush();
+    }
 
-        PM2.run(*Mod_tmp);
+    std::string logName_varwidthreduce = "VarWidth__forCheck_" + cntStr;
+    auto hi_varwidthreduce1 = new HI_VarWidthReduce(logName_varwidthreduce.c_str(), debugFlag);
+    PM2.add(hi_varwidthreduce1);
+    print_info("Enable HI_VarWidthReduce Pass");
+
+    // don't remove chained operations
+    std::string logName_hlsduplicateinstrm1 = "HLSrmInsts1" + fileSuffix;
+    auto hi_hlsduplicateinstrm1 =
+        new HI_HLSDuplicateInstRm(logName_hlsduplicateinstrm1.c_str(), (debugFlag));
+    PM2.add(hi_hlsduplicateinstrm1);
+    print_info("Enable HI_HLSDuplicateInstRm Pass");
+
+    auto CFGSimplification_pass2 = createCFGSimplificationPass();
+    PM2.add(CFGSimplification_pass2);
+    print_info("Enable CFGSimplificationPass Pass");
+
+    std::string logName_removeredundantaccessPM2 = "HI_RemoveRedundantAccessPM2" + fileSuffix;
+    auto hi_removeredundantaccessPM2 =
+        new HI_RemoveRedundantAccess(logName_removeredundantaccessPM2.c_str(), top_str,
+                                     (debugFlag), redundantAccessSingleSweep);
+    PM2.add(hi_removeredundantaccessPM2);
+    print_info("Enable HI_RemoveRedundantAccess Pass");
+
+    std::string logName_intstructionmovebackward1 = "HI_IntstructionMoveBackward1" + fileSuffix;
+    auto hi_intstructionmovebackward1 = new HI_IntstructionMoveBackward(
+        logName_intstructionmovebackward1.c_str(), (debugFlag));
+    PM2.add(hi_intstructionmovebackward1);
+    print_info("Enable HI_IntstructionMoveBackward Pass");
+
+    std::string logName_removeredundantaccessPM2_2 = "HI_RemoveRedundantAccessPM2_2" + fileSuffix;
+    auto hi_removeredundantaccessPM2_2 =
+        new HI_RemoveRedundantAccess(logName_removeredundantaccessPM2_2.c_str(), top_str,
+                                     (debugFlag), redundantAccessSingleSweep);
+    PM2.add(hi_removeredundantaccessPM2_2);
+    print_info("Enable HI_RemoveRedundantAccess Pass");
+
+    std::string logName_loadALAP = "HI_LoadALAP" + fileSuffix;
+    auto HI_LoadALAPPM2 = new HI_LoadALAP(logName_loadALAP.c_str(), debugFlag);
+    PM2.add(HI_LoadALAPPM2);
+    print_info("Enable HI_LoadALAP Pass");
+
+    PM2.run(*Mod_tmp);
+
+    if (debugFlag)
+    {
+        llvm::raw_fd_ostream OSPM2("top_output_PM2" + fileSuffix + ".bc", EC,
+                                   llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OSPM2);
+        OSPM2.flush();
+    }
 
-        if (debugFlag)
-        {
-            llvm::raw_fd_ostream OSPM2("top_output_PM2.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OSPM2);
-            OSPM2.flush();
-        }
+    /////////////////////////////////////////////////////////////
+    // Front-end Passes running just before back-end analysis. //
+    // map the IR loops to the loop labels in the source code  //
+    // for the configurations of loops.                        //
+    /////////////////////////////////////////////////////////////
+
+    std::map<std::string, std::string> IRLoop2LoopLabel_eval;
+    // std::map<std::string, std::vector<int>> IRFunc2BeginLine_eval;
+    std::string logName_ir2sourcecode_eval = "HI_IR2SourceCode_eval" + fileSuffix;
+    auto hi_ir2sourcecode_eval =
+        new HI_IR2SourceCode(logName_ir2sourcecode_eval.c_str(), IRLoop2LoopLabel_eval,
+                             IRFunc2BeginLine, IRLoop2OriginTripCount_eval, debugFlag);
+    PM3.add(hi_ir2sourcecode_eval);
+    print_info("Enable HI_IR2SourceCode Pass");
+    PM3.run(*Mod_tmp);
+
+    /////////////////////////////////////////////////////////////
+    // Front-end Passes running just before back-end analysis. //
+    // mainly account for inserting MUX for the accesses to    //
+    // array partitions.                                       //
+    /////////////////////////////////////////////////////////////
+
+    auto loopinfowrapperpass = new LoopInfoWrapperPass();
+    PM4.add(loopinfowrapperpass);
+    print_info("Enable LoopInfoWrapperPass Pass");
+
+    auto scalarevolutionwrapperpass = new ScalarEvolutionWrapperPass();
+    PM4.add(scalarevolutionwrapperpass);
+    print_info("Enable ScalarEvolutionWrapperPass Pass");
+
+    std::string logName_muxBRAM = "HI_MuxInsertionArrayPartition_BRAM_log" + fileSuffix;
+    std::string logName_muxArray = "HI_MuxInsertionArrayPartition_Array_Log" + fileSuffix;
+    auto hi_MuxInsertionArrayPartition = new HI_MuxInsertionArrayPartition(
+        configFile_str.c_str(), top_str.c_str(), FuncParamLine2OutermostSize, IRFunc2BeginLine,
+        debugFlag, logName_muxBRAM.c_str(), logName_muxArray.c_str());
+    print_info("Enable HI_MuxInsertionArrayPartition Pass");
+    PM4.add(hi_MuxInsertionArrayPartition);
+
+    auto lowerswitch_pass_eval = createLowerSwitchPass();
+    PM4.add(lowerswitch_pass_eval);
+    // print_info("Enable LowerSwitchPass Pass");
+
+    auto ADCE_pass_eval = createAggressiveDCEPass();
+    PM4.add(ADCE_pass_eval);
+    // print_info("Enable AggressiveDCEPass Pass");
+
+    auto CFGSimplification_pass1_eval = createCFGSimplificationPass();
+    PM4.add(CFGSimplification_pass1_eval);
+    print_status("Start LLVM processing");
+    PM4.run(*Mod_tmp);
+    print_status("Accomplished LLVM processing");
+
+    if (debugFlag)
+    {
+        llvm::raw_fd_ostream OSPM2("top_output_PM4" + fileSuffix + ".bc", EC,
+                                   llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OSPM2);
+        OSPM2.flush();
+    }
 
-        /////////////////////////////////////////////////////////////
-        // Front-end Passes running just before back-end analysis. //
-        // map the IR loops to the loop labels in the source code  //
-        // for the configurations of loops.                        //
-        /////////////////////////////////////////////////////////////
-
-        std::map<std::string, std::string> IRLoop2LoopLabel_eval;
-        // std::map<std::string, std::vector<int>> IRFunc2BeginLine_eval;
-        auto hi_ir2sourcecode_eval =
-            new HI_IR2SourceCode("HI_IR2SourceCode_eval", IRLoop2LoopLabel_eval, IRFunc2BeginLine,
-                                 IRLoop2OriginTripCount_eval, debugFlag);
-        PM3.add(hi_ir2sourcecode_eval);
-        print_info("Enable HI_IR2SourceCode Pass");
-        PM3.run(*Mod_tmp);
-
-        /////////////////////////////////////////////////////////////
-        // Front-end Passes running just before back-end analysis. //
-        // mainly account for inserting MUX for the accesses to    //
-        // array partitions.                                       //
-        /////////////////////////////////////////////////////////////
-
-        auto loopinfowrapperpass = new LoopInfoWrapperPass();
-        PM4.add(loopinfowrapperpass);
-        print_info("Enable LoopInfoWrapperPass Pass");
-
-        auto scalarevolutionwrapperpass = new ScalarEvolutionWrapperPass();
-        PM4.add(scalarevolutionwrapperpass);
-        print_info("Enable ScalarEvolutionWrapperPass Pass");
-
-        auto hi_MuxInsertionArrayPartition = new HI_MuxInsertionArrayPartition(
-            configFile_str.c_str(), top_str.c_str(), FuncParamLine2OutermostSize, IRFunc2BeginLine,
-            debugFlag);
-        print_info("Enable HI_MuxInsertionArrayPartition Pass");
-        PM4.add(hi_MuxInsertionArrayPartition);
-
-        auto lowerswitch_pass_eval = createLowerSwitchPass();
-        PM4.add(lowerswitch_pass_eval);
-        // print_info("Enable LowerSwitchPass Pass");
-
-        auto ADCE_pass_eval = createAggressiveDCEPass();
-        PM4.add(ADCE_pass_eval);
-        // print_info("Enable AggressiveDCEPass Pass");
-
-        auto CFGSimplification_pass1_eval = createCFGSimplificationPass();
-        PM4.add(CFGSimplification_pass1_eval);
-        print_status("Start LLVM processing");
-        PM4.run(*Mod_tmp);
-        print_status("Accomplished LLVM processing");
-
-        if (debugFlag)
-        {
-            llvm::raw_fd_ostream OSPM2("top_output_PM4.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OSPM2);
-            OSPM2.flush();
-        }
+    ////////////////////////////////////////////////////////////////
+    // Backend-end Pass running for scheduling and binding        //
+    // After running this Pass, the information will be stored in //
+    // The public variables of the Pass pointer.                  //
+    // such as function latencies, loop tripcounts and etc.       //
+    // The information variables are declared in:                 //
+    //         HI_WithDirectiveTimingResourceEvaluation.h         //
+    ////////////////////////////////////////////////////////////////
+
+    std::string logName_evaluation =
+        "HI_WithDirectiveTimingResourceEvaluation__forCheck_" + cntStr;
+    std::string logName_array = "ArrayLog__forCheck_" + cntStr;
+    std::string logName_BRAM = "BRAM_info" + fileSuffix;
+    std::string logName_FF = "FF_LOG" + fileSuffix;
+    auto hi_withdirectivetimingresourceevaluation =
+        new HI_WithDirectiveTimingResourceEvaluation(
+            configFile_str.c_str(), logName_evaluation.c_str(), logName_BRAM.c_str(),
+            logName_array.c_str(), top_str.c_str(), IRLoop2LoopLabel_eval,
+            IRLoop2OriginTripCount, LoopLabel2II, LoopLabel2UnrollFactor,
+            FuncParamLine2OutermostSize, IRFunc2BeginLine, HLSLibTable, debugFlag,
+            logName_FF.c_str());
+    print_info("Enable HI_WithDirectiveTimingResourceEvaluation Pass");
+    PM_eval.add(hi_withdirectivetimingresourceevaluation);
+
+    PM_eval.run(*Mod_tmp);
+
+    pointResult.configFile = configFile_str;
+    if (!hi_withdirectivetimingresourceevaluation->topFunctionFound)
+    {
+        // only this design point fails, the other points in the batch are still evaluated
+        print_error("The specified top function [" + top_str +
+                    "] is not found in the program for design point #" + cntStr + ": " +
+                    configFile_str);
+        pointResult.topFunctionFound = false;
+        return false;
+    }
 
-        ////////////////////////////////////////////////////////////////
-        // Backend-end Pass running for scheduling and binding        //
-        // After running this Pass, the information will be stored in //
-        // The public variables of the Pass pointer.                  //
-        // such as function latencies, loop tripcounts and etc.       //
-        // The information variables are declared in:                 //
-        //         HI_WithDirectiveTimingResourceEvaluation.h         //
-        ////////////////////////////////////////////////////////////////
-
-        std::string logName_evaluation =
-            "HI_WithDirectiveTimingResourceEvaluation__forCheck_" + cntStr;
-        std::string logName_array = "ArrayLog__forCheck_" + cntStr;
-        auto hi_withdirectivetimingresourceevaluation =
-            new HI_WithDirectiveTimingResourceEvaluation(
-                configFile_str.c_str(), logName_evaluation.c_str(), "BRAM_info_0",
-                logName_array.c_str(), top_str.c_str(), IRLoop2LoopLabel_eval,
-                IRLoop2OriginTripCount, LoopLabel2II, LoopLabel2UnrollFactor,
-                FuncParamLine2OutermostSize, IRFunc2BeginLine, BiOp_Info_name2list_map, debugFlag);
-        print_info("Enable HI_WithDirectiveTimingResourceEvaluation Pass");
-        PM_eval.add(hi_withdirectivetimingresourceevaluation);
-
-        PM_eval.run(*Mod_tmp);
-
-        assert(hi_withdirectivetimingresourceevaluation->topFunctionFound &&
-               "The specified top function is not found in the program");
-
-        print_status("Writing LLVM IR to File");
-
-        if (debugFlag)
-        {
-            llvm::raw_fd_ostream OS("top_output.bc", EC, llvm::sys::fs::F_None);
-            WriteBitcodeToFile(*Mod_tmp, OS);
-            OS.flush();
+    gettimeofday(&tv_end, NULL);
+    pointResult.topFunctionFound = hi_withdirectivetimingresourceevaluation->topFunctionFound;
+    pointResult.latency = hi_withdirectivetimingresourceevaluation->top_function_latency;
+    pointResult.DSP = hi_withdirectivetimingresourceevaluation->topFunction_resource.DSP;
+    pointResult.FF = hi_withdirectivetimingresourceevaluation->topFunction_resource.FF;
+    pointResult.LUT = hi_withdirectivetimingresourceevaluation->topFunction_resource.LUT;
+    pointResult.BRAM = hi_withdirectivetimingresourceevaluation->topFunction_resource.BRAM;
+    pointResult.evaluationTime = (double)(tv_end.tv_sec - tv_begin.tv_sec) +
+                                 (double)(tv_end.tv_usec - tv_begin.tv_usec) / 1000000.0;
 
-            cmd_str = "llvm-dis top_output.bc 2>&1";
-            print_cmd(cmd_str.c_str());
-            result = sysexec(cmd_str.c_str());
-        }
+    print_status("Writing LLVM IR to File");
 
+    if (debugFlag)
+    {
+        std::string outputBC_name = "top_output" + fileSuffix + ".bc";
+        llvm::raw_fd_ostream OS(outputBC_name, EC, llvm::sys::fs::F_None);
+        WriteBitcodeToFile(*Mod_tmp, OS);
+        OS.flush();
+
+        std::string cmd_str = "llvm-dis " + outputBC_name + " 2>&1";
+        print_cmd(cmd_str.c_str());
+        bool result = sysexec(cmd_str.c_str());
         assert(result); // ensure the cmd is executed successfully
-        Mod_tmp.reset();
     }
 
-    return 0;
+    Mod_tmp.reset();
+    return pointResult.topFunctionFound;
 }
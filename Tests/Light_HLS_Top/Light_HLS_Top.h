@@ -115,9 +115,47 @@
 #include "llvm/Transforms/Utils.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
 #include "llvm/Transforms/Utils/CodeExtractor.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <utility>
-// #include "X86TargetMachine.h"
\ No newline at end of file
+// #include "X86TargetMachine.h"
+
+// the latency and resource of the top function for one evaluated design configuration
+struct DesignPointResult
+{
+    std::string configFile;
+    bool topFunctionFound = false;
+    int latency = -1;
+    int DSP = -1, FF = -1, LUT = -1, BRAM = -1;
+    double evaluationTime = 0;
+};
+
+// get the list of configuration files, the argument could be a configuration file,
+// a directory of configuration files or (in BATCH mode) a file listing configuration files
+std::vector<std::string> collectDesignPointConfigs(std::string configArg_str, bool batchFlag);
+
+// evaluate one design point: clone the cached module, run the optimization passes with the
+// directives in the configuration file and evaluate the timing and resource of the top function
+bool evaluateDesignPoint(llvm::Module &Mod, std::string configFile_str, std::string top_str,
+                         int pointID, std::map<std::string, int> &FuncParamLine2OutermostSize,
+                         const HI_HLSLibTable &HLSLibTable, bool debugFlag,
+                         DesignPointResult &pointResult);
+
+// worker of the design point pool: parse the shared bitcode into a module in the worker's own
+// LLVMContext and evaluate the design points one by one, the shared HLS library is only read
+void evaluateDesignPointsInWorker(
+    const llvm::MemoryBuffer &ModBuffer, const std::vector<std::string> &configFiles,
+    const std::vector<int> &validPoints, std::string top_str, std::atomic<int> &nextPoint,
+    std::map<std::string, int> FuncParamLine2OutermostSize, const HI_HLSLibTable &HLSLibTable,
+    bool debugFlag, std::vector<DesignPointResult> &pointResults);
+
+// print out the latency/resource of all the evaluated design points in a table and dump it to
+// the summary file
+void printDesignPointSummary(std::vector<DesignPointResult> &pointResults,
+                             const char *summary_file_name);
@@ -8,31 +8,88 @@ extern std::string clock_period_str;
 extern std::string HLS_lib_path;
 extern bool all_sub_function_inline;
 static llvm::cl::OptionCategory StatSampleCategory("Stat Sample");
+static const char *includePathCache_name = "IncludePaths.cache";
 
 void clangPreProcess(const char **argv, std::string top_str,
-                     std::map<std::string, int> &FuncParamLine2OutermostSize)
+                     std::map<std::string, int> &FuncParamLine2OutermostSize,
+                     const std::vector<std::string> &includePaths, std::string &labeledSourceCode)
 {
-    pathAdvice();
-
-    // parse the command-line args passed to your code
-    int labelerArgc = 2;
-    CommonOptionsParser op(labelerArgc, argv, StatSampleCategory);
+    // parse the command-line args passed to your code, the include paths are passed as the
+    // extra arguments after "--" so they are used by the fixed compilation database
+    std::vector<std::string> labelerArgs = {argv[0], argv[1], "--"};
+    for (auto &path : includePaths)
+        labelerArgs.push_back("-isystem" + path);
+    std::vector<const char *> labelerArgv;
+    for (auto &arg : labelerArgs)
+        labelerArgv.push_back(arg.c_str());
+    int labelerArgc = labelerArgv.size();
+    CommonOptionsParser op(labelerArgc, labelerArgv.data(), StatSampleCategory);
 
     // create a new Clang Tool instance (a LibTooling environment)
     ClangTool Tool(op.getCompilations(), op.getSourcePathList());
-    Rewriter TheRewriter0, TheRewriter1;
+    Rewriter TheRewriter;
 
-    // run the Clang Tool, creating a new FrontendAction, which will run the AST consumer
-    Tool.run(HI_LoopLabeler_rewrite_newFrontendActionFactory<HI_LoopLabeler_FrontendAction>(
-                 "PLog", TheRewriter0, "tmp.cc")
-                 .get());
+    // run the Clang Tool, creating a new FrontendAction, which will run the AST consumer.
+    // The source code is parsed once: the loops are labeled and the interface information is
+    // extracted in the same traversal, and the rewritten code is kept in memory.
     Tool.run(HI_FunctionInterfaceInfo_rewrite_newFrontendActionFactory<
-                 HI_FunctionInterfaceInfo_FrontendAction>(
-                 "PLog1", TheRewriter1, "tmp_loopLabeled.cc", FuncParamLine2OutermostSize, top_str,
-                 all_sub_function_inline)
+                 HI_FunctionInterfaceInfo_FrontendAction>("PLog", TheRewriter, labeledSourceCode,
+                                                          FuncParamLine2OutermostSize, top_str,
+                                                          all_sub_function_inline)
                  .get());
 }
 
+std::unique_ptr<llvm::Module> clangCompileToModule(std::string fileName, std::string sourceCode,
+                                                   const std::vector<std::string> &includePaths,
+                                                   llvm::LLVMContext &Context)
+{
+    // the driver maps the options to the cc1 invocation just like the clang binary does,
+    // e.g. "-g" to the debug info kind, which is necessary for HI_IR2SourceCode
+    std::vector<std::string> CommandLine = {"clang", "-O1", "-g", "-c", fileName};
+    for (auto &path : includePaths)
+        CommandLine.push_back("-isystem" + path);
+    print_cmd("(in-process) clang -O1 -emit-llvm -g " + fileName + " | opt -always-inline");
+
+    llvm::IntrusiveRefCntPtr<FileManager> Files(new FileManager(FileSystemOptions()));
+    HI_EmitLLVMModuleAction Action(Context);
+    ToolInvocation Invocation(CommandLine, &Action, Files.get());
+    Invocation.mapVirtualFile(fileName, sourceCode);
+    if (!Invocation.run() || !Action.Mod)
+    {
+        print_error("Failed to compile [" + fileName + "] into IR.");
+        return nullptr;
+    }
+
+    // inline the functions marked always_inline by the front-end
+    legacy::PassManager PM_inline;
+    PM_inline.add(createAlwaysInlinerLegacyPass());
+    PM_inline.run(*Action.Mod);
+
+    return std::move(Action.Mod);
+}
+
+bool HI_EmitLLVMModuleAction::runInvocation(std::shared_ptr<CompilerInvocation> Invocation,
+                                            FileManager *Files,
+                                            std::shared_ptr<PCHContainerOperations> PCHContainerOps,
+                                            DiagnosticConsumer *DiagConsumer)
+{
+    CompilerInstance Compiler(std::move(PCHContainerOps));
+    Compiler.setInvocation(std::move(Invocation));
+    Compiler.setFileManager(Files);
+    Compiler.createDiagnostics(DiagConsumer, /*ShouldOwnClient=*/false);
+    if (!Compiler.hasDiagnostics())
+        return false;
+    Compiler.createSourceManager(*Files);
+
+    // the module is generated in the given context, so it can be used by the passes directly
+    EmitLLVMOnlyAction EmitAction(&Context);
+    bool success = Compiler.ExecuteAction(EmitAction);
+    Files->clearStatCaches();
+    if (success)
+        Mod = EmitAction.takeModule();
+    return success && Mod;
+}
+
 void ReplaceAll(std::string &strSource, const std::string &strOld, const std::string &strNew)
 {
     int nPos = 0;
@@ -43,18 +100,19 @@ void ReplaceAll(std::string &strSource, const std::string &strOld, const std::st
     }
 }
 
-void pathAdvice()
+// run the compiler once to get its system include search list
+static std::vector<std::string> discoverIncludePaths(std::string compiler_path)
 {
-    std::cout << "==============================================================================="
-              << std::endl;
-    std::cout << "if undefined reference occurs, please check whether the following include paths "
-                 "are required."
-              << std::endl;
+    std::vector<std::string> includePaths;
+    SmallString<128> infoPath;
+    if (llvm::sys::fs::createTemporaryFile("ciinfor", "txt", infoPath))
+        return includePaths;
+
     std::string line;
-    std::string cmd_str = "clang++ ../testcase/test.c  -v 2> ciinfor";
+    std::string cmd_str = compiler_path + " -E -x c++ /dev/null -v 2> " + infoPath.str().str();
     print_cmd(cmd_str.c_str());
     sysexec(cmd_str.c_str());
-    std::ifstream infile("ciinfor");
+    std::ifstream infile(infoPath.c_str());
     while (std::getline(infile, line))
     {
         if (line.find("#include <...> search starts here") != std::string::npos)
@@ -69,21 +127,81 @@ void pathAdvice()
                 {
                     ReplaceAll(line, " ", "");
                     ReplaceAll(line, "\n", "");
-                    //  CI.getHeaderSearchOpts().AddPath(line,frontend::ExternCSystem,false,true);
-                    line = "Potential Path : " + line;
-                    print_info(line.c_str());
+                    // e.g. "/Library/Frameworks (framework directory)" on MacOS
+                    if (line.find("(") != std::string::npos)
+                        continue;
+                    includePaths.push_back(line);
                 }
             }
             break;
         }
     }
+    llvm::sys::fs::remove(infoPath);
+    return includePaths;
+}
+
+std::vector<std::string> pathAdvice()
+{
     std::cout << "==============================================================================="
               << std::endl;
+    std::cout << "if undefined reference occurs, please check whether the following include paths "
+                 "are required."
+              << std::endl;
+
+    std::vector<std::string> includePaths;
+    auto compilerOrErr = llvm::sys::findProgramByName("clang++");
+    llvm::sys::fs::file_status compiler_status;
+    if (!compilerOrErr || llvm::sys::fs::status(compilerOrErr.get(), compiler_status))
+    {
+        print_warning("clang++ is not found, no system include path is added.");
+        return includePaths;
+    }
+
+    // the cache is valid only if it is generated for the same compiler binary
+    std::string compiler_path = compilerOrErr.get();
+    std::string cache_key =
+        compiler_path + " " +
+        std::to_string(llvm::sys::toTimeT(compiler_status.getLastModificationTime()));
+
+    std::ifstream cache_file(includePathCache_name);
+    std::string line;
+    if (std::getline(cache_file, line) && line == cache_key)
+    {
+        while (std::getline(cache_file, line))
+            if (line != "")
+                includePaths.push_back(line);
+    }
+    else
+    {
+        includePaths = discoverIncludePaths(compiler_path);
+
+        // write to a unique file and rename it, so the concurrent runs will not see a partial cache
+        int cache_fd;
+        SmallString<128> tmpCachePath;
+        if (!llvm::sys::fs::createUniqueFile(std::string(includePathCache_name) + "-%%%%%%",
+                                             cache_fd, tmpCachePath))
+        {
+            {
+                llvm::raw_fd_ostream cache_out(cache_fd, /*shouldClose=*/true);
+                cache_out << cache_key << "\n";
+                for (auto &path : includePaths)
+                    cache_out << path << "\n";
+            }
+            if (llvm::sys::fs::rename(tmpCachePath, includePathCache_name))
+                llvm::sys::fs::remove(tmpCachePath);
+        }
+    }
+
+    for (auto &path : includePaths)
+        print_info("Potential Path : " + path);
+    std::cout << "==============================================================================="
+              << std::endl;
+    return includePaths;
 }
 
-// load the HLS database of timing and resource
-void DES_Load_Instruction_Info(const char *config_file_name,
-                               std::map<std::string, Info_type_list> &BiOp_Info_name2list_map)
+// load the HLS database of timing and resource into a table, which can be shared by the
+// evaluators, nullptr is returned if the library cannot be loaded
+std::unique_ptr<HI_HLSLibTable> DES_Load_Instruction_Info(const char *config_file_name)
 {
     auto config_file = new std::ifstream(config_file_name);
 
@@ -112,64 +230,22 @@ void DES_Load_Instruction_Info(const char *config_file_name,
     assert(HLS_lib_path != "" && "The HLS Lib is necessary in the configuration file!\n");
 
     delete config_file;
-    int i;
-    for (i = 0; i < instructionInfoNum; i++)
-    {
+
+    std::vector<std::string> opcodes;
+    for (int i = 0; i < instructionInfoNum; i++)
         if (instructionHasMappingFile[i])
-        {
-            Info_type_list tmp_list;
-            std::string info_file_name(HLS_lib_path.c_str());
-            info_file_name += instructionNames[i];
-            info_file_name += "/";
-            info_file_name += instructionNames[i];
-            // info_file_name+="_data";
-            std::ifstream info_file(info_file_name.c_str());
-
-            if (!exists_test(info_file_name))
-            {
-                llvm::errs() << "The HLS info file [" + info_file_name + "] does not exist.\n";
-                assert(false && "check the HLS information library path.\n");
-            }
-            std::string tmp_s;
-            while (getline(info_file, tmp_s))
-            {
-                tmp_s = removeExtraSpace(tmp_s);
-                std::stringstream iss(tmp_s);
-                std::string data_ele[11];
-                for (int j = 0; j < 11; j++)
-                {
-                    iss >> data_ele[j];
-                    iss.ignore(1, ' ');
-                }
-                if (instructionNames[i] != "mac")
-                {
-                    if (data_ele[0] != data_ele[1] || data_ele[1] != data_ele[2])
-                        continue; // ignore those unused information
-                }
-                else
-                {
-                    if (data_ele[0] != data_ele[1])
-                        continue; // ignore those unused information
-                }
+            opcodes.push_back(instructionNames[i]);
 
-                inst_timing_resource_info tmp_info;
-
-                int oprand_bitwidth = std::stoi(data_ele[0]);
-                int res_bitwid = std::stoi(data_ele[2]);
-                std::string _clock_period_str = data_ele[3];
-                tmp_info.DSP = std::stoi(data_ele[4]);
-                tmp_info.FF = std::stoi(data_ele[5]);
-                tmp_info.LUT = std::stoi(data_ele[6]);
-                tmp_info.Lat = std::stoi(data_ele[7]);
-                tmp_info.delay = std::stod(data_ele[8]);
-                tmp_info.II = std::stoi(data_ele[9]);
-                tmp_info.core_name = data_ele[10];
-                tmp_list[oprand_bitwidth][res_bitwid][_clock_period_str] = tmp_info;
-                // str(oprandA)+" "+str(oprandB)+" "+str(oprandC)+" "+str(period)+" "
-                // +str(DSP48E_N)+" "+str(FF_N)+" "+str(LUT_N)+" "+str(lat_tmp)+" "
-                // +str(delay_tmp)+" "+str(II_tmp)+" "+str(Core_tmp)
-            }
-            BiOp_Info_name2list_map[instructionNames[i]] = tmp_list;
-        }
+    // the binary HLS library is mapped if it is up-to-date, otherwise the text files are parsed
+    std::vector<std::string> clocks(clockStrs, clockStrs + clockNum);
+    std::unique_ptr<HI_HLSLibTable> HLSLibTable = HI_loadHLSLibTable(HLS_lib_path, opcodes, clocks);
+    if (!HLSLibTable)
+    {
+        print_error("The HLS library [" + HLS_lib_path + "] cannot be loaded.");
+        return nullptr;
     }
+    for (auto &opcode : opcodes)
+        llvm::errs() << "instruction type: [" << opcode << "] loaded\n";
+
+    return HLSLibTable;
 }
@@ -8,6 +8,7 @@
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Type.h"
+#include "clang/CodeGen/CodeGenAction.h"
 #include "clang/Driver/Options.h"
 #include "clang/Frontend/ASTConsumers.h"
 #include "clang/Frontend/CompilerInstance.h"
@@ -18,6 +19,7 @@
 #include "llvm/ADT/ScopeExit.h"
 #include "llvm/ADT/SetOperations.h"
 #include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/Statistic.h"
 #include "llvm/Analysis/AliasAnalysis.h"
@@ -55,7 +57,9 @@
 #include "llvm/IR/ValueHandle.h"
 #include "llvm/IRReader/IRReader.h"
 #include "llvm/Pass.h"
+#include "llvm/Support/Chrono.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Program.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/raw_ostream.h"
 #include "llvm/Transforms/Scalar.h"
@@ -79,6 +83,7 @@
 // #include "polly/LinkAllPasses.h"
 #include "HI_AggressiveLSR_MUL.h"
 #include "HI_FunctionInstantiation.h"
+#include "HI_HLSLibrary.h"
 #include "HI_HLSDuplicateInstRm.h"
 #include "HI_IR2SourceCode.h"
 #include "HI_IntstructionMoveBackward.h"
@@ -116,6 +121,7 @@
 #include "llvm/Pass.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Transforms/IPO.h"
+#include "llvm/Transforms/IPO/AlwaysInliner.h"
 #include "llvm/Transforms/Scalar.h"
 #include "llvm/Transforms/Utils.h"
 #include "llvm/Transforms/Utils/BasicBlockUtils.h"
@@ -128,13 +134,43 @@
 
 void ReplaceAll(std::string &strSource, const std::string &strOld, const std::string &strNew);
 
-void pathAdvice();
+// get the system include paths of clang++, which are cached in the file "IncludePaths.cache"
+// and discovered again only when the compiler binary is changed
+std::vector<std::string> pathAdvice();
 
-// load the HLS database of timing and resource
-void DES_Load_Instruction_Info(const char *config_file_name,
-                               std::map<std::string, Info_type_list> &BiOp_Info_name2list_map);
+// load the HLS database of timing and resource into a table, which can be shared by the
+// evaluators, nullptr is returned if the library cannot be loaded
+std::unique_ptr<HI_HLSLibTable> DES_Load_Instruction_Info(const char *config_file_name);
 
+// parse the source code once to label the loops and extract the interface information, the
+// rewritten code is stored in labeledSourceCode
 void clangPreProcess(const char **argv, std::string top_str,
-                     std::map<std::string, int> &FuncParamLine2OutermostSize);
+                     std::map<std::string, int> &FuncParamLine2OutermostSize,
+                     const std::vector<std::string> &includePaths, std::string &labeledSourceCode);
+
+// compile the source code into IR in-process, equivalent to "clang -O1 -emit-llvm -g" followed by
+// "opt -always-inline", without temporary files or child processes
+std::unique_ptr<llvm::Module> clangCompileToModule(std::string fileName, std::string sourceCode,
+                                                   const std::vector<std::string> &includePaths,
+                                                   llvm::LLVMContext &Context);
+
+// run EmitLLVMOnlyAction with the invocation built by the clang driver and keep the module
+class HI_EmitLLVMModuleAction : public clang::tooling::ToolAction
+{
+  public:
+    HI_EmitLLVMModuleAction(llvm::LLVMContext &Context) : Context(Context)
+    {
+    }
+
+    bool runInvocation(std::shared_ptr<clang::CompilerInvocation> Invocation,
+                       clang::FileManager *Files,
+                       std::shared_ptr<clang::PCHContainerOperations> PCHContainerOps,
+                       clang::DiagnosticConsumer *DiagConsumer) override;
+
+    std::unique_ptr<llvm::Module> Mod;
+
+  private:
+    llvm::LLVMContext &Context;
+};
 
 #endif
\ No newline at end of file